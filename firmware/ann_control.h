@@ -0,0 +1,273 @@
+// ann_control.h
+// Sweep and decision state machine of robot_ann.ino, shared with the host world simulator
+// (training/world_sim.h) so the simulator runs the firmware's control logic, not a copy of it.
+// - All state lives in one AnnControl; the functions below are the bodies of the sketch's
+//   sweep, control, inference hand-off and servo tasks and never touch a pin: the caller fires
+//   pings, writes the servo, drives the motors and runs the model (ann_ctl_take_request /
+//   ann_ctl_infer_done), so the same calls run on the board, the host HAL and the simulator
+// - What a call did is reported back (critical stop, inference requested, decision taken) for the
+//   caller's telemetry or statistics
+// - Times are millis(); every timer is an AnnTimer, so wrap-around is harmless
+#ifndef ANN_CONTROL_H
+#define ANN_CONTROL_H
+
+#include <stdint.h>
+#include "ann_sched.h"
+#include "ann_scanmap.h"
+#include "ann_telemetry.h"
+
+const int ANN_SAFE_DISTANCE = 25;      // cm: drive forward only beyond this
+const int ANN_CRITICAL_DISTANCE = 10;  // cm: stop at once within this
+const int ANN_SERVO_CENTER = 90;
+const int ANN_SERVO_LEFT = 150;
+const int ANN_SERVO_RIGHT = 30;
+
+const uint8_t ANN_SWEEP_STEP = 15;          // degrees between sweep positions (one map bin)
+const uint16_t ANN_SWEEP_SETTLE_MS = 40;    // servo travel time per ANN_SWEEP_STEP
+const uint16_t ANN_SERVO_SETTLE_MS = 300;   // upper bound for long moves
+const uint16_t ANN_PING_INTERVAL_MS = 60;   // HC-SR04 minimum measurement cycle
+const uint16_t ANN_MAP_MAX_AGE_MS = 1500;   // one full sweep back and forth takes ~1.1 s
+const uint8_t ANN_DRIVE_SWEEP_HALF = 30;    // sweep ANN_SERVO_CENTER +-30 deg while driving forward
+const uint16_t ANN_DRIVE_MAX_AGE_MS = 400;  // front sector age limit while driving forward
+const int ANN_FRONT_LO = ANN_SERVO_CENTER - ANN_SWEEP_STEP, ANN_FRONT_HI = ANN_SERVO_CENTER + ANN_SWEEP_STEP;
+const int ANN_LEFT_LO = ANN_SERVO_LEFT - ANN_SWEEP_STEP, ANN_LEFT_HI = ANN_SERVO_LEFT;
+const int ANN_RIGHT_LO = ANN_SERVO_RIGHT, ANN_RIGHT_HI = ANN_SERVO_RIGHT + ANN_SWEEP_STEP;
+
+const uint8_t ANN_DRIVE_PWM = 200, ANN_TURN_PWM = 200, ANN_BACKUP_PWM = 180;
+const uint16_t ANN_CRITICAL_MS = 200;       // stopped after a critical front reading
+const uint16_t ANN_ACTION_MS = 450;         // executing the chosen action
+const uint16_t ANN_SETTLE_MS = 120;         // stop after an action or a backup
+const uint16_t ANN_BACKUP_STOP_MS = 80;     // STOP chosen: stop, then
+const uint16_t ANN_BACKUP_MS = 320;         //   reverse
+
+enum AnnCtlState : uint8_t {
+  ANN_ST_DRIVE,          // forward while the front sector is clear, decide when it isn't
+  ANN_ST_CRITICAL,       // stopped after a critical front reading
+  ANN_ST_INFER,          // waiting for the inference task
+  ANN_ST_ACTION,         // executing the action, front still monitored
+  ANN_ST_ACTION_SETTLE,  // stop
+  ANN_ST_BACKUP_STOP,    // the model chose STOP: stop
+  ANN_ST_BACKUP,         //   reverse
+  ANN_ST_BACKUP_SETTLE   //   stop
+};
+enum AnnMotorCmd : uint8_t { ANN_M_STOP, ANN_M_FORWARD, ANN_M_BACKWARD, ANN_M_LEFT, ANN_M_RIGHT };
+
+// ann_ctl_step() result bits
+const uint8_t ANN_CTL_EV_CRITICAL = 0x01;  // critical stop on the front sector (crit_angle, crit_cm)
+const uint8_t ANN_CTL_EV_REQUEST = 0x02;   // decision distances captured, inference requested
+const uint8_t ANN_CTL_EV_DECISION = 0x04;  // action taken (action_raw, last_action, flags)
+
+struct AnnControl {
+  AnnScanMap map;
+  // motors: command for the motors task
+  AnnMotorCmd motor;
+  uint8_t pwm;
+  // servo
+  int servo_target, servo_applied;
+  AnnTimer servo_timer;
+  // sweep
+  int sweep_angle;
+  int8_t sweep_dir;
+  bool pinged_here;
+  AnnTimer ping_timer;
+  // inference hand-off
+  bool infer_requested, infer_ready;
+  uint8_t infer_action;
+  // control
+  AnnCtlState state;
+  AnnTimer state_timer;
+  uint8_t last_action;             // after the safety overrides
+  unsigned int decision_dist[3];   // left, right, front (filtered, from the map)
+  uint32_t drive_since_ms, blocked_ms;  // DRIVE entered, front blocked (decision phase timings)
+  bool blocked;
+  // details of the last reported event
+  uint8_t crit_angle;
+  unsigned int crit_cm;
+  uint8_t action_raw, flags;       // ANN_TLM_F_FWD_OVERRIDE / ANN_TLM_F_SIDE_VETO
+};
+
+static inline void ann_ctl_enter(AnnControl &c, AnnCtlState s, uint32_t now, uint32_t ms) {
+  c.state = s;
+  c.state_timer.set(now, ms);
+  if (s == ANN_ST_DRIVE) { c.drive_since_ms = now; c.blocked = false; }
+}
+
+static inline void ann_ctl_motors(AnnControl &c, AnnMotorCmd m, uint8_t pwm) { c.motor = m; c.pwm = pwm; }
+
+// setup(): servo centred (and given time to get there), map empty, motors stopped
+static inline void ann_ctl_init(AnnControl &c, uint32_t now) {
+  ann_map_init(c.map, ANN_SERVO_RIGHT, ANN_SWEEP_STEP, ANN_MAP_MAX_AGE_MS);
+  ann_ctl_motors(c, ANN_M_STOP, 0);
+  c.servo_target = c.servo_applied = ANN_SERVO_CENTER;
+  c.servo_timer.set(now, ANN_SERVO_SETTLE_MS);
+  c.sweep_angle = ANN_SERVO_CENTER;
+  c.sweep_dir = 1;
+  c.pinged_here = false;
+  c.ping_timer.set(0, 0);
+  c.infer_requested = c.infer_ready = false;
+  c.infer_action = 3;
+  c.last_action = 3;
+  for (uint8_t i = 0; i < 3; ++i) c.decision_dist[i] = 999;
+  c.blocked_ms = 0;
+  c.crit_angle = 0;
+  c.crit_cm = 999;
+  c.action_raw = 3;
+  c.flags = 0;
+  ann_ctl_enter(c, ANN_ST_DRIVE, now, 0);
+}
+
+static inline bool ann_ctl_servo_ready(const AnnControl &c, uint32_t now) {
+  return c.servo_applied == c.servo_target && c.servo_timer.expired(now);
+}
+
+// Every echo, in every state: into the map, and a critical front reading while driving forward
+// stops at once. true = critical stop (crit_angle / crit_cm set)
+static inline bool ann_ctl_echo(AnnControl &c, int angle, unsigned int cm, uint32_t now) {
+  ann_map_add(c.map, angle, cm, now);
+  if (cm >= 999 || (int)cm > ANN_CRITICAL_DISTANCE) return false;
+  if (angle < ANN_FRONT_LO || angle > ANN_FRONT_HI) return false;  // sides are checked at decision time
+  if (c.motor != ANN_M_FORWARD) return false;  // turning in place or backing up doesn't close in on it
+  c.crit_angle = (uint8_t)angle;
+  c.crit_cm = cm;
+  ann_ctl_motors(c, ANN_M_STOP, 0);
+  ann_ctl_enter(c, ANN_ST_CRITICAL, now, ANN_CRITICAL_MS);
+  return true;
+}
+
+// Sweep task, once the echo ring is drained: move on after a finished ping (reversing at the ends of
+// the sweep, narrower while driving forward), or say when to fire the next one.
+// true = fire a ping now at servo_applied
+static inline bool ann_ctl_sweep(AnnControl &c, uint32_t now, bool echo_busy) {
+  if (echo_busy) return false;
+  if (c.pinged_here) {
+    const bool narrow = c.motor == ANN_M_FORWARD;
+    const int hi = narrow ? ANN_SERVO_CENTER + ANN_DRIVE_SWEEP_HALF : ANN_SERVO_LEFT;
+    const int lo = narrow ? ANN_SERVO_CENTER - ANN_DRIVE_SWEEP_HALF : ANN_SERVO_RIGHT;
+    if (c.sweep_angle + c.sweep_dir * ANN_SWEEP_STEP > hi || c.sweep_angle + c.sweep_dir * ANN_SWEEP_STEP < lo) c.sweep_dir = -c.sweep_dir;
+    c.sweep_angle += c.sweep_dir * ANN_SWEEP_STEP;
+    if (c.sweep_angle > hi) c.sweep_angle = hi;
+    if (c.sweep_angle < lo) c.sweep_angle = lo;
+    c.servo_target = c.sweep_angle;
+    c.pinged_here = false;
+    return false;
+  }
+  if (ann_ctl_servo_ready(c, now) && c.ping_timer.expired(now)) {
+    c.ping_timer.set(now, ANN_PING_INTERVAL_MS);
+    c.pinged_here = true;
+    return true;
+  }
+  return false;
+}
+
+// Servo task: true = write servo_applied to the servo now (settle time is already accounted for)
+static inline bool ann_ctl_servo(AnnControl &c, uint32_t now) {
+  if (c.servo_target == c.servo_applied) return false;
+  const int delta = c.servo_target > c.servo_applied ? c.servo_target - c.servo_applied : c.servo_applied - c.servo_target;
+  uint32_t settle = (uint32_t)ANN_SWEEP_SETTLE_MS * ((delta + ANN_SWEEP_STEP - 1) / ANN_SWEEP_STEP);
+  if (settle > ANN_SERVO_SETTLE_MS) settle = ANN_SERVO_SETTLE_MS;
+  c.servo_applied = c.servo_target;
+  c.servo_timer.set(now, settle);
+  return true;
+}
+
+// Inference task: false if nothing was requested, else the decision distances (cm)
+static inline bool ann_ctl_take_request(AnnControl &c, unsigned int &front, unsigned int &left, unsigned int &right) {
+  if (!c.infer_requested) return false;
+  c.infer_requested = false;
+  left = c.decision_dist[0];
+  right = c.decision_dist[1];
+  front = c.decision_dist[2];
+  return true;
+}
+
+static inline void ann_ctl_infer_done(AnnControl &c, uint8_t action) {
+  c.infer_action = action;
+  c.infer_ready = true;
+}
+
+// Control task; returns ANN_CTL_EV_* bits
+static inline uint8_t ann_ctl_step(AnnControl &c, uint32_t now) {
+  switch (c.state) {
+    case ANN_ST_DRIVE: {
+      unsigned int front, left, right;
+      const uint16_t front_age = c.motor == ANN_M_FORWARD ? ANN_DRIVE_MAX_AGE_MS : 0;
+      if (!ann_map_sector(c.map, ANN_FRONT_LO, ANN_FRONT_HI, now, front, front_age)) {
+        ann_ctl_motors(c, ANN_M_STOP, 0);  // nothing fresh ahead (start-up, after a turn): wait for the sweep
+        break;
+      }
+      if ((int)front <= ANN_CRITICAL_DISTANCE && c.motor == ANN_M_FORWARD) {
+        c.crit_angle = ANN_SERVO_CENTER;
+        c.crit_cm = front;
+        ann_ctl_motors(c, ANN_M_STOP, 0);
+        ann_ctl_enter(c, ANN_ST_CRITICAL, now, ANN_CRITICAL_MS);
+        return ANN_CTL_EV_CRITICAL;
+      }
+      if ((int)front > ANN_SAFE_DISTANCE) {
+        ann_ctl_motors(c, ANN_M_FORWARD, ANN_DRIVE_PWM);
+        break;
+      }
+      ann_ctl_motors(c, ANN_M_STOP, 0);
+      if (!c.blocked) { c.blocked = true; c.blocked_ms = now; }
+      if (!ann_map_sector(c.map, ANN_LEFT_LO, ANN_LEFT_HI, now, left) || !ann_map_sector(c.map, ANN_RIGHT_LO, ANN_RIGHT_HI, now, right))
+        break;  // wait until the sweep has fresh readings on both sides
+      c.decision_dist[0] = left; c.decision_dist[1] = right; c.decision_dist[2] = front;
+      c.infer_requested = true;
+      ann_ctl_enter(c, ANN_ST_INFER, now, 0);
+      return ANN_CTL_EV_REQUEST;
+    }
+    case ANN_ST_CRITICAL:
+      if (c.state_timer.expired(now)) ann_ctl_enter(c, ANN_ST_DRIVE, now, 0);
+      break;
+    case ANN_ST_INFER: {
+      if (!c.infer_ready) break;
+      c.infer_ready = false;
+      uint8_t action = c.infer_action;
+      c.flags = 0;
+      // safety override
+      if (action == 0 && (int)c.decision_dist[2] <= ANN_SAFE_DISTANCE) {
+        c.flags |= ANN_TLM_F_FWD_OVERRIDE;
+        action = 3;  // STOP fallback
+      }
+      if ((action == 1 && (int)c.decision_dist[0] <= ANN_CRITICAL_DISTANCE) ||
+          (action == 2 && (int)c.decision_dist[1] <= ANN_CRITICAL_DISTANCE)) {
+        c.flags |= ANN_TLM_F_SIDE_VETO;
+        action = 3;
+      }
+      c.action_raw = c.infer_action;
+      c.last_action = action;
+      // STOP: back away; otherwise execute the action briefly
+      switch (action) {
+        case 0: ann_ctl_motors(c, ANN_M_FORWARD, ANN_DRIVE_PWM); break;
+        case 1: ann_ctl_motors(c, ANN_M_LEFT, ANN_TURN_PWM); break;
+        case 2: ann_ctl_motors(c, ANN_M_RIGHT, ANN_TURN_PWM); break;
+        default:
+          ann_ctl_motors(c, ANN_M_STOP, 0);
+          ann_ctl_enter(c, ANN_ST_BACKUP_STOP, now, ANN_BACKUP_STOP_MS);
+          return ANN_CTL_EV_DECISION;
+      }
+      ann_ctl_enter(c, ANN_ST_ACTION, now, ANN_ACTION_MS);
+      return ANN_CTL_EV_DECISION;
+    }
+    case ANN_ST_ACTION:
+      if (c.state_timer.expired(now)) { ann_ctl_motors(c, ANN_M_STOP, 0); ann_ctl_enter(c, ANN_ST_ACTION_SETTLE, now, ANN_SETTLE_MS); }
+      break;
+    case ANN_ST_ACTION_SETTLE:
+      if (c.state_timer.expired(now)) {
+        if (c.last_action == 1 || c.last_action == 2) ann_map_clear(c.map);  // map was in the old heading
+        ann_ctl_enter(c, ANN_ST_DRIVE, now, 0);
+      }
+      break;
+    case ANN_ST_BACKUP_STOP:
+      if (c.state_timer.expired(now)) { ann_ctl_motors(c, ANN_M_BACKWARD, ANN_BACKUP_PWM); ann_ctl_enter(c, ANN_ST_BACKUP, now, ANN_BACKUP_MS); }
+      break;
+    case ANN_ST_BACKUP:
+      if (c.state_timer.expired(now)) { ann_ctl_motors(c, ANN_M_STOP, 0); ann_ctl_enter(c, ANN_ST_BACKUP_SETTLE, now, ANN_SETTLE_MS); }
+      break;
+    case ANN_ST_BACKUP_SETTLE:
+      if (c.state_timer.expired(now)) ann_ctl_enter(c, ANN_ST_DRIVE, now, 0);
+      break;
+  }
+  return 0;
+}
+
+#endif // ANN_CONTROL_H
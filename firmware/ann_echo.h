@@ -0,0 +1,109 @@
+// ann_echo.h
+// Interrupt-driven HC-SR04 echo capture.
+// - The main loop fires the 10 us trigger and calls ann_echo_trigger(); the ECHO pin-change
+//   interrupt calls ann_echo_edge() on both edges, so nothing waits in pulseIn
+// - Finished pings land in a small single-producer/single-consumer ring of timestamped samples
+//   (echo width + servo angle at trigger time); the main loop drains it with ann_echo_pop()
+// - ann_echo_poll() turns a ping that never finished into a "no echo" sample after the same
+//   30 ms budget as the old pulseIn(ECHO, HIGH, 30000UL)
+// - Plain C++ with no Arduino calls, so the host HAL and tools replay recorded echo timings
+//   through exactly this code
+#ifndef ANN_ECHO_H
+#define ANN_ECHO_H
+
+#include <stdint.h>
+
+#if defined(__AVR__)
+  #include <avr/io.h>
+  #include <avr/interrupt.h>
+  #define ANN_ECHO_LOCK()   uint8_t ann_sreg_ = SREG; cli()
+  #define ANN_ECHO_UNLOCK() SREG = ann_sreg_
+#else
+  #define ANN_ECHO_LOCK()
+  #define ANN_ECHO_UNLOCK()
+#endif
+
+const uint8_t ANN_ECHO_RING = 8;              // power of two
+const uint32_t ANN_ECHO_TIMEOUT_US = 30000UL; // longest echo accepted (~510 cm)
+const uint32_t ANN_ECHO_START_US = 2000UL;    // trigger -> rising edge allowance (burst + module latency)
+// What the module does on the host (host/Arduino.h, training/world_sim.h): echo rises this long
+// after the trigger, and stays high for the round trip or, with nothing heard, for the module's own timeout
+const uint32_t ANN_ECHO_RISE_US = 460UL;
+const uint32_t ANN_ECHO_NONE_US = 38000UL;
+
+struct AnnEchoSample {
+  uint32_t t_us;     // trigger time
+  uint16_t width_us; // 0 = no echo
+  uint8_t angle;     // servo angle when the ping was fired
+};
+
+struct AnnEcho {
+  AnnEchoSample ring[ANN_ECHO_RING];
+  volatile uint8_t head, tail; // ISR writes head, loop writes tail
+  volatile uint8_t phase;      // 0 idle, 1 waiting for rising edge, 2 echo high
+  volatile uint32_t rise_us;
+  uint32_t trig_us;
+  uint8_t angle;
+  uint8_t dropped;             // samples lost to a full ring
+};
+
+static inline void ann_echo_init(AnnEcho &e) {
+  e.head = e.tail = 0;
+  e.phase = 0;
+  e.rise_us = e.trig_us = 0;
+  e.angle = 0;
+  e.dropped = 0;
+}
+
+static inline void ann_echo_push_(AnnEcho &e, uint32_t t_us, uint32_t width_us, uint8_t angle) {
+  if ((uint8_t)(e.head - e.tail) >= ANN_ECHO_RING) { e.dropped++; return; }
+  AnnEchoSample &s = e.ring[e.head & (ANN_ECHO_RING - 1)];
+  s.t_us = t_us;
+  s.width_us = width_us > ANN_ECHO_TIMEOUT_US ? 0 : (uint16_t)width_us;
+  s.angle = angle;
+  e.head = e.head + 1;
+}
+
+// Main loop, right after the trigger pulse
+static inline void ann_echo_trigger(AnnEcho &e, uint32_t now_us, uint8_t angle) {
+  e.trig_us = now_us;
+  e.angle = angle;
+  e.phase = 1; // written last: the ISR only looks at trig_us/angle once phase != 0
+}
+
+static inline bool ann_echo_busy(const AnnEcho &e) { return e.phase != 0; }
+
+// ISR on every ECHO level change
+static inline void ann_echo_edge(AnnEcho &e, bool level, uint32_t now_us) {
+  if (level) {
+    if (e.phase == 1) { e.rise_us = now_us; e.phase = 2; }
+  } else if (e.phase == 2) {
+    ann_echo_push_(e, e.trig_us, now_us - e.rise_us, e.angle);
+    e.phase = 0;
+  }
+}
+
+// Main loop: give up on a ping whose echo didn't start or didn't end in time
+static inline void ann_echo_poll(AnnEcho &e, uint32_t now_us) {
+  ANN_ECHO_LOCK();
+  if (e.phase != 0 && (uint32_t)(now_us - e.trig_us) > ANN_ECHO_START_US + ANN_ECHO_TIMEOUT_US) {
+    ann_echo_push_(e, e.trig_us, 0, e.angle);
+    e.phase = 0;
+  }
+  ANN_ECHO_UNLOCK();
+}
+
+static inline bool ann_echo_pop(AnnEcho &e, AnnEchoSample &out) {
+  if (e.tail == e.head) return false;
+  out = e.ring[e.tail & (ANN_ECHO_RING - 1)];
+  e.tail = e.tail + 1;
+  return true;
+}
+
+// Same rounding as readUltrasonicOnce: (duration * 0.034) / 2 + 0.5, 999 = no echo
+static inline unsigned int ann_echo_cm(uint16_t width_us) {
+  if (width_us == 0) return 999;
+  return (unsigned int)(((uint32_t)width_us * 17UL + 500UL) / 1000UL);
+}
+
+#endif // ANN_ECHO_H
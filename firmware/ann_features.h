@@ -0,0 +1,68 @@
+// ann_features.h
+// Input contract of the model: distance readings -> the network's 5 input features.
+// The one definition used by the trainer (training/dataset_io.h), the host simulators and decoders and
+// the firmware; generated model headers record the contract they were trained with
+// (ANN_MODEL_FEATURES) and do not compile against a different one.
+// - Distances are cm; anything at or beyond ANN_FEAT_RANGE_CM, including the ANN_FEAT_NO_ECHO (999)
+//   timeout, means nothing in range and clamps to the range, so no reading leaves the trained domain
+// - Derived features come from the clamped distances: diff = left - right, minLR = min(left, right)
+// - Feature = clamped cm / ANN_FEAT_RANGE_CM: front, left, right, minLR in 0..1, diff in -1..1
+// - ann_features(): float features for the float and int8 networks
+// - ann_features_q14(): integer-only variant, Q14 (1.0 = 16384), rounded half away from zero
+#ifndef ANN_FEATURES_H
+#define ANN_FEATURES_H
+
+#include <stdint.h>
+
+#define ANN_FEAT_VERSION 1  // bump when a feature definition below changes
+
+const uint8_t ANN_FEAT_COUNT = 5;
+const uint16_t ANN_FEAT_RANGE_CM = 100;
+const uint16_t ANN_FEAT_NO_ECHO = 999;
+const int32_t ANN_FEAT_Q14_ONE = 16384;
+enum AnnFeature { ANN_FEAT_FRONT, ANN_FEAT_LEFT, ANN_FEAT_RIGHT, ANN_FEAT_DIFF, ANN_FEAT_MINLR };
+
+// Contract id: version, feature count, range (stored in model headers and binary datasets)
+constexpr uint32_t ANN_FEAT_CONTRACT =
+  ((uint32_t)ANN_FEAT_VERSION << 24) | ((uint32_t)ANN_FEAT_COUNT << 16) | ANN_FEAT_RANGE_CM;
+
+static_assert(ANN_FEAT_NO_ECHO >= ANN_FEAT_RANGE_CM, "the no-echo sentinel must clamp to the range");
+
+constexpr uint16_t ann_feat_clamp_cm(unsigned int d) {
+  return d >= ANN_FEAT_RANGE_CM ? ANN_FEAT_RANGE_CM : (uint16_t)d;
+}
+
+// Host data may hold fractional cm
+constexpr float ann_feat_clamp_cmf(float d) {
+  return d > (float)ANN_FEAT_RANGE_CM ? (float)ANN_FEAT_RANGE_CM : (d < 0.0f ? 0.0f : d);
+}
+
+// Features from distances already clamped to 0..ANN_FEAT_RANGE_CM
+static inline void ann_features_cm(float front, float left, float right, float (&out)[ANN_FEAT_COUNT]) {
+  const float range = (float)ANN_FEAT_RANGE_CM;
+  out[ANN_FEAT_FRONT] = front / range;
+  out[ANN_FEAT_LEFT] = left / range;
+  out[ANN_FEAT_RIGHT] = right / range;
+  out[ANN_FEAT_DIFF] = (left - right) / range;
+  out[ANN_FEAT_MINLR] = (left < right ? left : right) / range;
+}
+
+static inline void ann_features(unsigned int front, unsigned int left, unsigned int right, float (&out)[ANN_FEAT_COUNT]) {
+  ann_features_cm(ann_feat_clamp_cm(front), ann_feat_clamp_cm(left), ann_feat_clamp_cm(right), out);
+}
+
+constexpr int16_t ann_feat_q14(int16_t cm) {
+  return (int16_t)(((int32_t)cm * ANN_FEAT_Q14_ONE + (cm < 0 ? -(int32_t)(ANN_FEAT_RANGE_CM / 2) : (int32_t)(ANN_FEAT_RANGE_CM / 2)))
+                   / (int32_t)ANN_FEAT_RANGE_CM);
+}
+
+static inline void ann_features_q14(unsigned int front, unsigned int left, unsigned int right, int16_t (&out)[ANN_FEAT_COUNT]) {
+  const int16_t f = (int16_t)ann_feat_clamp_cm(front), l = (int16_t)ann_feat_clamp_cm(left), r = (int16_t)ann_feat_clamp_cm(right);
+  out[ANN_FEAT_FRONT] = ann_feat_q14(f);
+  out[ANN_FEAT_LEFT] = ann_feat_q14(l);
+  out[ANN_FEAT_RIGHT] = ann_feat_q14(r);
+  out[ANN_FEAT_DIFF] = ann_feat_q14((int16_t)(l - r));
+  out[ANN_FEAT_MINLR] = ann_feat_q14(l < r ? l : r);
+}
+
+#endif // ANN_FEATURES_H
@@ -0,0 +1,53 @@
+// ann_lattice.h
+// Decision lattice: the network's action for every input the firmware can produce, stored in flash.
+// - taskInference rounds each distance to whole cm and the input contract (ann_features.h) clamps it at
+//   ANN_FEAT_RANGE_CM (999 = no echo also becomes the maximum), so the policy's domain is the 101^3
+//   integer grid (front, left, right)
+// - training/compile_lattice evaluates the generated forward pass on every grid point, compresses the
+//   result and checks the lookup against the network on all of them before writing models/arduino_lattice.h
+// - Compression: a decision tree whose splits test one of the model's own features in cm (front, left,
+//   right, left - right + 100, min(left, right)), so the diff/minLR boundaries cost one comparison; the
+//   isolated points near the network's noisy boundaries are cheaper as an exception list than as subtrees
+// Tree bytes, preorder:
+//   leaf   0x80 | action
+//   split  feature (0..4), threshold, right child offset (uint16 LE); go left (next node) when value <= threshold
+// Exceptions: bucketed by front distance; start[f] .. start[f + 1] index the sorted uint16 entries
+//   ((left * 101 + right) << 2 | action) of that bucket, looked up by binary search before the tree walk
+#ifndef ANN_LATTICE_H
+#define ANN_LATTICE_H
+
+#include <stdint.h>
+#include "ann_pgm.h"
+#include "ann_features.h"
+
+const uint8_t ANN_LATTICE_MAX_CM = (uint8_t)ANN_FEAT_RANGE_CM;
+static_assert(ANN_FEAT_RANGE_CM <= 126, "exception keys ((left * (max + 1) + right) << 2 | action) must fit 16 bits");
+const uint8_t ANN_LATTICE_LEAF = 0x80;
+const uint8_t ANN_LATTICE_FEATURES = 5;  // front, left, right, diff + 100, minLR
+
+static inline uint8_t ann_lattice_cm(unsigned int d) { return (uint8_t)ann_feat_clamp_cm(d); }
+
+static inline uint8_t ann_lattice_lookup(const uint8_t *tree, const uint16_t *exc_start, const uint16_t *exc,
+                                         uint8_t front, uint8_t left, uint8_t right) {
+  const uint16_t key = (uint16_t)(left * (ANN_LATTICE_MAX_CM + 1) + right);
+  uint16_t lo = ann_pgm_u16(exc_start + front), hi = ann_pgm_u16(exc_start + front + 1);
+  while (lo < hi) {
+    const uint16_t mid = (uint16_t)((lo + hi) >> 1);
+    const uint16_t e = ann_pgm_u16(exc + mid);
+    if ((e >> 2) == key) return (uint8_t)(e & 3);
+    if ((e >> 2) < key) lo = (uint16_t)(mid + 1);
+    else hi = mid;
+  }
+
+  const uint8_t v[ANN_LATTICE_FEATURES] = {
+    front, left, right, (uint8_t)(ANN_LATTICE_MAX_CM + left - right), left < right ? left : right };
+  uint16_t i = 0;
+  for (;;) {
+    const uint8_t k = ann_pgm_u8(tree + i);
+    if (k & ANN_LATTICE_LEAF) return (uint8_t)(k & 0x7F);
+    if (v[k] <= ann_pgm_u8(tree + i + 1)) i = (uint16_t)(i + 4);
+    else i = (uint16_t)(ann_pgm_u8(tree + i + 2) | ((uint16_t)ann_pgm_u8(tree + i + 3) << 8));
+  }
+}
+
+#endif // ANN_LATTICE_H
@@ -0,0 +1,86 @@
+// ann_mlp.h
+// Compile-time specialized float MLP forward pass for weights generated into models/arduino_weights.h.
+// - Layer sizes are template parameters; weights/bias/activations are passed as sized array
+//   references, so a model whose dimensions don't match the firmware fails to compile
+// - Weights are read from flash (PROGMEM, see ann_pgm.h), row-major [out][in]
+// - The dot product over inputs is unrolled by template recursion (no loop counter / branch per MAC).
+//   Unrolling the output loop too (ANN_UNROLL_OUTPUTS) multiplies code size by the layer width and
+//   only fits flash for small networks, so it is opt-in.
+// - Summation order matches the host (sum_c W*x, then + bias)
+#ifndef ANN_MLP_H
+#define ANN_MLP_H
+
+#include <stdint.h>
+#include "ann_pgm.h"
+
+#ifndef ANN_INLINE
+  #define ANN_INLINE inline __attribute__((always_inline))
+#endif
+
+#ifndef ANN_MAC_HOOK
+  #define ANN_MAC_HOOK() // host benchmarks count MACs here
+#endif
+
+// sum_{c < I} w[c] * x[c], left to right
+template <uint16_t I>
+struct AnnDot {
+  static ANN_INLINE float run(const float *w, const float *x) {
+    ANN_MAC_HOOK();
+    return AnnDot<I - 1>::run(w, x) + ann_pgm_f32(w + (I - 1)) * x[I - 1];
+  }
+};
+template <>
+struct AnnDot<1> {
+  static ANN_INLINE float run(const float *w, const float *x) {
+    ANN_MAC_HOOK();
+    return 0.0f + ann_pgm_f32(w) * x[0];
+  }
+};
+
+template <uint16_t IN, bool RELU>
+static ANN_INLINE float ann_neuron(const float *w, const float *b, const float *x) {
+  float s = AnnDot<IN>::run(w, x) + ann_pgm_f32(b);
+  return (RELU && !(s > 0.0f)) ? 0.0f : s;
+}
+
+#ifdef ANN_UNROLL_OUTPUTS
+template <uint16_t IN, uint16_t O, bool RELU>
+struct AnnRows {
+  static ANN_INLINE void run(const float *W, const float *B, const float *x, float *y) {
+    AnnRows<IN, O - 1, RELU>::run(W, B, x, y);
+    y[O - 1] = ann_neuron<IN, RELU>(W + (uint16_t)(O - 1) * IN, B + (O - 1), x);
+  }
+};
+template <uint16_t IN, bool RELU>
+struct AnnRows<IN, 0, RELU> {
+  static ANN_INLINE void run(const float *, const float *, const float *, float *) {}
+};
+#endif
+
+// One fully-connected layer: out = act(W * in + B)
+template <uint16_t IN, uint16_t OUT, bool RELU>
+static inline void ann_dense(const float (&W)[OUT * IN], const float (&B)[OUT],
+                             const float (&in)[IN], float (&out)[OUT]) {
+#ifdef ANN_UNROLL_OUTPUTS
+  AnnRows<IN, OUT, RELU>::run(W, B, in, out);
+#else
+  for (uint16_t o = 0; o < OUT; ++o) out[o] = ann_neuron<IN, RELU>(W + o * IN, B + o, in);
+#endif
+}
+
+// View the front of a scratch buffer as a smaller sized array (ping-pong activations)
+template <uint16_t N, uint16_t CAP>
+static inline float (&ann_view(float (&buf)[CAP]))[N] {
+  static_assert(N <= CAP, "activation buffer too small for layer");
+  return *reinterpret_cast<float (*)[N]>(buf);
+}
+
+// First maximum wins (matches the host argmax)
+template <uint16_t N>
+static inline uint8_t ann_argmax(const float (&v)[N]) {
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < N; ++i) if (v[i] > v[best]) best = i;
+  return best;
+}
+
+#endif // ANN_MLP_H
@@ -0,0 +1,26 @@
+// ann_pgm.h
+// Flash (PROGMEM) access shim so model tables and kernels compile unchanged on AVR and on the host.
+// On AVR the arrays live in flash and are read with pgm_read_*; elsewhere they are plain const data.
+#ifndef ANN_PGM_H
+#define ANN_PGM_H
+
+#include <stdint.h>
+
+#if defined(__AVR__)
+  #include <avr/pgmspace.h>
+  #define ANN_PROGMEM PROGMEM
+  static inline uint8_t ann_pgm_u8(const uint8_t *p)  { return pgm_read_byte(p); }
+  static inline uint16_t ann_pgm_u16(const uint16_t *p) { return pgm_read_word(p); }
+  static inline int8_t  ann_pgm_i8(const int8_t *p)   { return (int8_t)pgm_read_byte(p); }
+  static inline int32_t ann_pgm_i32(const int32_t *p) { return (int32_t)pgm_read_dword(p); }
+  static inline float   ann_pgm_f32(const float *p)   { return pgm_read_float(p); }
+#else
+  #define ANN_PROGMEM
+  static inline uint8_t ann_pgm_u8(const uint8_t *p)  { return *p; }
+  static inline uint16_t ann_pgm_u16(const uint16_t *p) { return *p; }
+  static inline int8_t  ann_pgm_i8(const int8_t *p)   { return *p; }
+  static inline int32_t ann_pgm_i32(const int32_t *p) { return *p; }
+  static inline float   ann_pgm_f32(const float *p)   { return *p; }
+#endif
+
+#endif // ANN_PGM_H
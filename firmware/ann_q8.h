@@ -0,0 +1,60 @@
+// ann_q8.h
+// Integer-only int8 MLP kernels. Shared by the firmware and the host quantizer
+// (training/quantize.h) so the parity report measures exactly what runs on the Uno.
+//
+// Layout produced by the trainer (models/arduino_weights_q8.h):
+//   weights  int8  row-major [out][in], in flash
+//   biases   int32 at scale s_in*s_w
+//   hidden   acc = B + sum W*x (int32), ReLU, then (acc * mult + round) >> shift, clamped to 0..127
+//   output   raw int32 accumulators; argmax needs no rescale (one scale per layer)
+//   input    Q14 features (ann_features_q14) requantized to the input scale with (Q8_IN_MULT, Q8_IN_SHIFT)
+// Multipliers are chosen by the exporter so acc*mult (and |x_q14|*Q8_IN_MULT) never overflows int32.
+#ifndef ANN_Q8_H
+#define ANN_Q8_H
+
+#include <stdint.h>
+#include "ann_pgm.h"
+
+// Quantize one Q14 input to the int8 input scale: (|x| * mult + round) >> shift, rounded half away
+// from zero and clamped to int8
+static inline int8_t ann_q8_quantize_q14(int16_t x, int32_t mult, uint8_t shift) {
+  const int32_t round = shift ? ((int32_t)1 << (shift - 1)) : 0;
+  const int32_t a = x < 0 ? -(int32_t)x : (int32_t)x;
+  int32_t q = (a * mult + round) >> shift;
+  if (q > 127) q = 127;
+  return (int8_t)(x < 0 ? -q : q);
+}
+
+// Hidden layer: int8 in -> int8 out (ReLU + requantize)
+static void ann_q8_dense_relu(const int8_t *W, const int32_t *B, uint16_t n_in, uint16_t n_out,
+                              int32_t mult, uint8_t shift, const int8_t *in, int8_t *out) {
+  const int32_t round = shift ? ((int32_t)1 << (shift - 1)) : 0;
+  for (uint16_t o = 0; o < n_out; ++o) {
+    int32_t acc = ann_pgm_i32(B + o);
+    const int8_t *w = W + (uint32_t)o * n_in;
+    for (uint16_t c = 0; c < n_in; ++c) acc += (int16_t)ann_pgm_i8(w + c) * (int16_t)in[c];
+    if (acc <= 0) { out[o] = 0; continue; }
+    int32_t q = (acc * mult + round) >> shift;
+    out[o] = (int8_t)(q > 127 ? 127 : q);
+  }
+}
+
+// Output layer: int8 in -> int32 logits
+static void ann_q8_dense_out(const int8_t *W, const int32_t *B, uint16_t n_in, uint16_t n_out,
+                             const int8_t *in, int32_t *out) {
+  for (uint16_t o = 0; o < n_out; ++o) {
+    int32_t acc = ann_pgm_i32(B + o);
+    const int8_t *w = W + (uint32_t)o * n_in;
+    for (uint16_t c = 0; c < n_in; ++c) acc += (int16_t)ann_pgm_i8(w + c) * (int16_t)in[c];
+    out[o] = acc;
+  }
+}
+
+// First maximum wins (matches the float path)
+static inline uint8_t ann_q8_argmax(const int32_t *v, uint8_t n) {
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < n; ++i) if (v[i] > v[best]) best = i;
+  return best;
+}
+
+#endif // ANN_Q8_H
@@ -0,0 +1,92 @@
+// ann_scanmap.h
+// Angle -> distance map for the continuously sweeping sensor.
+// - One bin per sweep angle, each keeping the last ANN_MAP_DEPTH readings with a 16-bit
+//   millisecond timestamp (126 bytes of SRAM for 9 bins; timestamps wrap after 65 s, the sweep
+//   rewrites every bin long before that)
+// - Reads return the median of the readings younger than max_age_ms (with two fresh readings the
+//   nearer one), so a single dropout or ghost echo doesn't flip a decision; a bin with no fresh
+//   reading reports "unknown" and the caller decides what that means
+// - Sectors (front/left/right) are the nearest value over a range of bins
+// Shared by the firmware and the host world simulator.
+#ifndef ANN_SCANMAP_H
+#define ANN_SCANMAP_H
+
+#include <stdint.h>
+
+const uint8_t ANN_MAP_BINS = 9;  // 30..150 deg in 15 deg steps
+const uint8_t ANN_MAP_DEPTH = 3;
+
+struct AnnMapBin {
+  uint16_t cm[ANN_MAP_DEPTH];
+  uint16_t t_ms[ANN_MAP_DEPTH];
+  uint8_t count;  // readings stored so far (saturates at ANN_MAP_DEPTH)
+  uint8_t next;
+};
+
+struct AnnScanMap {
+  AnnMapBin bins[ANN_MAP_BINS];
+  uint8_t angle0, step;  // angle of bin 0, degrees per bin
+  uint16_t max_age_ms;   // must stay below 32768 (16-bit timestamps)
+};
+
+static inline void ann_map_clear(AnnScanMap &m) {
+  for (uint8_t b = 0; b < ANN_MAP_BINS; ++b) { m.bins[b].count = 0; m.bins[b].next = 0; }
+}
+
+static inline void ann_map_init(AnnScanMap &m, uint8_t angle0, uint8_t step, uint16_t max_age_ms) {
+  m.angle0 = angle0; m.step = step; m.max_age_ms = max_age_ms;
+  ann_map_clear(m);
+}
+
+// Nearest bin for an angle, or -1 outside the map
+static inline int8_t ann_map_bin_of(const AnnScanMap &m, int angle) {
+  const int b = (angle - (int)m.angle0 + m.step / 2) / (int)m.step;
+  if (angle < (int)m.angle0 - m.step / 2 || b < 0 || b >= ANN_MAP_BINS) return -1;
+  return (int8_t)b;
+}
+
+static inline void ann_map_add(AnnScanMap &m, int angle, unsigned int cm, uint32_t now_ms) {
+  const int8_t b = ann_map_bin_of(m, angle);
+  if (b < 0) return;
+  AnnMapBin &bin = m.bins[b];
+  bin.cm[bin.next] = cm > 999 ? 999 : (uint16_t)cm;
+  bin.t_ms[bin.next] = (uint16_t)now_ms;
+  bin.next = (uint8_t)((bin.next + 1) % ANN_MAP_DEPTH);
+  if (bin.count < ANN_MAP_DEPTH) bin.count++;
+}
+
+// Median of the fresh readings in bin b; false if none is fresh. max_age_ms = 0 uses the map's
+// age limit; a shorter one suits a robot that is closing in on what it measured.
+static inline bool ann_map_bin_value(const AnnScanMap &m, uint8_t b, uint32_t now_ms, unsigned int &cm, uint16_t max_age_ms = 0) {
+  const AnnMapBin &bin = m.bins[b];
+  const uint16_t age = max_age_ms ? max_age_ms : m.max_age_ms;
+  uint16_t v[ANN_MAP_DEPTH];
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < bin.count; ++i)
+    if ((uint16_t)((uint16_t)now_ms - bin.t_ms[i]) <= age) v[n++] = bin.cm[i];
+  if (n == 0) return false;
+  // insertion sort of at most ANN_MAP_DEPTH values
+  for (uint8_t i = 1; i < n; ++i)
+    for (uint8_t j = i; j > 0 && v[j] < v[j - 1]; --j) { uint16_t t = v[j]; v[j] = v[j - 1]; v[j - 1] = t; }
+  cm = (n % 2) ? v[n / 2] : v[n / 2 - 1];
+  return true;
+}
+
+// Nearest filtered distance over the bins covering [angle_lo, angle_hi]; false if any bin in the
+// sector has no fresh reading (an unknown direction is never reported as clear)
+static inline bool ann_map_sector(const AnnScanMap &m, int angle_lo, int angle_hi, uint32_t now_ms, unsigned int &cm,
+                                  uint16_t max_age_ms = 0) {
+  int8_t lo = ann_map_bin_of(m, angle_lo), hi = ann_map_bin_of(m, angle_hi);
+  if (lo < 0 || hi < 0) return false;
+  if (lo > hi) { int8_t t = lo; lo = hi; hi = t; }
+  unsigned int best = 999;
+  for (int8_t b = lo; b <= hi; ++b) {
+    unsigned int v;
+    if (!ann_map_bin_value(m, (uint8_t)b, now_ms, v, max_age_ms)) return false;
+    if (v < best) best = v;
+  }
+  cm = best;
+  return true;
+}
+
+#endif // ANN_SCANMAP_H
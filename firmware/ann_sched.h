@@ -0,0 +1,52 @@
+// ann_sched.h
+// Minimal cooperative scheduler for the firmware control loop.
+// - Every task is a plain function called from loop() when its period has elapsed; tasks never
+//   block, they keep their progress in state variables and return
+// - All time comparisons are (now - start) >= duration on uint32_t, so millis() wrap-around
+//   (every ~49.7 days) is harmless
+// - Each task records its worst-case run time in microseconds (ann_sched_max_us) so the cost of
+//   one loop() pass can be checked on the robot and on the host HAL
+#ifndef ANN_SCHED_H
+#define ANN_SCHED_H
+
+#include <stdint.h>
+
+// One-shot timer in milliseconds
+struct AnnTimer {
+  uint32_t start;
+  uint32_t duration;
+  void set(uint32_t now, uint32_t ms) { start = now; duration = ms; }
+  bool expired(uint32_t now) const { return (uint32_t)(now - start) >= duration; }
+};
+
+typedef void (*AnnTaskFn)(uint32_t now);
+
+struct AnnTask {
+  AnnTaskFn fn;
+  uint16_t period_ms;  // 0 = every pass
+  uint32_t last_ms;
+  uint32_t max_us;     // longest single run seen
+};
+
+// Run every due task once; call from loop() with the current millis()/micros()
+template <uint8_t N>
+static inline void ann_sched_run(AnnTask (&tasks)[N], uint32_t now_ms, uint32_t (*clock_us)()) {
+  for (uint8_t i = 0; i < N; ++i) {
+    AnnTask &t = tasks[i];
+    if (t.period_ms && (uint32_t)(now_ms - t.last_ms) < t.period_ms) continue;
+    t.last_ms = now_ms;
+    const uint32_t t0 = clock_us();
+    t.fn(now_ms);
+    const uint32_t dt = clock_us() - t0;
+    if (dt > t.max_us) t.max_us = dt;
+  }
+}
+
+template <uint8_t N>
+static inline uint32_t ann_sched_max_us(const AnnTask (&tasks)[N]) {
+  uint32_t m = 0;
+  for (uint8_t i = 0; i < N; ++i) if (tasks[i].max_us > m) m = tasks[i].max_us;
+  return m;
+}
+
+#endif // ANN_SCHED_H
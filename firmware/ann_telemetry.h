@@ -0,0 +1,213 @@
+// ann_telemetry.h
+// Framed binary telemetry for the serial link (replaces the Serial.print text logs).
+// - Frame: 0xA5 0x5A | type | payload length | payload | Fletcher-16 over type..payload
+//   All fields little-endian; every record type has a fixed payload size
+// - A decision frame is 54 bytes, so it fits the Uno's 64-byte TX buffer: the firmware only
+//   writes a frame when the buffer has room for all of it and never waits on the UART
+// - Every frame carries a sequence number; frames dropped on a full buffer still consume one,
+//   so the decoder can count the gaps
+// - Encoders and the byte-at-a-time parser are plain C++, shared by the firmware and
+//   training/telemetry_decode.cpp
+// Verbosity is a compile-time switch: define ANN_TELEMETRY (sketch or -D) before this header
+//   0 = no telemetry (Serial not even started), 1 = decisions + events (default), 2 = also every echo
+#ifndef ANN_TELEMETRY_H
+#define ANN_TELEMETRY_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef ANN_TELEMETRY
+  #define ANN_TELEMETRY 1
+#endif
+
+const uint8_t ANN_TLM_SYNC0 = 0xA5, ANN_TLM_SYNC1 = 0x5A;
+
+enum AnnTlmType : uint8_t {
+  ANN_TLM_EVENT = 1,
+  ANN_TLM_DECISION = 2,
+  ANN_TLM_ECHO = 3
+};
+
+enum AnnTlmEventKind : uint8_t {
+  ANN_EV_BOOT = 0,
+  ANN_EV_CRITICAL = 1   // motors cut on a front echo within CRITICAL_DISTANCE
+};
+
+// Decision flags
+const uint8_t ANN_TLM_F_FWD_OVERRIDE = 0x01;  // FORWARD refused, front within SAFE_DISTANCE
+const uint8_t ANN_TLM_F_SIDE_VETO = 0x02;     // turn refused, that side within CRITICAL_DISTANCE
+const uint8_t ANN_TLM_F_Q8 = 0x04;            // int8 model: logits are raw int32 accumulators
+const uint8_t ANN_TLM_F_CRITICAL = 0x08;      // a critical stop happened since the previous decision
+const uint8_t ANN_TLM_F_LATTICE = 0x10;       // decision lattice (arduino_lattice.h): logits are zero
+
+const uint8_t ANN_TLM_EVENT_LEN = 9;
+const uint8_t ANN_TLM_DECISION_LEN = 48;
+const uint8_t ANN_TLM_ECHO_LEN = 8;
+const uint8_t ANN_TLM_OVERHEAD = 6;  // sync, type, length, checksum
+const uint8_t ANN_TLM_MAX_PAYLOAD = ANN_TLM_DECISION_LEN;
+const uint8_t ANN_TLM_MAX_FRAME = ANN_TLM_MAX_PAYLOAD + ANN_TLM_OVERHEAD;
+
+struct AnnTlmEvent {
+  uint32_t t_ms;
+  uint8_t seq;
+  uint8_t kind;
+  uint8_t angle;        // servo angle of the reading that caused it
+  uint16_t cm;
+};
+
+struct AnnTlmDecision {
+  uint32_t t_ms;
+  uint8_t seq;
+  uint8_t flags;
+  uint8_t action_raw;   // argmax of the model
+  uint8_t action;       // after the safety overrides
+  uint16_t dist_cm[3];  // left, right, front (filtered, from the map)
+  int16_t in_q14[5];    // model inputs in Q14 (ann_features_q14)
+  float logits[4];
+  // phase timings of this decision cycle
+  uint16_t drive_ms;    // DRIVE entered -> front blocked
+  uint16_t wait_ms;     // front blocked -> both sides fresh, inference requested
+  uint16_t infer_us;    // forward pass
+  uint16_t pass_max_us; // longest loop() pass since the previous decision
+};
+
+struct AnnTlmEcho {
+  uint32_t t_ms;
+  uint8_t seq;
+  uint8_t angle;
+  uint16_t width_us;    // 0 = no echo
+};
+
+// --- byte packing ---
+
+static inline void ann_tlm_put16(uint8_t *&p, uint16_t v) { *p++ = (uint8_t)v; *p++ = (uint8_t)(v >> 8); }
+static inline void ann_tlm_put32(uint8_t *&p, uint32_t v) { ann_tlm_put16(p, (uint16_t)v); ann_tlm_put16(p, (uint16_t)(v >> 16)); }
+static inline void ann_tlm_putf(uint8_t *&p, float f) { uint32_t v; memcpy(&v, &f, 4); ann_tlm_put32(p, v); }
+static inline uint16_t ann_tlm_get16(const uint8_t *&p) { uint16_t v = (uint16_t)(p[0] | ((uint16_t)p[1] << 8)); p += 2; return v; }
+static inline uint32_t ann_tlm_get32(const uint8_t *&p) { uint32_t lo = ann_tlm_get16(p); return lo | ((uint32_t)ann_tlm_get16(p) << 16); }
+static inline float ann_tlm_getf(const uint8_t *&p) { uint32_t v = ann_tlm_get32(p); float f; memcpy(&f, &v, 4); return f; }
+
+static inline int16_t ann_tlm_q14(float x) {
+  float v = x * 16384.0f;
+  v += (v >= 0.0f) ? 0.5f : -0.5f;
+  if (v > 32767.0f) return 32767;
+  if (v < -32767.0f) return -32767;
+  return (int16_t)v;
+}
+
+// Fletcher-16 (mod 255 by conditional subtraction, no division on the AVR)
+static inline uint16_t ann_tlm_fletcher(const uint8_t *p, uint8_t n) {
+  uint16_t a = 0, b = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    a += p[i]; if (a >= 255) a -= 255;
+    b += a; if (b >= 255) b -= 255;
+  }
+  return (uint16_t)((b << 8) | a);
+}
+
+// Wrap a payload already written at out + 4; returns the frame size
+static inline uint8_t ann_tlm_seal(uint8_t *out, uint8_t type, uint8_t len) {
+  out[0] = ANN_TLM_SYNC0; out[1] = ANN_TLM_SYNC1; out[2] = type; out[3] = len;
+  uint8_t *p = out + 4 + len;
+  ann_tlm_put16(p, ann_tlm_fletcher(out + 2, (uint8_t)(len + 2)));
+  return (uint8_t)(len + ANN_TLM_OVERHEAD);
+}
+
+static inline uint8_t ann_tlm_encode(const AnnTlmEvent &e, uint8_t *out) {
+  uint8_t *p = out + 4;
+  ann_tlm_put32(p, e.t_ms);
+  *p++ = e.seq; *p++ = e.kind; *p++ = e.angle;
+  ann_tlm_put16(p, e.cm);
+  return ann_tlm_seal(out, ANN_TLM_EVENT, ANN_TLM_EVENT_LEN);
+}
+
+static inline uint8_t ann_tlm_encode(const AnnTlmDecision &d, uint8_t *out) {
+  uint8_t *p = out + 4;
+  ann_tlm_put32(p, d.t_ms);
+  *p++ = d.seq; *p++ = d.flags; *p++ = d.action_raw; *p++ = d.action;
+  for (uint8_t i = 0; i < 3; ++i) ann_tlm_put16(p, d.dist_cm[i]);
+  for (uint8_t i = 0; i < 5; ++i) ann_tlm_put16(p, (uint16_t)d.in_q14[i]);
+  for (uint8_t i = 0; i < 4; ++i) ann_tlm_putf(p, d.logits[i]);
+  ann_tlm_put16(p, d.drive_ms); ann_tlm_put16(p, d.wait_ms);
+  ann_tlm_put16(p, d.infer_us); ann_tlm_put16(p, d.pass_max_us);
+  return ann_tlm_seal(out, ANN_TLM_DECISION, ANN_TLM_DECISION_LEN);
+}
+
+static inline uint8_t ann_tlm_encode(const AnnTlmEcho &e, uint8_t *out) {
+  uint8_t *p = out + 4;
+  ann_tlm_put32(p, e.t_ms);
+  *p++ = e.seq; *p++ = e.angle;
+  ann_tlm_put16(p, e.width_us);
+  return ann_tlm_seal(out, ANN_TLM_ECHO, ANN_TLM_ECHO_LEN);
+}
+
+// --- decoding ---
+
+static inline void ann_tlm_decode(const uint8_t *p, AnnTlmEvent &e) {
+  e.t_ms = ann_tlm_get32(p);
+  e.seq = p[0]; e.kind = p[1]; e.angle = p[2]; p += 3;
+  e.cm = ann_tlm_get16(p);
+}
+
+static inline void ann_tlm_decode(const uint8_t *p, AnnTlmDecision &d) {
+  d.t_ms = ann_tlm_get32(p);
+  d.seq = p[0]; d.flags = p[1]; d.action_raw = p[2]; d.action = p[3]; p += 4;
+  for (uint8_t i = 0; i < 3; ++i) d.dist_cm[i] = ann_tlm_get16(p);
+  for (uint8_t i = 0; i < 5; ++i) d.in_q14[i] = (int16_t)ann_tlm_get16(p);
+  for (uint8_t i = 0; i < 4; ++i) d.logits[i] = ann_tlm_getf(p);
+  d.drive_ms = ann_tlm_get16(p); d.wait_ms = ann_tlm_get16(p);
+  d.infer_us = ann_tlm_get16(p); d.pass_max_us = ann_tlm_get16(p);
+}
+
+static inline void ann_tlm_decode(const uint8_t *p, AnnTlmEcho &e) {
+  e.t_ms = ann_tlm_get32(p);
+  e.seq = p[0]; e.angle = p[1]; p += 2;
+  e.width_us = ann_tlm_get16(p);
+}
+
+static inline uint8_t ann_tlm_payload_len(uint8_t type) {
+  switch (type) {
+    case ANN_TLM_EVENT: return ANN_TLM_EVENT_LEN;
+    case ANN_TLM_DECISION: return ANN_TLM_DECISION_LEN;
+    case ANN_TLM_ECHO: return ANN_TLM_ECHO_LEN;
+  }
+  return 0;
+}
+
+// Byte-at-a-time frame parser; resynchronizes on the sync bytes after noise or a bad checksum
+struct AnnTlmParser {
+  uint8_t state;  // 0 sync0, 1 sync1, 2 type, 3 length, 4 payload, 5/6 checksum
+  uint8_t type, len, pos;
+  uint8_t buf[ANN_TLM_MAX_PAYLOAD + 2];  // type, length, payload (checksummed bytes)
+  uint16_t check;
+  uint32_t bad;   // frames rejected (unknown type, wrong length, checksum)
+};
+
+static inline void ann_tlm_parser_init(AnnTlmParser &p) { memset(&p, 0, sizeof(p)); }
+
+// Feed one byte; true when p.type / ann_tlm_payload(p) hold a complete, verified frame
+static inline bool ann_tlm_feed(AnnTlmParser &p, uint8_t b) {
+  switch (p.state) {
+    case 0: if (b == ANN_TLM_SYNC0) p.state = 1; return false;
+    case 1: p.state = (b == ANN_TLM_SYNC1) ? 2 : (b == ANN_TLM_SYNC0 ? 1 : 0); return false;
+    case 2: p.type = b; p.buf[0] = b; p.state = 3; return false;
+    case 3:
+      if (ann_tlm_payload_len(p.type) == 0 || b != ann_tlm_payload_len(p.type)) { p.bad++; p.state = 0; return false; }
+      p.len = b; p.buf[1] = b; p.pos = 0; p.state = 4;
+      return false;
+    case 4:
+      p.buf[2 + p.pos++] = b;
+      if (p.pos == p.len) p.state = 5;
+      return false;
+    case 5: p.check = b; p.state = 6; return false;
+    default:
+      p.check = (uint16_t)(p.check | ((uint16_t)b << 8));
+      p.state = 0;
+      if (p.check != ann_tlm_fletcher(p.buf, (uint8_t)(p.len + 2))) { p.bad++; return false; }
+      return true;
+  }
+}
+
+static inline const uint8_t *ann_tlm_payload(const AnnTlmParser &p) { return p.buf + 2; }
+
+#endif // ANN_TELEMETRY_H
@@ -0,0 +1,157 @@
+// host/Arduino.h
+// Host HAL shim: lets robot_ann.ino build and run on Linux/Windows for timing checks.
+// - Fake clock: millis()/micros() read ann_host_hal().now_us; delay(), delayMicroseconds() and
+//   pulseIn() advance it by the time they would take on the board
+// - Pins: pinMode/digitalWrite/analogWrite record the last value per pin (and notify on_pin)
+// - Simulated HC-SR04 (ann_host_sonar): a falling edge on TRIG asks the echo hook for the pulse
+//   width in microseconds (0 = no echo, sent as the module's ~38 ms "nothing heard" pulse) and
+//   schedules the ECHO edges; the registered pin-change handler runs when the clock passes them
+// - pulseIn() asks the same hook and returns 0 after the timeout if there is no echo
+// - Serial prints go to stdout only when ann_host_hal().serial_echo is set; Serial.write() bytes are
+//   kept in serial_tx, and availableForWrite() models a 64-byte TX buffer draining at the baud rate
+// Add -I firmware/host (or /I firmware\host) so <Arduino.h> and <Servo.h> resolve here.
+#ifndef ANN_HOST_ARDUINO_H
+#define ANN_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "../ann_echo.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+typedef uint8_t byte;
+
+static const uint8_t ANN_HOST_PINS = 32;
+
+struct AnnHostEdge {
+  uint64_t t_us;
+  uint8_t pin;
+  uint8_t level;
+};
+
+struct AnnHostHal {
+  uint64_t now_us = 0;
+  uint8_t mode[ANN_HOST_PINS] = {};
+  uint8_t level[ANN_HOST_PINS] = {};
+  int pwm[ANN_HOST_PINS] = {};
+  int servo_angle = -1;
+  uint64_t servo_write_us = 0;
+  bool serial_echo = false;
+  // echo pulse width in us for a ping started at now_us (0 = no echo)
+  std::function<unsigned long(uint64_t now_us)> echo_us;
+  // called after every digitalWrite/analogWrite (pin, value)
+  std::function<void(uint8_t pin, int value)> on_pin;
+  std::function<void(int angle)> on_servo;
+  // simulated HC-SR04
+  uint8_t sonar_trig = 255, sonar_echo = 255;
+  void (*sonar_isr)() = nullptr;
+  std::vector<AnnHostEdge> edges; // pending, in time order
+  // serial
+  std::vector<uint8_t> serial_tx;
+  long serial_baud = 115200;
+  uint64_t serial_busy_until_us = 0;  // when the TX buffer has drained
+};
+
+inline AnnHostHal &ann_host_hal() {
+  static AnnHostHal hal;
+  return hal;
+}
+
+// Move the fake clock forward, delivering pending ECHO edges to the pin-change handler on the way
+inline void ann_host_advance(uint64_t us) {
+  AnnHostHal &h = ann_host_hal();
+  const uint64_t end = h.now_us + us;
+  while (!h.edges.empty() && h.edges.front().t_us <= end) {
+    const AnnHostEdge e = h.edges.front();
+    h.edges.erase(h.edges.begin());
+    if (e.t_us > h.now_us) h.now_us = e.t_us;
+    h.level[e.pin] = e.level;
+    if (h.sonar_isr) h.sonar_isr();
+  }
+  h.now_us = end;
+}
+
+inline void ann_host_edge(const AnnHostEdge &e) {
+  std::vector<AnnHostEdge> &q = ann_host_hal().edges;
+  auto it = q.begin();
+  while (it != q.end() && it->t_us <= e.t_us) ++it;
+  q.insert(it, e);
+}
+
+// Attach a simulated HC-SR04 on trig/echo; isr plays the role of the ECHO pin-change interrupt
+inline void ann_host_sonar(uint8_t trig, uint8_t echo, void (*isr)()) {
+  AnnHostHal &h = ann_host_hal();
+  h.sonar_trig = trig;
+  h.sonar_echo = echo;
+  h.sonar_isr = isr;
+}
+
+inline unsigned long millis() { return (unsigned long)(uint32_t)(ann_host_hal().now_us / 1000); }
+inline unsigned long micros() { return (unsigned long)(uint32_t)ann_host_hal().now_us; }
+inline void delay(unsigned long ms) { ann_host_advance(uint64_t(ms) * 1000); }
+inline void delayMicroseconds(unsigned int us) { ann_host_advance(us); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) { if (pin < ANN_HOST_PINS) ann_host_hal().mode[pin] = mode; }
+inline void digitalWrite(uint8_t pin, uint8_t v) {
+  AnnHostHal &h = ann_host_hal();
+  if (pin == h.sonar_trig && h.sonar_echo < ANN_HOST_PINS && h.level[pin] == HIGH && v == LOW) {
+    // burst goes out ~460 us after the trigger, echo stays high for the round trip
+    const unsigned long w = h.echo_us ? h.echo_us(h.now_us) : 0;
+    const uint64_t rise = h.now_us + ANN_ECHO_RISE_US;
+    ann_host_edge({rise, h.sonar_echo, HIGH});
+    ann_host_edge({rise + (w ? w : ANN_ECHO_NONE_US), h.sonar_echo, LOW});
+  }
+  if (pin < ANN_HOST_PINS) h.level[pin] = v;
+  if (h.on_pin) h.on_pin(pin, v);
+}
+inline int digitalRead(uint8_t pin) { return pin < ANN_HOST_PINS ? ann_host_hal().level[pin] : LOW; }
+inline void analogWrite(uint8_t pin, int v) {
+  AnnHostHal &h = ann_host_hal();
+  if (pin < ANN_HOST_PINS) h.pwm[pin] = v;
+  if (h.on_pin) h.on_pin(pin, v);
+}
+
+inline unsigned long pulseIn(uint8_t, uint8_t, unsigned long timeout = 1000000UL) {
+  AnnHostHal &h = ann_host_hal();
+  const unsigned long w = h.echo_us ? h.echo_us(h.now_us) : 0;
+  if (w == 0 || w >= timeout) {
+    ann_host_advance(timeout);
+    return 0;
+  }
+  ann_host_advance(w);
+  return w;
+}
+
+struct AnnHostSerial {
+  static const int TX_BUFFER = 64;
+  void begin(long baud) { ann_host_hal().serial_baud = baud; }
+  template <class T> void print(const T &v) { if (ann_host_hal().serial_echo) std::cout << v; }
+  template <class T> void println(const T &v) { if (ann_host_hal().serial_echo) std::cout << v << "\n"; }
+  void println() { if (ann_host_hal().serial_echo) std::cout << "\n"; }
+  // 10 bits per byte on the wire (start, 8 data, stop)
+  double byte_us() const { return 1e7 / double(ann_host_hal().serial_baud); }
+  int availableForWrite() const {
+    const AnnHostHal &h = ann_host_hal();
+    if (h.serial_busy_until_us <= h.now_us) return TX_BUFFER - 1;
+    const int queued = int(double(h.serial_busy_until_us - h.now_us) / byte_us() + 0.999);
+    return queued >= TX_BUFFER - 1 ? 0 : TX_BUFFER - 1 - queued;
+  }
+  size_t write(const uint8_t *p, size_t n) {
+    AnnHostHal &h = ann_host_hal();
+    h.serial_tx.insert(h.serial_tx.end(), p, p + n);
+    const uint64_t start = h.serial_busy_until_us > h.now_us ? h.serial_busy_until_us : h.now_us;
+    h.serial_busy_until_us = start + uint64_t(double(n) * byte_us() + 0.5);
+    return n;
+  }
+  size_t write(uint8_t b) { return write(&b, 1); }
+};
+inline AnnHostSerial Serial;
+
+#endif // ANN_HOST_ARDUINO_H
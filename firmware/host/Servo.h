@@ -0,0 +1,26 @@
+// host/Servo.h
+// Host HAL shim for the Servo library: records the commanded angle and when it was written.
+#ifndef ANN_HOST_SERVO_H
+#define ANN_HOST_SERVO_H
+
+#include "Arduino.h"
+
+class Servo {
+public:
+  uint8_t attach(int pin) { pin_ = pin; return 1; }
+  void write(int angle) {
+    AnnHostHal &h = ann_host_hal();
+    angle_ = angle;
+    h.servo_angle = angle;
+    h.servo_write_us = h.now_us;
+    if (h.on_servo) h.on_servo(angle);
+  }
+  int read() const { return angle_; }
+  bool attached() const { return pin_ >= 0; }
+
+private:
+  int pin_ = -1;
+  int angle_ = 90;
+};
+
+#endif // ANN_HOST_SERVO_H
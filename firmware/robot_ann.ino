@@ -16,12 +16,6 @@ const uint8_t FRONT_LED = 2;  //leds
 const uint8_t BACK_LED = 4;   //leds
 const uint8_t SERVO_PIN = 3;  //servo
 
-const int SAFE_DISTANCE = 25;  //cm  
-const int CRITICAL_DISTANCE = 10;  //cm
-const int SERVO_CENTER = 90;  
-const int SERVO_LEFT = 150;
-const int SERVO_RIGHT = 30;
-
 Servo panServo;
 
 void motorsStop() {
@@ -54,167 +48,277 @@ void motorsTurnRight(uint8_t s) {
 }
 
 // --- include generated weights header ---
-// The trainer will write ANNie/models/arduino_weights.h
-// For now you can create a placeholder file there or run the trainer to generate it.
+// The trainer writes ANNie/models/arduino_weights.h (run train_ann to regenerate it)
 #include "../models/arduino_weights.h" // ensure correct relative path in Arduino IDE (or copy header to sketch folder)
 
+// Int8 quantized model (written by train_ann next to arduino_weights.h). When present it is
+// used instead of the float path: integer-only MACs, weights in flash. Define ANN_FORCE_FLOAT to disable.
+#if !defined(ANN_FORCE_FLOAT) && __has_include("../models/arduino_weights_q8.h")
+  #include "../models/arduino_weights_q8.h"
+#endif
 
-// If the header defines the arrays W1,B1,W2,B2 and shapes, the code below will use them.
-// For this example, we'll assume shapes: W1 = [H1 x 3], B1 = [H1], W2 = [4 x H1], B2=[4]
-// If your generated header uses a different naming, adapt the names here.
-
-#ifndef W1 // if the weights header is missing, define tiny example weights
-// Example tiny model: 3 -> 8 -> 4
-const int H1 = 8;
-const float W1_example[8*3] = {
-  0.12f,-0.10f,0.06f,
-  -0.08f,0.15f,-0.05f,
-  0.20f,-0.12f,-0.02f,
-  -0.05f,0.10f,0.12f,
-  0.07f,0.02f,-0.09f,
-  -0.15f,0.18f,0.04f,
-  0.09f,-0.06f,0.11f,
-  0.03f,0.05f,-0.14f
-};
-const float B1_example[8] = {0.01f,-0.02f,0.00f,0.03f,-0.01f,0.02f,0.00f,-0.02f};
-const float W2_example[4*8] = {
-  0.18f,-0.12f,0.05f,0.02f,0.01f,-0.07f,0.10f,0.03f,
-  -0.09f,0.14f,-0.04f,0.12f,-0.05f,0.08f,-0.02f,-0.06f,
-  -0.07f,0.06f,-0.11f,-0.03f,0.15f,-0.02f,-0.08f,0.10f,
-  0.02f,-0.01f,0.03f,-0.06f,0.04f,0.12f,-0.05f,-0.02f
-};
-const float B2_example[4] = {0.01f,-0.01f,0.00f,0.02f};
-#define H1_DEFINED 1
-#endif
-
-// choose which arrays to use (generated header should define W1,B1,W2,B2)
-// If generated header uses different names, edit these aliases
-#ifdef W1
-  const float* W1_ptr = W1;
-  const float* B1_ptr = B1;
-  const float* W2_ptr = W2;
-  const float* B2_ptr = B2;
-  const int HIDDEN1 = H1_DIM; // you must ensure generated header defines H1_DIM
+// Decision lattice (written by training/compile_lattice): the float model's action for every integer-cm
+// input, as a decision tree + exception list in flash. When present it replaces the forward pass:
+// a few dozen comparisons instead of thousands of MACs. Define ANN_FORCE_NET to run the network.
+#if !defined(ANN_FORCE_NET) && __has_include("../models/arduino_lattice.h")
+  #include "../models/arduino_lattice.h"
+#endif
+
+// The generated header defines ANN_MODEL, constexpr layer sizes, PROGMEM weights and ann_forward()
+// (templated forward pass from ann_mlp.h). Older L0_P0-style exports are rejected instead of
+// silently running placeholder weights.
+#ifndef ANN_MODEL
+  #error "models/arduino_weights.h is not a train_ann export (ANN_MODEL missing): re-run train_ann"
+#endif
+static_assert(ANN_IN_DIM == ANN_FEAT_COUNT, "model must take 5 inputs: front,left,right,diff,minLR");
+#ifndef ANN_MODEL_FEATURES
+  #error "models/arduino_weights.h predates the input contract (ANN_MODEL_FEATURES missing): re-run train_ann"
+#endif
+static_assert(ANN_MODEL_FEATURES == ANN_FEAT_CONTRACT,
+              "model was trained with another input contract than firmware/ann_features.h: re-run train_ann");
+static_assert(ANN_OUT_DIM == 4, "model must output 4 actions: FORWARD,LEFT,RIGHT,STOP");
+#ifdef ANN_Q8_MODEL
+static_assert(Q8_IN_DIM == 5 && Q8_OUT_DIM == 4, "int8 model must be 5 -> 4");
+  #ifndef Q8_IN_MULT
+    #error "models/arduino_weights_q8.h predates the integer input path (Q8_IN_MULT missing): re-run train_ann"
+  #endif
+#endif
+#ifdef ANN_LATTICE
+static_assert(ANN_LATTICE_SOURCE_HASH == ANN_MODEL_HASH,
+              "models/arduino_lattice.h was compiled from another model: rebuild and re-run compile_lattice");
+#endif
+
+#include "ann_sched.h"
+#include "ann_echo.h"
+#include "ann_scanmap.h"
+
+// Telemetry verbosity (ann_telemetry.h): 0 = off, 1 = decisions + events, 2 = also every echo
+#ifndef ANN_TELEMETRY
+  #define ANN_TELEMETRY 1
+#endif
+#include "ann_telemetry.h"
+
+// --- sensing and control: ann_control.h ---
+// The servo sweeps continuously and echoes are timed by the pin-change interrupt. Each sweep
+// position gets one ping once the servo has settled; the result goes into an angle -> distance map
+// (median of recent readings, aged out) and decisions read the map. The state machine, its
+// distances and timings live in ann_control.h, shared with the host world simulator
+// (training/world_sim.h); the tasks below only do the I/O and the telemetry around it.
+#include "ann_control.h"
+
+AnnEcho echo;
+AnnControl ctl;
+
+#if defined(__AVR__)
+// ECHO is D11 = PB3 = PCINT3
+ISR(PCINT0_vect) { ann_echo_edge(echo, (PINB & _BV(PB3)) != 0, micros()); }
+void echoAttach() { PCMSK0 |= _BV(PCINT3); PCICR |= _BV(PCIE0); }
 #else
-  const float* W1_ptr = W1_example;
-  const float* B1_ptr = B1_example;
-  const float* W2_ptr = W2_example;
-  const float* B2_ptr = B2_example;
-  const int HIDDEN1 = 8;
-#endif
-
-// Simple MLP inference: input 3 floats (normalized 0..1) -> hidden ReLU -> outputs 4 logits -> argmax
-int mlp_predict(const float in0, const float in1, const float in2) {
-  // hidden = ReLU(W1 * in + B1)
-  float hidden[16]; // support up to 16 hidden neurons (ensure HIDDEN1<=16)
-  for (int i = 0; i < HIDDEN1; ++i) {
-    float s = B1_ptr[i];
-    // W1 is row-major: W1[i*3 + j]
-    s += W1_ptr[i*3 + 0] * in0;
-    s += W1_ptr[i*3 + 1] * in1;
-    s += W1_ptr[i*3 + 2] * in2;
-    hidden[i] = (s > 0.0f) ? s : 0.0f;
-  }
-  float logits[4];
-  for (int k = 0; k < 4; ++k) {
-    float s = B2_ptr[k];
-    // W2 is row-major: W2[k*HIDDEN1 + i]
-    for (int i = 0; i < HIDDEN1; ++i) s += W2_ptr[k*HIDDEN1 + i] * hidden[i];
-    logits[k] = s;
-  }
-  int best = 0;
-  float bestv = logits[0];
-  for (int i = 1; i < 4; ++i) if (logits[i] > bestv) { bestv = logits[i]; best = i; }
-  return best;
-}
+void echoIsr() { ann_echo_edge(echo, digitalRead(ECHO) == HIGH, micros()); }
+void echoAttach() { ann_host_sonar(TRIG, ECHO, echoIsr); }
+#endif
 
-// Ultrasonic helper
-unsigned int readUltrasonicOnce() {
+// Fire the trigger pulse; the interrupt does the rest
+void firePing(uint8_t angle) {
   digitalWrite(TRIG, LOW);
   delayMicroseconds(2);
   digitalWrite(TRIG, HIGH);
   delayMicroseconds(10);
   digitalWrite(TRIG, LOW);
-  unsigned long duration = pulseIn(ECHO, HIGH, 30000UL);
-  if (duration == 0) return 999;
-  unsigned int dist = (unsigned int)((duration * 0.034) / 2.0 + 0.5);
-  return dist;
-}
-unsigned int readUltrasonicAvg(int samples=3) {
-  long sum = 0; int valid = 0;
-  for (int i=0;i<samples;i++){
-    unsigned int d = readUltrasonicOnce();
-    if (d < 999) { sum += d; valid++; }
-    delay(10);
-  }
-  if (valid==0) return 999;
-  return sum/valid;
+  ann_echo_trigger(echo, micros(), angle);
 }
 
-void setup() {
-  pinMode(IN1, OUTPUT); pinMode(IN2, OUTPUT); pinMode(IN3, OUTPUT); pinMode(IN4, OUTPUT);
-  pinMode(ENA, OUTPUT); pinMode(ENB, OUTPUT);
-  pinMode(TRIG, OUTPUT); pinMode(ECHO, INPUT);
-  pinMode(FRONT_LED, OUTPUT); pinMode(BACK_LED, OUTPUT);
-  panServo.attach(SERVO_PIN);
-  panServo.write(SERVO_CENTER);
-  Serial.begin(115200);
-  motorsStop();
-  Serial.println("ANNie firmware ready");
-}
+// --- cooperative control loop ---
+// loop() only runs the scheduler. Every task does a bounded amount of work and returns; the
+// decision logic is a state machine on millis() timers, and each echo in the front sector is
+// checked against ANN_CRITICAL_DISTANCE as soon as it arrives.
 
-void loop() {
-  unsigned int front = readUltrasonicAvg();
-  Serial.print("Front: "); Serial.println(front);
-  if (front <= CRITICAL_DISTANCE) {
-    Serial.println("CRITICAL STOP");
-    motorsStop();
-    delay(200);
-    return;
-  }
-  if (front > SAFE_DISTANCE) {
-    motorsForward(200);
-    delay(80);
-    return;
-  }
+// motors task
+AnnMotorCmd motorApplied = ANN_M_STOP;
+uint8_t motorPwmApplied = 0;
 
-  // Decision cycle: backup, scan, run ANN
-  motorsStop(); delay(80);
-  motorsBackward(180); delay(320); motorsStop(); delay(120);
+// telemetry: the decision record is filled in as the cycle goes (control, inference, control)
+#if ANN_TELEMETRY
+uint8_t tlmSeq = 0;
+AnnTlmDecision tlmRec;
+bool criticalSinceDecision = false;
+uint32_t passMaxUs = 0;
 
-  panServo.write(SERVO_LEFT); delay(300);
-  unsigned int leftDist = readUltrasonicAvg();
-  delay(60);
+uint8_t tlmPending[ANN_TLM_MAX_FRAME], tlmPendingLen = 0;
 
-  panServo.write(SERVO_RIGHT); delay(300);
-  unsigned int rightDist = readUltrasonicAvg();
-  delay(60);
+// Only whole frames that fit the TX buffer right now; a full buffer drops the frame (seq gap).
+// Events and echoes also give way to a decision frame waiting for the buffer to drain.
+void tlmSend(const uint8_t *frame, uint8_t n) {
+  if (tlmPendingLen == 0 && Serial.availableForWrite() >= n) Serial.write(frame, n);
+}
+// Decision frames are never dropped: one is held here until it fits (one per cycle, hundreds of ms apart)
+void taskTelemetry(uint32_t) {
+  if (tlmPendingLen && Serial.availableForWrite() >= tlmPendingLen) {
+    Serial.write(tlmPending, tlmPendingLen);
+    tlmPendingLen = 0;
+  }
+}
+void tlmEvent(uint8_t kind, uint8_t angle, unsigned int cm, uint32_t now) {
+  AnnTlmEvent e = { now, tlmSeq++, kind, angle, (uint16_t)cm };
+  uint8_t frame[ANN_TLM_MAX_FRAME];
+  tlmSend(frame, ann_tlm_encode(e, frame));
+}
+void tlmCritical(uint32_t now) {
+  tlmEvent(ANN_EV_CRITICAL, ctl.crit_angle, ctl.crit_cm, now);
+  criticalSinceDecision = true;
+}
+#endif
 
-  panServo.write(SERVO_CENTER); delay(300);
-  unsigned int frontFresh = readUltrasonicAvg();
+void taskSweep(uint32_t now) {
+  ann_echo_poll(echo, micros());
+  AnnEchoSample s;
+  while (ann_echo_pop(echo, s)) {
+#if ANN_TELEMETRY >= 2
+    AnnTlmEcho rec = { now, tlmSeq++, s.angle, s.width_us };
+    uint8_t frame[ANN_TLM_MAX_FRAME];
+    tlmSend(frame, ann_tlm_encode(rec, frame));
+#endif
+#if ANN_TELEMETRY
+    if (ann_ctl_echo(ctl, s.angle, ann_echo_cm(s.width_us), now)) tlmCritical(now);
+#else
+    ann_ctl_echo(ctl, s.angle, ann_echo_cm(s.width_us), now);
+#endif
+  }
+  if (ann_ctl_sweep(ctl, now, ann_echo_busy(echo))) firePing((uint8_t)ctl.servo_applied);
+}
 
-  // Normalize to 0..1 (same as training generator)
-  float in0 = (frontFresh >= 100 || frontFresh==999) ? 1.0f : (frontFresh / 100.0f);
-  float in1 = (leftDist >= 100 || leftDist==999) ? 1.0f : (leftDist / 100.0f);
-  float in2 = (rightDist >= 100 || rightDist==999) ? 1.0f : (rightDist / 100.0f);
+void taskInference(uint32_t) {
+  unsigned int frontFresh, leftDist, rightDist;
+  if (!ann_ctl_take_request(ctl, frontFresh, leftDist, rightDist)) return;
+  uint8_t action;
+#if ANN_TELEMETRY
+  const uint32_t t0 = micros();
+#endif
+#if defined(ANN_LATTICE)
+  // Integer cm straight into the lattice: no float features at all
+  action = ann_lattice_predict(frontFresh, leftDist, rightDist);
+#elif defined(ANN_Q8_MODEL)
+  // Q14 features requantized to the int8 input scale: no float on the int8 path either
+  int16_t inQ14[ANN_FEAT_COUNT];
+  ann_features_q14(frontFresh, leftDist, rightDist, inQ14);
+  int8_t qin[Q8_IN_DIM];
+  int32_t acc[Q8_OUT_DIM];
+  for (uint8_t i = 0; i < Q8_IN_DIM; ++i) qin[i] = ann_q8_quantize_q14(inQ14[i], Q8_IN_MULT, Q8_IN_SHIFT);
+  ann_q8_forward(qin, acc);
+  action = ann_q8_argmax(acc, Q8_OUT_DIM);
+#else
+  // 5 inputs as in training (ann_features.h): front,left,right,diff,minLR
+  float in[ANN_IN_DIM];
+  ann_features(frontFresh, leftDist, rightDist, in);
+  float logits[ANN_OUT_DIM];
+  ann_forward(in, logits);
+  action = ann_argmax(logits);
+#endif
+#if ANN_TELEMETRY
+  const uint32_t dt = micros() - t0;
+  tlmRec.infer_us = dt > 0xFFFF ? 0xFFFF : (uint16_t)dt;
+  #if defined(ANN_Q8_MODEL) && !defined(ANN_LATTICE)
+  for (uint8_t i = 0; i < ANN_FEAT_COUNT; ++i) tlmRec.in_q14[i] = inQ14[i];
+  #else
+  ann_features_q14(frontFresh, leftDist, rightDist, tlmRec.in_q14);
+  #endif
+  #if defined(ANN_LATTICE)
+  for (uint8_t i = 0; i < 4; ++i) tlmRec.logits[i] = 0.0f;  // no logits: the lattice only stores actions
+  #elif defined(ANN_Q8_MODEL)
+  for (uint8_t i = 0; i < 4; ++i) tlmRec.logits[i] = (float)acc[i];
+  #else
+  for (uint8_t i = 0; i < 4; ++i) tlmRec.logits[i] = logits[i];
+  #endif
+#endif
+  ann_ctl_infer_done(ctl, action);
+}
 
-  int action = mlp_predict(in0, in1, in2);
-  Serial.print("ANN action: "); Serial.println(action);
+void taskServo(uint32_t now) {
+  if (ann_ctl_servo(ctl, now)) panServo.write(ctl.servo_applied);
+}
 
-  // safety override
-  if (action == 0 && frontFresh <= SAFE_DISTANCE) {
-    Serial.println("ANN FORWARD refused (blocked)");
-    action = 3; // STOP fallback
+void taskMotors(uint32_t) {
+  if (ctl.motor == motorApplied && ctl.pwm == motorPwmApplied) return;
+  switch (ctl.motor) {
+    case ANN_M_STOP: motorsStop(); break;
+    case ANN_M_FORWARD: motorsForward(ctl.pwm); break;
+    case ANN_M_BACKWARD: motorsBackward(ctl.pwm); break;
+    case ANN_M_LEFT: motorsTurnLeft(ctl.pwm); break;
+    case ANN_M_RIGHT: motorsTurnRight(ctl.pwm); break;
   }
+  motorApplied = ctl.motor; motorPwmApplied = ctl.pwm;
+}
 
-  // execute action briefly
-  switch (action) {
-    case 0: motorsForward(200); break;
-    case 1: motorsTurnLeft(200); break;
-    case 2: motorsTurnRight(200); break;
-    case 3: motorsStop(); break;
+void taskControl(uint32_t now) {
+#if ANN_TELEMETRY
+  const uint8_t ev = ann_ctl_step(ctl, now);
+  if (ev & ANN_CTL_EV_CRITICAL) tlmCritical(now);
+  if (ev & ANN_CTL_EV_REQUEST) {
+    tlmRec.drive_ms = (uint16_t)(ctl.blocked_ms - ctl.drive_since_ms);
+    tlmRec.wait_ms = (uint16_t)(now - ctl.blocked_ms);
+  }
+  if (ev & ANN_CTL_EV_DECISION) {
+    uint8_t flags = ctl.flags;
+#if defined(ANN_LATTICE)
+    flags |= ANN_TLM_F_LATTICE;
+#elif defined(ANN_Q8_MODEL)
+    flags |= ANN_TLM_F_Q8;
+#endif
+    if (criticalSinceDecision) flags |= ANN_TLM_F_CRITICAL;
+    tlmRec.t_ms = now;
+    tlmRec.seq = tlmSeq++;
+    tlmRec.flags = flags;
+    tlmRec.action_raw = ctl.action_raw;
+    tlmRec.action = ctl.last_action;
+    for (uint8_t i = 0; i < 3; ++i) tlmRec.dist_cm[i] = (uint16_t)ctl.decision_dist[i];
+    tlmRec.pass_max_us = passMaxUs > 0xFFFF ? 0xFFFF : (uint16_t)passMaxUs;
+    tlmPendingLen = ann_tlm_encode(tlmRec, tlmPending);
+    criticalSinceDecision = false;
+    passMaxUs = 0;
   }
-  delay(450);
+#else
+  ann_ctl_step(ctl, now);
+#endif
+}
+
+// Order matters: a critical echo seen by taskSweep reaches taskMotors in the same pass
+AnnTask TASKS[] = {
+  { taskSweep, 0, 0, 0 },
+  { taskControl, 0, 0, 0 },
+  { taskInference, 0, 0, 0 },
+  { taskServo, 0, 0, 0 },
+  { taskMotors, 0, 0, 0 },
+#if ANN_TELEMETRY
+  { taskTelemetry, 0, 0, 0 },
+#endif
+};
+
+uint32_t clockMicros() { return micros(); }
+
+void setup() {
+  pinMode(IN1, OUTPUT); pinMode(IN2, OUTPUT); pinMode(IN3, OUTPUT); pinMode(IN4, OUTPUT);
+  pinMode(ENA, OUTPUT); pinMode(ENB, OUTPUT);
+  pinMode(TRIG, OUTPUT); pinMode(ECHO, INPUT);
+  pinMode(FRONT_LED, OUTPUT); pinMode(BACK_LED, OUTPUT);
+  panServo.attach(SERVO_PIN);
+  panServo.write(ANN_SERVO_CENTER);
+  ann_ctl_init(ctl, millis());
+  ann_echo_init(echo);
+  echoAttach();
   motorsStop();
-  delay(120);
-}
\ No newline at end of file
+#if ANN_TELEMETRY
+  Serial.begin(115200);
+  tlmEvent(ANN_EV_BOOT, ANN_SERVO_CENTER, 0, millis());
+#endif
+}
+
+void loop() {
+#if ANN_TELEMETRY
+  const uint32_t t0 = micros();
+  ann_sched_run(TASKS, millis(), clockMicros);
+  const uint32_t dt = micros() - t0;
+  if (dt > passMaxUs) passMaxUs = dt;
+#else
+  ann_sched_run(TASKS, millis(), clockMicros);
+#endif
+}
@@ -1,35 +1,181 @@
 // Auto-generated weights header from train_ann.cpp
+// Topology: 5 -> 64 -> 32 -> 16 -> 4 (3060 params, 12240 bytes in flash)
 #ifndef ANN_WEIGHTS_H
 #define ANN_WEIGHTS_H
 
-// Layer 0 param 0 length=224
-const float L0_P0[] = { 
-4.04815006f, 7.29447317f, 2.19376397f, 8.02331924f, -0.39214259f, 7.85818911f, -0.15506312f, 6.57508993f, 7.37487507f, 4.72350121f, 5.46428251f, 6.79701328f, -0.24611777f, -0.08793005f, 3.99679518f, 6.42622232f, 5.50711298f, 3.28637981f, 3.99377871f, 7.39313602f, -0.06338909f, 4.26783419f, 7.60122204f, 0.01925713f, -0.23184675f, -0.04435924f, 7.45172930f, 5.17699575f, 5.75803995f, 6.88449860f, 7.79949808f, 5.39972830f, 4.06680155f, 6.93160343f, 2.18016863f, 7.30102825f, -0.28210375f, 8.39159870f, -0.23682870f, 6.43954992f, 7.89649868f, 5.21942091f, 5.70224047f, 7.14477634f, -0.14636213f, -0.31943333f, 4.38600636f, 6.14604092f, 6.11789179f, 3.29162097f, 4.24130201f, 6.92726469f, -0.32551810f, 4.71523571f, 6.98202896f, -0.17803426f, -0.25900635f, -0.34575814f, 6.89001369f, 5.20141029f, 5.84116793f, 6.94685650f, 7.62235308f, 4.93202686f, 4.83260584f, 6.43919897f, 2.05841470f, 7.27727032f, 0.15052077f, 8.21191311f, -0.14472149f, 5.98985720f, 7.67279911f, 4.94420481f, 5.84515429f, 6.77612495f, -0.37788579f, -0.36542612f, 4.43904829f, 6.05792761f, 5.77956486f, 3.03903723f, 4.27410603f, 6.68780899f, -0.17223392f, 4.18522310f, 7.60714149f, -0.21798347f, -0.31125513f, -0.33468071f, 6.88876295f, 4.89011574f, 6.35758209f, 6.62297773f, 7.49621058f, 5.87262058f, 4.18403339f, 7.05650234f, 2.17745996f, 6.54240561f, -0.37703961f, 7.60609102f, 0.14029011f, 6.52716303f, 7.97373772f, 5.31901169f, 4.36344004f, 6.61644697f, -0.00661057f, 0.06620026f, 3.86918640f, 6.01302433f, 5.55623913f, 3.28737068f, 3.59297705f, 6.56521177f, 0.07005700f, 4.46452951f, 7.33175373f, -0.21100889f, -0.31195459f, 0.02623913f, 6.21323109f, 5.04093313f, 6.32706928f, 6.78250456f, 7.62665510f, 4.38701487f, -0.63585454f, -0.04215372f, 0.00890967f, -0.51363367f, 0.12849107f, -0.61144483f, 0.01167995f, -0.28009135f, 0.06298363f, -0.34675005f, 0.07647635f, 0.20818599f, 0.31645450f, 0.03199688f, -0.46190116f, -0.14756747f, -0.28241944f, 0.31441006f, -0.12761922f, -0.30100602f, -0.08026889f, 0.02294766f, -0.38148025f, 0.11947307f, 0.33536527f, -0.10883582f, -0.19081137f, -0.31491914f, 0.20453461f, -0.50728530f, -0.45570979f, -0.50557309f, 4.96358109f, 7.19950771f, 2.40745258f, 7.22655869f, 0.19685540f, 8.20508289f, -0.11853394f, 6.41642761f, 7.87290144f, 4.46123123f, 5.12670755f, 6.85247803f, -0.05640993f, 0.29914913f, 4.42949438f, 5.71331453f, 5.02247953f, 3.04552269f, 4.03439713f, 6.47845697f, -0.30221817f, 4.61822510f, 7.62471151f, -0.34197375f, -0.03929216f, -0.11350393f, 6.72882032f, 5.09904146f, 5.97584677f, 6.74210358f, 7.49890804f, 5.20241022f, 3.98480225f, 5.66645479f, 1.32164204f, 5.20694065f, -0.38998061f, 3.59133244f, 0.09189600f, 3.94227505f, 5.07424974f, 2.62223721f, 3.84091949f, 4.79645109f, 0.30275783f, 0.16398641f, 2.38045073f, 4.11195183f, 2.11102343f, 2.32254481f, 3.25919390f, 4.22776461f, -0.37982109f, 3.03420305f, 5.17608500f, 0.26020107f, 0.14975181f, 0.04026258f, 3.85541439f, 3.45012045f, 4.06636763f, 4.60941839f, 5.15019798f, 3.10355115f
-};
+#include "../firmware/ann_mlp.h"
+#include "../firmware/ann_features.h"
 
-// Layer 0 param 1 length=32
-const float L0_P1[] = { 
-4.13178873f, 6.96520901f, 2.13418078f, 7.35529041f, 0.00000000f, 8.04721451f, 0.00000000f, 6.22141838f, 7.66060781f, 5.05012655f, 5.33506536f, 6.90745068f, 0.00000000f, 0.00000000f, 4.23526812f, 6.13202286f, 5.82323885f, 3.00539494f, 3.93185830f, 6.66911936f, 0.00000000f, 4.45679474f, 7.34405947f, 0.00000000f, 0.00000000f, 0.00000000f, 6.59353113f, 5.06774807f, 6.15662098f, 6.87447166f, 7.68458986f, 4.79743004f
-};
+#define ANN_MODEL 1
+#define ANN_MODEL_FEATURES 0x01050064u // input contract the model was trained with
+constexpr uint8_t ANN_NUM_LAYERS = 4;
+constexpr uint16_t ANN_IN_DIM = 5;
+constexpr uint16_t ANN_OUT_DIM = 4;
 
-// Layer 2 param 0 length=512
-const float L2_P0[] = { 
-3.95214486f, -0.21781997f, 4.48577595f, -0.02523559f, 7.26490736f, 2.83264041f, 5.20773935f, -0.00967991f, 4.47433758f, -0.22083782f, 4.58896494f, -0.31869006f, 5.32111359f, 0.01333731f, 5.78773975f, -0.25269035f, 7.04945707f, -0.07331762f, 6.27269554f, -0.27763468f, 10.86180019f, 8.57578945f, 8.79912853f, -0.29895127f, 8.62285709f, -0.15908463f, 5.87658834f, -0.18967544f, 8.62477875f, 0.33069113f, 8.70332909f, -0.16778681f, 2.78227544f, -0.18835734f, 2.48037553f, -0.28881320f, 6.90201473f, 3.61422706f, 4.36072588f, -0.07426574f, 3.69161010f, -0.10086321f, 1.76372290f, 0.22132084f, 3.98542023f, -0.14866214f, 3.62044501f, 0.14058056f, 5.93415499f, 0.07986635f, 7.14166594f, -0.05168256f, 8.70436096f, 5.82748079f, 7.78365660f, -0.05104423f, 5.80924845f, -0.06517136f, 6.24693775f, -0.09764829f, 6.55932474f, -0.24512674f, 7.95851278f, 0.28282368f, -0.32205048f, 0.29444620f, -0.27754357f, 0.19937477f, -0.19395280f, 0.08225694f, 0.15060595f, -0.32809794f, 0.04222625f, 0.10912338f, -0.34467497f, -0.26179245f, -0.30265987f, -0.14540982f, 0.33041421f, -0.09841883f, 8.59340668f, -0.15934993f, 8.47793293f, -0.30124944f, 10.19210243f, 8.30299854f, 9.12125111f, -0.23927188f, 8.35811901f, 0.29885563f, 8.97131538f, -0.09112212f, 9.17138767f, -0.31818527f, 9.11126518f, 0.16062503f, -0.18395543f, -0.14235461f, -0.00440547f, -0.20905039f, 0.08482146f, 0.34065339f, 0.23262462f, 0.27790794f, -0.24268514f, 0.18338725f, -0.34041807f, 0.10685837f, -0.30404028f, -0.32549295f, -0.00965551f, 0.22194406f, 3.10170150f, 0.18566725f, 4.06297302f, -0.03162009f, 7.14336538f, 2.95669866f, 5.59075880f, -0.29472661f, 3.81171083f, -0.26520213f, 3.05405211f, 0.00621456f, 4.66166973f, -0.20106563f, 6.07249260f, 0.26930359f, 7.68344688f, -0.02676225f, 8.06167030f, -0.26002634f, 10.13182735f, 9.35312271f, 8.77597809f, -0.22165151f, 7.78962708f, -0.30104476f, 6.75210953f, -0.28608179f, 9.57321930f, -0.23885681f, 8.92470837f, -0.10986114f, 2.58106732f, -0.28616062f, 4.53834486f, -0.25225115f, 7.46000528f, 2.74357080f, 4.71070671f, 0.03662383f, 3.33171582f, 0.22507738f, 4.22586536f, 0.08718067f, 4.25246286f, -0.12408487f, 5.91600800f, 0.13618445f, 3.90483761f, 0.01607722f, 4.86874342f, 0.16745099f, 8.84160042f, 3.24196053f, 5.79126263f, 0.11368416f, 4.86972427f, -0.05956663f, 4.00010490f, 0.16161445f, 5.94140291f, 0.18125650f, 7.61395597f, -0.09097686f, 6.44213009f, 0.30066189f, 6.06152391f, -0.20964989f, 7.91080713f, 6.23249912f, 8.50548649f, 0.28870803f, 7.09664869f, -0.14530231f, 5.35054493f, -0.23550081f, 7.01876402f, -0.33651096f, 7.13801050f, -0.05010581f, 0.30135575f, 0.21802840f, 0.29608926f, -0.09307161f, -0.07433417f, 0.07722098f, 0.32757607f, -0.32891235f, -0.23054819f, -0.10282946f, -0.26422495f, -0.29803139f, -0.25803801f, 0.13660252f, 0.00400373f, -0.34456417f, -0.33833307f, -0.02860582f, 0.31676272f, 0.32620052f, 0.23130551f, -0.11724877f, -0.34293339f, -0.01974002f, -0.22896385f, -0.27903056f, -0.11874899f, 0.00217497f, -0.26092464f, 0.27272388f, 0.21884295f, 0.02430844f, 3.89812875f, -0.15451927f, 4.85875082f, -0.10282418f, 7.62412357f, 3.87548685f, 6.06230640f, -0.19538325f, 5.02103853f, -0.34447572f, 4.50380325f, 0.32931855f, 5.31747723f, -0.04952019f, 6.21904898f, -0.13317774f, 6.09949780f, 0.05449504f, 6.12475967f, -0.26408592f, 7.66422272f, 6.54890776f, 8.88681793f, -0.15261646f, 6.26906586f, 0.30706131f, 5.48028994f, -0.19912606f, 6.32388973f, -0.17769583f, 7.28944445f, 0.23067392f, 2.44072509f, -0.18719359f, 4.06685638f, 0.22280934f, 7.69351196f, 2.35981679f, 4.20872974f, -0.23718457f, 3.55743718f, 0.04819586f, 3.21314836f, -0.31951556f, 4.11607885f, -0.34232950f, 5.87499475f, -0.34142426f, 1.81075859f, -0.07112417f, 2.43823624f, 0.05437928f, 6.30398321f, 1.99803734f, 4.13703394f, 0.18343942f, 2.52006793f, -0.18771625f, 1.88605297f, -0.29539040f, 3.35737324f, -0.24200307f, 4.55993366f, -0.22815537f, 3.34373713f, -0.05841920f, 3.37852955f, -0.10769944f, 7.20150805f, 3.79261136f, 6.25546265f, 0.12059820f, 5.26920509f, -0.31382486f, 2.87994099f, -0.32776541f, 5.22808504f, 0.20463654f, 5.70352888f, 0.26467744f, 3.96429753f, -0.35025594f, 5.28060627f, -0.16673347f, 7.95592022f, 3.72499108f, 6.16851807f, -0.11762591f, 4.16387987f, -0.19827858f, 4.08707809f, -0.33717066f, 5.20373535f, 0.02239269f, 6.81915379f, -0.28636906f, 0.08620998f, 0.04345804f, -0.04932263f, -0.23487911f, 0.33502862f, -0.05580857f, 0.12572417f, 0.13059404f, -0.21314330f, -0.15987664f, -0.05183020f, -0.34648255f, -0.11077094f, -0.19808446f, 0.21046242f, -0.33095694f, 4.87463999f, 0.30750105f, 5.15098810f, 0.19946912f, 7.78668499f, 4.63719654f, 6.92866755f, -0.36464697f, 5.60153961f, -0.14226976f, 4.51341009f, 0.02879304f, 5.85758924f, 0.25447610f, 6.64264011f, -0.24199298f, 5.49342394f, -0.29447719f, 6.37556601f, -0.32224819f, 7.87059212f, 4.51807785f, 6.46845818f, -0.35404271f, 5.84268951f, -0.32096031f, 6.52154160f, 0.22045574f, 6.67226648f, 0.09637201f, 7.00265265f, 0.17171568f, -0.08632067f, 0.14543921f, -0.29724929f, -0.18511288f, 0.34140328f, -0.32214516f, -0.22513370f, -0.15470304f, 0.22051737f, 0.25815734f, 0.26513788f, -0.30184743f, 0.13322824f, 0.11337173f, 0.04913995f, -0.22105676f, -0.23972942f, 0.01575896f, -0.02341941f, 0.28558573f, -0.10947989f, -0.01756966f, -0.19442615f, 0.24538174f, 0.06541574f, 0.23955318f, -0.13274530f, -0.25506753f, 0.29437247f, 0.02849960f, 0.28965601f, -0.02327421f, -0.17174330f, -0.19892123f, -0.27514142f, -0.04184073f, -0.21710815f, -0.01394546f, -0.00029406f, -0.11788583f, 0.16163447f, -0.34725121f, -0.20633769f, 0.00386357f, -0.17816719f, 0.12243360f, 0.24866953f, -0.31433773f, 3.84449935f, -0.24212778f, 5.31549883f, 0.07431918f, 8.46563435f, 3.72280788f, 5.70972872f, 0.25784251f, 4.55447626f, 0.19127782f, 4.11152315f, -0.19975823f, 5.63341093f, -0.21198428f, 7.47148514f, 0.10582501f, 2.87943721f, -0.24309143f, 4.20335484f, 0.00732630f, 7.37664318f, 2.78898215f, 4.65644073f, -0.25841314f, 3.39783740f, -0.32370546f, 3.73223257f, 0.28218082f, 4.79130554f, 0.15226099f, 5.69272661f, -0.15988451f, 6.13918734f, -0.07570270f, 6.51834774f, -0.29643068f, 7.67119980f, 6.20140076f, 8.66454697f, -0.35283688f, 7.22381306f, 0.08812705f, 6.22837782f, -0.21194014f, 6.98701811f, 0.08846724f, 7.11065292f, -0.12625265f, 6.34845829f, -0.32009435f, 6.92262936f, 0.15794268f, 7.47995758f, 6.88350296f, 9.05459976f, -0.06625286f, 7.31362534f, 0.14448664f, 6.08545017f, 0.06035805f, 6.98526287f, 0.33203223f, 7.29642057f, -0.15051636f, 7.83822823f, -0.13169487f, 7.87880516f, -0.19342086f, 7.99707556f, 8.21194077f, 9.25694847f, 0.19041698f, 8.40059662f, 0.00895318f, 7.81576967f, 0.08150458f, 8.19402409f, -0.32126608f, 8.40181732f, -0.04771568f, 2.08477044f, 0.33093491f, 3.03584409f, -0.09930590f, 7.59458017f, 2.06786585f, 4.08305073f, -0.08099396f, 3.19430041f, 0.31484941f, 2.68441296f, -0.20996982f, 4.32676125f, 0.34848097f, 5.55089808f, 0.08866337f
+constexpr uint16_t ANN_L0_IN = 5;
+constexpr uint16_t ANN_L0_OUT = 64;
+const float ANN_W0[ANN_L0_OUT * ANN_L0_IN] ANN_PROGMEM = {
+  -0.214688972f, 0.400676072f, -0.178818285f, 2.71312642f, -0.262500167f,
+  -0.277694613f, -0.430354476f, 0.0981293023f, -0.247028410f, 0.0603888035f,
+  0.567026854f, -0.0867701247f, 0.0588114299f, 0.0966396853f, -0.0297966022f,
+  0.774046659f, 0.101084530f, 0.0638154969f, -0.0481469445f, -0.176447809f,
+  -1.22156644f, -0.0306772348f, -0.104982235f, -0.420978397f, -0.0835378766f,
+  0.0370363258f, -0.0429143868f, -0.196163043f, -0.163477883f, 0.0532569513f,
+  0.497940689f, 0.140020594f, 0.220946699f, 0.184697315f, 0.0161461681f,
+  0.733081758f, 0.0574726909f, -0.0604660735f, -0.0212087985f, -0.149574324f,
+  0.407005250f, -0.0785429180f, -0.239465475f, 0.377546877f, 0.356198788f,
+  0.693844914f, -0.152137518f, 0.116971284f, 0.148031265f, -0.0759540796f,
+  -0.0582723059f, 0.518536568f, -0.238906965f, 0.960289478f, -0.0867139846f,
+  -0.569302142f, 0.0303568207f, -0.0146828145f, -0.157250240f, -0.0660335124f,
+  -0.160423204f, -0.0686480030f, 0.120465361f, 0.137792394f, -0.213022113f,
+  -0.604980111f, -0.139981538f, 0.0236210264f, 0.0959631205f, 0.228250220f,
+  0.568716466f, 0.264675707f, 0.0694047809f, 0.00265804189f, -0.231994420f,
+  0.477322251f, -0.231416643f, -0.0782944560f, -0.236540958f, 0.224201083f,
+  0.896642268f, -0.280460984f, 0.0365170985f, 0.166378140f, 0.158183366f,
+  -0.495038122f, 0.421509176f, -0.148410812f, 0.730899274f, -0.102996752f,
+  0.832773805f, 0.0392521843f, -0.141433224f, -0.166876957f, -0.170902774f,
+  -0.659665108f, 0.117203712f, -0.310484260f, 0.356954932f, -0.107177645f,
+  -0.307002693f, -0.201462835f, -0.00861200411f, -0.865132391f, 0.149233654f,
+  -0.412031174f, 0.226195395f, 0.0237615369f, -2.18881273f, -0.150781795f,
+  -0.476934731f, -0.112352699f, 0.00820979569f, 0.0508564226f, -0.0254933964f,
+  -0.200968951f, -0.0706186146f, -0.127437219f, -0.260442555f, -0.326815307f,
+  0.635243654f, 0.153054506f, -0.00910350028f, -0.241639510f, -0.298920095f,
+  -0.0622687079f, 0.182306960f, 0.140246928f, 0.103050858f, -0.231881931f,
+  -0.0967733636f, -0.351957649f, -0.298734874f, 0.439049006f, 0.148690581f,
+  0.562449813f, -0.0780257434f, 0.126551986f, 0.116527185f, 0.0209918618f,
+  -0.0765219182f, -0.269332767f, -0.291222334f, -0.102792159f, 0.281461656f,
+  -0.431202114f, -0.269643039f, 0.352875918f, -0.617472768f, 0.0812642574f,
+  0.00836507697f, 0.0152308634f, -0.143937513f, -0.152797669f, 0.0125881024f,
+  -0.551052988f, -0.119194053f, -0.0216016266f, 0.102697179f, 0.0153529337f,
+  -0.000726235390f, -0.100579903f, -0.0407941043f, -0.0213996582f, -0.245010898f,
+  -0.463436872f, -0.203448206f, -0.168750584f, 0.117232472f, -0.228027135f,
+  -0.623374701f, 0.199944377f, 0.00331122545f, 0.968282402f, -0.0846443847f,
+  -0.326630443f, 0.00350522995f, 0.0153361652f, 0.193567917f, -0.111516044f,
+  0.725372374f, -0.222271070f, 0.246706903f, 0.236936748f, -0.0324528776f,
+  -0.492686898f, -0.283685476f, -0.0335145555f, 0.0367637649f, 0.355625838f,
+  0.0997545570f, -0.0920879468f, -0.0489566401f, -0.142158970f, -0.248972639f,
+  -0.388780385f, 0.219062060f, -0.218060851f, 0.785998106f, -0.0110110296f,
+  -0.0503344312f, -0.195434794f, 0.265843570f, -1.51767695f, -0.149475798f,
+  0.757534921f, -0.0704467297f, -0.0733431876f, -0.00392196933f, 0.148381650f,
+  0.481901318f, -0.341717452f, -0.137920886f, -0.321461648f, -0.141314492f,
+  0.750301063f, -0.187329262f, 0.278532684f, 0.232794732f, 0.180543855f,
+  -0.552435458f, 0.0247976873f, 0.00428612996f, 0.324468374f, 0.275081575f,
+  0.264453709f, -0.119283885f, 0.0132728806f, -0.0211632177f, -0.0623505563f,
+  -0.402406842f, -0.0719537809f, -0.0275960471f, 0.000288099633f, -0.0451986231f,
+  -0.104636244f, 0.161172733f, -0.144889757f, 2.39790177f, -0.00186343410f,
+  0.788731277f, 0.137580037f, 0.128381699f, 0.0420106053f, -0.266296953f,
+  -0.0800081268f, -0.356960267f, 0.416704267f, -1.39791775f, -0.0440344810f,
+  -0.00492805149f, 0.458136797f, -0.237198070f, 2.66274381f, -0.201688096f,
+  -0.0278784335f, -0.0691734552f, -0.0564983934f, -0.0253401101f, 0.0976013243f,
+  -0.460023314f, 0.133849710f, -0.466307253f, 0.311602890f, 0.0941540673f,
+  -0.00120430195f, -0.234395176f, -0.213067576f, -0.229014859f, -0.197097480f,
+  -0.181995645f, -0.276926756f, -1.40323079f, 0.0596236326f, -1.45646131f,
+  0.734105885f, 0.259583086f, -0.126128316f, -0.156657994f, -0.149162829f,
+  -0.132013857f, -0.142011091f, -0.00642715394f, -0.0962602198f, 0.138926551f,
+  -0.0326173864f, 0.327436358f, -0.144352719f, 2.73300624f, -0.168924347f,
+  -0.00823326409f, -0.190400809f, 0.0469888672f, -0.0873205140f, 0.0739936233f,
+  -0.0381389558f, -0.0734821707f, -0.280224621f, -0.0479334891f, -0.0948728323f,
+  0.567328036f, 0.0306107271f, 0.00577898370f, -0.00419939030f, 0.0316724591f,
+  0.0644842237f, -0.149417192f, 0.337659895f, -0.697460830f, 0.167359129f,
+  -0.0376428664f, -0.179480985f, 0.00150954723f, 0.0929189622f, 0.0403210223f,
+  0.689691305f, 0.299407810f, 0.138838172f, 0.0956268013f, -0.177167550f,
+};
+const float ANN_B0[ANN_L0_OUT] ANN_PROGMEM = {
+  0.00876002572f, 0.0812471509f, -0.377484411f, -0.529922843f, 0.167087361f, -0.0276856087f, -0.402038395f, -0.324124634f, -0.0162675958f, -0.372633934f, -0.0523265712f, 0.520960033f, -0.0346838944f, 0.465410441f, -0.409452170f, -0.391924500f, -0.410631925f, 0.230176598f, -0.349545747f, 0.285741091f, 0.253473401f, 0.223978072f, 0.330059439f, 0.387092859f, -0.313792497f, -0.234790593f, 0.153119877f, -0.411623269f, 0.00000000f, 0.259269416f, -0.0260606445f, 0.519006193f, -0.00137732923f, 0.178561836f, 0.0330150574f, -0.0571019053f, -0.494857460f, 0.577165604f, -0.166745380f, 0.141007677f, -0.0564319566f, -0.454846114f, -0.302810103f, -0.547121763f, 0.288068235f, -0.241392761f, 0.350862741f, 0.198113158f, -0.543515623f, 0.151550055f, 0.164852783f, 0.00000000f, 0.210074037f, -0.0189038254f, 0.349909335f, -0.491298079f, -0.0224604551f, 0.173388526f, -0.143350497f, 0.00000000f, -0.410315335f, -0.112683937f, 0.00000000f, -0.518251538f,
 };
 
-// Layer 2 param 1 length=16
-const float L2_P1[] = { 
-0.26995882f, 0.00000000f, 0.47671351f, 0.00000000f, 3.94576287f, 0.25725621f, 0.47243696f, -0.01873243f, 0.35527104f, -0.01435789f, 0.33223030f, 0.00000000f, 0.58749491f, 0.00000000f, 1.31792653f, -0.02381988f
+constexpr uint16_t ANN_L1_IN = 64;
+constexpr uint16_t ANN_L1_OUT = 32;
+const float ANN_W1[ANN_L1_OUT * ANN_L1_IN] ANN_PROGMEM = {
+  -1.74869621f, -0.228837520f, -0.0919587165f, -1.41264641f, 0.244179562f, -0.237681910f, 0.00505026150f, -0.0514147282f, 0.457343370f, -0.136508137f, -0.554003477f, 0.558428466f, 0.00927009806f, 0.279688865f, 0.102539197f, -0.172594622f, 0.362288684f, -0.0289555732f, -0.177775830f, -0.516944051f, 0.0368299820f, 0.320539385f, -0.0119222971f, 0.0974304974f, -0.401605695f, -0.263148040f, 0.244404554f, 0.382327497f, -0.0786967725f, 0.311692864f, -0.226789325f, 0.220682859f, -0.0631577820f, 0.0879381821f, -0.746715307f, 0.182747871f, -0.731485486f, 0.448439896f, 0.000194652297f, 0.00529827597f, -0.178040221f, 0.199222058f, -0.464684844f, 0.0267606750f, 0.108335815f, 0.00320840254f, 0.158123061f, -0.821279287f, -0.825781226f, 0.333523959f, -0.954243004f, -0.101427078f, -0.377572596f, -0.00234088278f, 0.276716620f, -0.630592465f, -0.0972215533f, -0.852642834f, 0.241838738f, -0.249155164f, -0.0498960093f, -0.259377807f, 0.196557403f, -0.0519795455f,
+  0.124577455f, -0.110745184f, 0.249569356f, 1.69307005f, -0.150205985f, -0.0135405278f, -0.159564480f, 0.815875471f, 0.105736680f, 0.427597374f, 0.120400444f, -0.450138211f, 0.166613460f, -0.978178084f, 0.0757562816f, 0.00863654539f, 1.36658669f, -0.237641409f, 0.682055831f, -0.00351413363f, -0.119488388f, 0.00716569647f, -0.339447588f, 0.0544688143f, 0.198335171f, 0.232554287f, -0.127389535f, 0.368656278f, 0.0809841156f, -0.149139911f, -0.176115066f, -0.632048309f, 0.120939642f, 0.254638940f, -0.463500053f, -0.218369469f, 1.93455184f, -0.759183288f, 0.0279199723f, -0.0996796116f, 0.262392938f, 1.46765089f, 0.216201171f, 0.802911282f, -0.708321810f, 0.152488559f, -0.209099889f, 0.00625477312f, 1.14322567f, 0.0652423650f, 0.0238483660f, 0.217503071f, 0.0163456555f, 0.183783785f, -1.24373877f, 1.24908710f, -0.0332638659f, 0.0271988623f, -0.0559788011f, -0.113354295f, 0.427011251f, 0.249941960f, -0.0509146154f, 0.444236517f,
+  0.0440939292f, 0.150309205f, 0.197500527f, 1.97065961f, 0.126390427f, -0.213402256f, 0.402874738f, 0.341567248f, 0.0412520654f, 0.113621466f, 0.175307974f, -0.172963738f, -0.0276010036f, -0.328994364f, 0.159588277f, -0.226066440f, 1.35410750f, -0.372775644f, 0.841324866f, 0.00902608410f, 0.520839632f, 0.170815960f, 0.00897525996f, 0.203887492f, 0.0177943315f, -0.200182378f, 0.0529714711f, 0.0335359052f, -0.246927932f, -0.404834360f, 0.00424045743f, -0.230071560f, 0.164604679f, 0.443059117f, -0.401154369f, -0.0185273401f, 1.89099920f, -0.0765210092f, 0.0579934381f, -0.268665582f, -0.249340564f, 1.61339831f, -0.566551268f, 0.928378761f, 0.0160437059f, 0.124884672f, 0.281943470f, -0.125658929f, 0.749692917f, 0.278003961f, 0.279421657f, 0.108992994f, -0.0126935923f, -0.134922057f, 0.466012090f, 1.02383208f, 0.154339015f, -0.168037221f, -0.236090183f, -0.0267182589f, 0.116303101f, 0.0287340414f, 0.137940615f, 0.335484117f,
+  0.232497633f, -0.0344146155f, 0.00994061586f, 0.149822876f, 0.0570137799f, 0.140031546f, -0.235631436f, 0.0207008719f, -0.0931568295f, -0.140630513f, -0.0509169213f, -0.141154766f, 0.105287194f, -0.193678975f, 0.236103833f, 0.120162569f, -0.0653700829f, -0.0938824490f, -0.107629485f, -0.106534615f, -0.278285503f, 0.105085932f, 0.145074382f, -0.290255040f, 0.0642786548f, -0.239931747f, 0.0281689726f, 0.190456808f, 0.139402419f, 0.189405367f, -0.122380875f, 0.114195958f, 0.0338539481f, -0.00735373888f, 0.0652596653f, 0.0429320931f, -0.0834160745f, 0.0345221199f, -0.118351012f, -0.0430342928f, -0.151582301f, -0.241892904f, 0.142040610f, -0.253720939f, 0.0996860638f, -0.128410891f, 0.127523288f, -0.258860230f, 0.0424557291f, 0.137649626f, 0.0789705068f, 0.145953208f, -0.228990108f, -0.193161711f, 0.144204438f, -0.243624836f, 0.153564751f, 0.0624011643f, 0.0483940579f, 0.236464471f, 0.0905423015f, -0.146024719f, -0.218096972f, -0.231857285f,
+  -0.246150479f, 0.172392428f, 0.0143337026f, 0.546918452f, 0.497518539f, -0.178761750f, 0.0909093171f, 0.512289524f, -0.262417853f, -0.769361913f, -0.892139316f, 0.351836562f, -0.241834357f, 0.194277197f, -0.522616446f, -0.588730633f, 0.874155283f, -0.0526805148f, 0.444307178f, 0.161873177f, 0.0101811131f, 0.334993333f, -0.0442825779f, 0.217281878f, 0.0968609974f, 0.144140840f, -0.589331031f, -0.305713654f, -0.0307244658f, 0.0868476927f, 0.171659023f, 0.117804699f, -0.204880238f, 0.00787549652f, 0.620562017f, 0.00443132687f, 0.950527787f, 0.0342704318f, 0.112300240f, -0.0637106374f, -0.00878037233f, -0.157556504f, -0.507546484f, 0.182079211f, 0.134558350f, 0.146236852f, 0.137080744f, -1.96686232f, 0.468880683f, 0.548920870f, -4.76805305f, 0.248903602f, -0.583932579f, -0.145546809f, 1.18724513f, 0.428029746f, -0.0314579010f, -3.81819701f, -0.140384093f, 0.00266289711f, 0.0117840292f, 0.0892442092f, -0.125419348f, -0.0766041279f,
+  -1.55555534f, 0.00104981579f, 0.167359516f, -1.39664614f, -0.539456666f, -0.0456429124f, -0.195803657f, -0.121830367f, 0.208090067f, 0.230837286f, -0.187781423f, 0.179895267f, -0.215604261f, -0.0195854045f, 0.336323768f, -0.667519808f, -0.171790540f, 0.00597968698f, -0.279689461f, -0.882303417f, -0.163984075f, -0.134792536f, -0.103497334f, -0.196989596f, -0.233921885f, 0.251634181f, 0.0712792128f, 0.263018310f, 0.230830640f, 0.0487813577f, -0.248151615f, -0.126223475f, 0.0991904810f, -0.0576005243f, -0.493412971f, -0.104490802f, -0.758874536f, 0.551640272f, 0.219555199f, 0.0227605514f, -0.593183458f, 0.526624143f, -0.501463890f, 0.197087243f, 0.221158281f, -0.193425536f, -0.125441566f, -0.277435660f, -0.628394008f, 0.0127946902f, -0.139519319f, 0.179024011f, -0.609829485f, 0.198217615f, -0.233814195f, -0.0668482706f, 0.290580839f, -0.597605407f, 0.0164381061f, 0.0325817764f, 0.396209508f, 0.138961971f, 0.0789910555f, 0.0255105961f,
+  0.482980818f, 0.102332726f, -0.0209620818f, 1.19052458f, -0.476528078f, 0.0454580635f, 0.0826741308f, 0.425895721f, 0.141804367f, -0.0669507757f, -0.170333505f, -0.0243510101f, 0.0639471859f, 0.0204446856f, -0.252089798f, 0.00307238102f, 0.703244805f, 0.0424284860f, 0.558921933f, 0.209643304f, 0.105870917f, -0.105175570f, 0.0716860667f, 0.429553866f, 0.0238133520f, -0.136745289f, -0.492799759f, -0.234874055f, 0.148522049f, -0.282598585f, 0.200954974f, 0.101267755f, -0.218439102f, 0.162892744f, -0.167181090f, -0.0695016906f, 1.37888086f, -0.347155720f, -0.155152306f, -0.00808986649f, -0.0211017746f, 0.746410251f, -0.122085787f, 0.611757636f, 0.305257291f, 0.0107094264f, 0.285183400f, 0.417337507f, 0.791983724f, 0.166423157f, 0.200600684f, 0.0259511471f, 0.0841841474f, -0.159652233f, 0.538295567f, 0.669538975f, -0.0599291399f, 0.281283587f, -0.123793699f, -0.209490582f, 0.0348645188f, -0.117677197f, 0.115772247f, 0.432516813f,
+  -0.0595640950f, 0.0108637018f, -0.0617226176f, 0.179051936f, 0.00213932991f, 0.144965470f, 0.145792052f, -0.00260986038f, -0.134210557f, -0.254847080f, 0.0388604626f, -0.162753522f, -0.144839540f, -0.216401473f, -0.195406839f, -0.0672709048f, -0.0376640633f, -0.170877874f, -0.0950740427f, 0.176053464f, 0.0328856669f, 0.0138410497f, 0.107320681f, -0.164005667f, 0.232864857f, 0.126999289f, -0.234765783f, 0.208646327f, 0.0946121812f, 0.129649505f, 0.0740485787f, 0.152998611f, 0.0507981181f, -0.0751273632f, -0.0613081567f, -0.212061167f, 0.214519784f, -0.160436541f, -0.200647280f, -0.246631622f, -0.182209238f, 0.126106173f, -0.226363674f, -0.181840971f, -0.0736753643f, -0.122654155f, 0.123437978f, -0.119368158f, 0.170962438f, 0.110824071f, 0.195648178f, 0.000406146049f, 0.119827971f, 0.134376913f, -0.0329974554f, -0.208040223f, 0.224771976f, 0.0319634601f, -0.0423889197f, -0.00595822930f, -0.00587611692f, -0.0468989387f, -0.124731496f, -0.0117804352f,
+  0.630251050f, 0.0340145901f, 0.146903113f, 1.10563874f, -0.111601278f, -0.186327741f, 0.116601199f, 0.703599453f, 0.404941946f, 0.539681554f, 0.155428514f, 0.102234803f, 0.232041493f, -0.320171297f, 0.0786837488f, 0.101244226f, 1.03443182f, -0.105590664f, 0.799234331f, 0.360568672f, -0.125139579f, -0.0895183235f, -0.116443202f, 0.330278158f, 0.404264987f, -0.152421772f, 0.0671860576f, 0.0228749234f, 0.0878324807f, -0.192668080f, -0.146328196f, 0.153730452f, 0.00239561661f, 0.0654762462f, -0.344496757f, -0.180638671f, 1.79565954f, -0.225235924f, -0.105099097f, 0.351477355f, -0.169436872f, 1.41295493f, 0.268112153f, 0.583805978f, -0.123826742f, -0.0454865173f, 0.367166281f, 0.602806032f, 0.635650814f, -0.111432552f, 0.269913167f, 0.194948018f, 0.212877065f, -0.0748579428f, 0.329271436f, 0.731912017f, 0.188241869f, 0.312226206f, 0.140978500f, 0.161369950f, 0.0940533206f, 0.144262820f, -0.0924310088f, 0.470170468f,
+  -0.180504873f, 0.0295256991f, 0.0281411577f, 2.15349150f, 0.0854310691f, -0.0388107747f, 0.479634196f, 0.736709476f, 0.335368842f, 0.234737888f, 0.0699123517f, -0.382169962f, -0.0546791777f, -0.446456552f, 0.470441163f, -0.0511185788f, 1.34097362f, -0.249361306f, 0.765758812f, 0.0262626745f, -0.169842735f, -0.336939454f, -0.0130445752f, -0.348679721f, 0.526633322f, -0.0169678275f, 0.159993112f, 0.346053779f, 0.229846209f, -0.107347831f, -0.203978583f, -0.739696324f, -0.237365499f, -0.242175609f, -0.356433809f, 0.0256795753f, 2.35946918f, -0.674342275f, 0.269774079f, 0.0602436811f, 0.0568952821f, 1.84427679f, -0.0674048588f, 1.09079850f, -0.360347927f, -0.107304431f, -0.0895688385f, 0.120992735f, 1.35354996f, 0.232360303f, -0.0326344147f, -0.0778976977f, 0.00863554142f, -0.0531089082f, -1.37147665f, 1.16949880f, -0.0654137954f, -0.0680411682f, 0.109542623f, 0.206611574f, 0.313878596f, 0.386150002f, -0.227546394f, 0.702757418f,
+  0.112296999f, -0.0346356742f, -0.472712785f, 1.13391304f, -0.147849664f, -0.0928643718f, 0.164971232f, 0.586838365f, 0.447088152f, 0.239857495f, -0.483121216f, 0.0959755778f, 0.234237701f, -0.0933722779f, -0.259573072f, 0.227481097f, 1.24542212f, -0.0296263415f, 0.542319536f, -0.0420606770f, -0.0508080609f, -0.250338763f, -0.0158084761f, 0.0668254793f, 0.483696312f, 0.0136243058f, -0.0777403042f, 0.0201167725f, 0.0225115418f, -0.347993672f, 0.235963196f, 0.103371799f, 0.216447830f, 0.0826141089f, -0.249843076f, 0.192406446f, 1.16222835f, 0.0914681405f, 0.312808096f, 0.104940422f, -0.281177938f, 1.48210227f, 0.191306636f, 0.498793930f, -0.0616626367f, 0.148164913f, 0.109706759f, 0.311702728f, 0.429108799f, -0.260780454f, -0.0699301213f, -0.165765852f, -0.485173732f, 0.200770676f, -0.234315604f, 0.948581874f, -0.199308708f, -0.0386923030f, 0.280179709f, -0.129902542f, -0.0933952332f, 0.126763240f, -0.00193476677f, 0.213475749f,
+  -1.95897460f, -0.327094495f, 0.168222144f, -1.13775468f, 0.448772311f, 0.224584311f, 0.299991071f, -0.184533298f, 0.388684362f, 0.0884549022f, -0.542124987f, 0.237769678f, -0.146231353f, 0.227809340f, 0.116249353f, -0.486372352f, -0.0919833705f, -0.564984083f, -0.306388289f, -0.306940645f, 0.175111100f, 0.156454414f, 0.452788115f, 0.168808654f, -0.167029411f, -0.0743363351f, 0.113244578f, 0.196192220f, 0.0489754975f, 0.221439853f, -0.158050269f, 0.448969334f, -0.0181151666f, 0.0682850853f, -0.656812191f, -0.236882403f, -1.02698445f, 0.677113533f, 0.260699600f, -0.460439026f, 0.133440718f, -0.206381187f, -0.282402217f, -0.156810060f, 0.0275478270f, 0.191666514f, 0.222637549f, -0.676198006f, -0.882264495f, 0.270104289f, -0.827930748f, 0.114908665f, -0.0250323620f, -0.192191884f, 0.142343000f, -0.417475820f, -0.0305746328f, -1.01733124f, -0.0992563441f, 0.176475406f, 0.351062864f, 0.227327198f, -0.135143682f, -0.0818690360f,
+  -0.221555322f, 0.235651031f, 0.171706885f, 1.93829155f, -0.146590754f, -0.196962640f, 0.181855649f, 0.381399959f, 0.201918796f, 0.414157748f, 0.142618373f, 0.111442596f, 0.191167757f, -0.141156062f, 0.375796705f, -0.195827514f, 1.63518071f, 0.0468536541f, 0.934269607f, -0.899419487f, 0.150379539f, -0.0399271399f, -0.226709768f, -0.312625051f, 0.126590520f, 0.114992172f, 0.160089374f, 0.224102676f, 0.0321134925f, -0.0270346049f, -0.223575294f, -0.329767257f, -0.175109327f, 0.0975079238f, -0.644612134f, -0.223251402f, 1.75773573f, 0.0232956596f, 0.312453389f, -0.0552804768f, 0.0808707401f, 1.53857362f, 0.0525374897f, 1.27834463f, -0.218874857f, 0.356670320f, -0.150127426f, -0.132305354f, 1.05369806f, 0.347386450f, -0.206217930f, 0.191782147f, 0.0488384552f, -0.0144451931f, 0.153618217f, 1.15835941f, -0.144710466f, 0.112538300f, 0.111345306f, -0.245154858f, 0.235632375f, -0.0398707949f, -0.224787071f, 0.234874800f,
+  -0.843757391f, -0.0428547338f, -1.10798991f, -1.03634667f, 0.276488721f, -0.137074754f, -0.441184193f, -0.787856877f, -0.00866193604f, -0.654764950f, -0.564889967f, 0.399550110f, 0.126747519f, 0.315003604f, -0.395416766f, 0.134961635f, -0.936527133f, 0.0399973392f, -0.672386289f, 0.0315151028f, 0.401626140f, 0.490751624f, 0.446534902f, 0.0963203907f, -0.488940150f, 0.103118062f, -0.115257777f, -0.343111008f, 0.234438300f, 0.425159663f, -0.217319742f, 0.244430527f, -0.156225324f, 0.133484229f, -0.160285428f, -0.152046710f, -1.60694551f, 0.336015552f, 0.219224170f, 0.0648805425f, 0.0595898293f, -1.31362712f, -0.0854343474f, -0.815949798f, 0.210375711f, 0.0859692916f, 0.307676435f, -0.664537430f, -1.16301405f, 0.354404867f, -1.13218832f, -0.0641161203f, 0.225361571f, 0.156591952f, -0.521921992f, -1.69454801f, 0.146901771f, -1.15871155f, 0.255058289f, 0.208864540f, -0.305427969f, 0.225237995f, -0.226002306f, -0.414773196f,
+  -0.134437114f, 0.412666470f, -0.0383476242f, -2.25819159f, -0.201692402f, 0.0598356389f, 0.0103329318f, -0.567469954f, -0.0194168650f, -0.343382180f, -0.357561618f, 0.167748377f, -0.158732861f, 0.346557081f, -0.275346816f, -0.128493398f, -1.01338196f, 0.165172562f, -0.418289065f, 0.109063104f, 0.0482877307f, -0.0525577851f, 0.311919242f, 0.494290769f, -0.347760648f, 0.0229146350f, -0.105264112f, -0.194072470f, -0.243007928f, 0.0926079229f, -0.0823747367f, 0.296346605f, 0.0347394049f, 0.119761735f, 0.123647526f, 0.198673993f, -2.32212257f, 0.443650931f, 0.300196230f, 0.203264996f, -0.0329191834f, -1.10902405f, 0.0843831971f, -0.831397355f, 0.346188009f, 0.188926041f, 0.371033072f, 0.197709098f, -1.06306386f, -0.0280389860f, 0.110824652f, 0.101387829f, -0.0646494329f, -0.161250591f, -0.107252009f, -0.963810563f, -0.0415576361f, 0.219942570f, 0.270695299f, -0.137479126f, 0.113714367f, 0.0254220832f, 0.0412600040f, -0.494517982f,
+  -0.136510953f, -0.0289633274f, -0.401800990f, -3.14139462f, -0.828465879f, -0.220662922f, 0.0404093713f, -0.424635649f, 0.288778484f, -0.219085231f, -0.138316318f, 0.457378268f, 0.0135944458f, 0.336958349f, 0.107147135f, -0.648946702f, -1.11014163f, 0.231131807f, -0.687039793f, -0.0326421745f, -0.497538984f, -1.34899271f, 0.0886824504f, 0.208352417f, -0.648960233f, 0.253380477f, 0.0344955623f, 0.173321217f, 0.121713936f, -0.185048386f, -0.0543822311f, 0.642203987f, 0.133938730f, 0.107436255f, -0.0406594537f, -0.0587507002f, -1.87949491f, 0.587554336f, 0.0711095929f, 0.208891392f, -1.40621841f, -1.18564487f, -0.677201033f, -0.201888412f, -0.0735904127f, 0.230084062f, 0.248643816f, 0.390972525f, -0.930998087f, -0.750030637f, 0.119281925f, -0.0765503198f, 0.156430647f, 0.124671027f, 0.247762278f, -0.938097239f, -0.0476818644f, 0.214138657f, -0.0814751238f, -0.0905054212f, 0.0840791315f, -0.144243121f, 0.0126053393f, -0.104452245f,
+  1.11763287f, -0.110667787f, -0.0585399121f, -0.739090919f, -0.338477701f, -0.237579033f, 0.193851247f, -0.496249199f, 0.430730909f, 0.0894322172f, 0.0243993960f, 0.286500245f, 0.0484479181f, 0.328303277f, -0.437834293f, -0.280354649f, -0.0395586677f, 0.439816982f, -0.0968782380f, -0.0125353979f, -0.0640663430f, -1.18341231f, 0.353638470f, 0.165957168f, -0.823042333f, -0.0540972799f, 0.159470603f, 0.0255222674f, 0.0544885695f, -0.220209345f, 0.135402337f, 0.0149725229f, -0.220123172f, 0.194975436f, 0.342765570f, 0.174711674f, -0.351301461f, 0.122356728f, -0.0371526591f, 0.181956217f, -1.08648765f, -0.293406218f, -0.215917394f, 0.119692557f, 0.380382955f, 0.0834493414f, 0.346333295f, 1.03403091f, -0.721496999f, -0.590234399f, 1.21484256f, -0.0389456749f, 0.0994162485f, 0.126081139f, -0.389193177f, -0.585488617f, 0.00551214721f, 1.26363385f, 0.0104308305f, -0.207904935f, -0.126116991f, -0.384919971f, -0.108702987f, -0.0403445698f,
+  -0.197037980f, 0.346811980f, -0.296813995f, -1.99308527f, -0.112521574f, 0.221179321f, -0.194321066f, -0.408012956f, -0.153549790f, -0.146419749f, -0.191899568f, 0.480067492f, -0.00387655036f, 0.418130428f, 0.126337826f, 0.0781732053f, -1.13309789f, 0.112159297f, -0.694101036f, 0.0368657149f, 0.0855742395f, -0.0717806518f, -0.00879858807f, 0.0430862047f, -0.443968177f, 0.137440726f, -0.111846671f, -0.0395262279f, -0.223014310f, -0.0265662409f, 0.0961497799f, 0.716253996f, 0.110930294f, -0.198150441f, 0.143766239f, 0.232314736f, -2.18222690f, 0.435333967f, 0.188710436f, 0.0639414638f, -0.0393237174f, -1.05553973f, -0.156002685f, -0.701948106f, 0.171927437f, -0.0932326689f, -0.117483340f, 0.245879456f, -1.03403533f, 0.282773972f, 0.0211760346f, 0.000803112984f, 0.164381921f, -0.178639367f, 0.0951645672f, -1.15715408f, 0.00388446916f, 0.0687514618f, 0.130366355f, 0.205519348f, 0.0966940597f, -0.0676270276f, -0.176560462f, -0.199051559f,
+  0.160420418f, -0.234062999f, 0.163359717f, -0.0487639718f, 0.216472000f, 0.179456368f, 0.0859988406f, -0.182440266f, 0.110312991f, -0.210239977f, -0.267027229f, -0.00218196004f, -0.0435160995f, 0.120656073f, -0.0652793720f, 0.0970733315f, 0.0795747712f, -0.0841725320f, 0.199723244f, 0.220898122f, 0.0975585282f, 0.158822700f, 0.145367071f, -0.215689898f, 0.232612073f, -0.249010652f, -0.172273144f, 0.0669802874f, 0.244283199f, -0.0240919702f, -0.198014721f, -0.107501149f, -0.165361047f, -0.228414401f, 0.223675206f, 9.79284523e-05f, 0.131752953f, -0.191639900f, -0.107074581f, -0.0217933822f, -0.137537017f, 0.187556133f, 0.0178550221f, 0.106002003f, -0.111630104f, 0.0283038151f, -0.0614512786f, 0.0458955616f, -0.124126583f, -0.0752251670f, -0.0835681260f, 0.181657463f, 0.168229595f, -0.224229142f, 0.0440480411f, -0.0777805820f, 0.222185075f, -0.00549180899f, -0.185483173f, 0.162982285f, 0.0783627778f, 0.00148706825f, -0.103332013f, -0.172053874f,
+  -2.13072968f, -0.0479737297f, 0.448034227f, -1.38171291f, 0.269659013f, -0.126264617f, 0.0206447039f, -0.0148759615f, 0.439029306f, 0.133512139f, -0.694912255f, 0.341194630f, -0.100201361f, 0.296528429f, 0.388328373f, -0.314203560f, -0.573446512f, -0.417541265f, -0.165694922f, -0.610706747f, 0.184933946f, 0.113839455f, 0.262521148f, 0.189028993f, -0.429991364f, -0.205313310f, 0.184695616f, 0.197411910f, 0.0269180536f, 0.0287609734f, 0.112263516f, 0.326929808f, 0.122567862f, 0.172282755f, -0.648910403f, 0.0676441342f, -1.44077206f, 0.253619999f, 0.0974677727f, -0.276873380f, -0.171243712f, -0.407239437f, -0.0861056373f, -0.378821075f, 0.147444308f, 0.0238019861f, 0.170730278f, -0.527955651f, -1.01789105f, 0.0541680790f, -0.411149979f, 0.168418258f, 0.0229048356f, 0.0801341608f, -0.567767143f, -0.766092360f, -0.169770226f, -0.937413931f, 0.0885812864f, 0.188144594f, 0.229456335f, 0.106726460f, 0.164226532f, -0.0237497687f,
+  0.0467056632f, -0.0766191706f, 0.0552330054f, -0.0101105357f, -0.0617979169f, -0.0968313962f, 0.0517759994f, 0.0319033861f, 0.0156865772f, -0.169181645f, -0.227257982f, -0.184115827f, -0.0684694052f, 0.00521796709f, 0.210033596f, -0.100929402f, -0.247128144f, -0.182778269f, 0.0161329117f, -0.0862500519f, -0.239573479f, -0.219718337f, -0.163967207f, 0.114783794f, 0.129841909f, -0.0355204791f, -0.239001244f, -0.172632501f, -0.137946486f, 0.106075317f, -0.0288338810f, 0.0250122771f, -0.215485811f, -0.154675558f, -0.126975387f, 0.207125962f, 0.160402194f, 0.199658573f, 0.0796259344f, -0.132557869f, 0.0427131467f, -0.213527605f, 0.00789698958f, 0.0783785656f, 0.139243960f, -0.246581316f, -0.258529246f, 0.0323213376f, -0.241534173f, -0.0795981660f, -0.0469975099f, -0.132478386f, 0.00766807795f, -0.208665743f, -0.184778184f, -0.00539768394f, -0.0883706212f, -0.0545347482f, 0.0906481445f, 0.107383609f, -0.244550228f, -0.0751406997f, -0.186972946f, 0.121420205f,
+  -0.0692948699f, -0.0837752074f, -0.0642243177f, -0.231005147f, -0.195577398f, -0.0665055513f, -0.213844970f, 0.0114416974f, -0.122588724f, -0.0326397754f, -0.0890769586f, -0.0306669213f, 0.0814340562f, -0.261277944f, 0.0574866496f, -0.178350076f, -0.0518072844f, -0.0511760786f, -0.118165150f, -0.219372377f, 0.0507126153f, -0.119367167f, -0.243392751f, 0.0419107303f, -0.0567758530f, -0.225844234f, 0.0781673342f, -0.0154446131f, 0.0234590471f, 0.152759880f, 0.00871300045f, 0.0171317477f, 0.0786924064f, 0.142526165f, 0.0545248985f, -0.103898205f, -0.263676584f, -0.206233069f, 0.0609473027f, 0.0621666275f, -0.0495592877f, -0.0646547005f, -0.0414499491f, 0.208241940f, -0.0746727660f, -0.137412921f, 0.0327255204f, 0.0511342920f, 0.0740189925f, 0.0592473149f, 0.0669564009f, 0.147319019f, 0.108055197f, 0.0403028131f, 0.0503494628f, 0.138515323f, 0.0427444279f, -0.00457585976f, -0.0777648017f, -0.184649661f, -0.272369236f, 0.0757730901f, -0.230242819f, 0.0808874890f,
+  -0.0981630459f, 0.135924131f, -0.0241857599f, -2.12298870f, -0.625220776f, 0.109728694f, -0.0909039304f, -0.628027558f, -0.139505610f, -0.265805572f, -0.105005614f, 0.391685516f, -0.210664049f, 0.309405088f, 0.0552760214f, 0.00290595368f, -0.712171376f, -0.0829002038f, -0.463245630f, -0.127177924f, 0.0383087695f, -0.268522263f, -0.100559421f, 0.358518392f, -0.371979922f, 0.197937444f, 0.0388494618f, 0.137165204f, 0.0436088443f, 0.0695481300f, -0.0795530006f, 0.427864790f, 0.202914402f, -0.190618828f, -0.144180998f, 0.00222630100f, -1.99153173f, 0.825360000f, 0.0947898328f, 0.314698815f, 0.0497108772f, -1.12330842f, -0.195709467f, -0.584258616f, 0.0475633889f, 0.308150947f, 0.237032101f, 0.312273055f, -1.14962530f, 0.140243843f, -0.293767005f, 0.0318753421f, 0.0824057013f, -0.244737610f, 0.00612127502f, -0.883392334f, -0.201881021f, 0.261985123f, 0.00745566515f, -0.127721936f, 0.0189627446f, -0.0776440129f, 0.196590453f, -0.0308447536f,
+  0.233982876f, 0.0716243163f, -0.174628735f, 1.58115125f, -0.0247751921f, 0.234020367f, 0.454318196f, 0.0310665425f, 0.153472751f, 0.170282334f, 0.125759497f, -0.0838959441f, 0.0717806593f, 0.0716749206f, -0.0817589685f, 0.303949714f, 1.19762528f, 0.157978743f, 0.542054951f, 0.0957950354f, -0.0594865456f, -0.354064107f, 0.167148173f, -0.118070044f, 0.251140952f, 0.0293727703f, -0.223505601f, 0.0968567207f, 0.239377350f, 0.0792492181f, 0.156647876f, -0.278747529f, 0.200858906f, 0.201310858f, 0.172887668f, -0.210398033f, 1.64971018f, -0.252012134f, 0.271029741f, -0.00746336859f, 0.00669285376f, 1.10895514f, 0.182491630f, 0.856281400f, 0.364035815f, 0.0946687534f, -0.0138916261f, -0.0492308959f, 0.991384327f, -0.173239589f, -0.196461543f, -0.147977233f, -0.0650420487f, 0.168250397f, -0.450165838f, 1.02222204f, 0.219682530f, 0.307994545f, 0.149663076f, -0.158329219f, 0.183237225f, 0.154713511f, 0.136539191f, 0.462449074f,
+  -0.116713904f, -0.0457398780f, 0.109346315f, -0.0865558386f, -0.0882035345f, 0.0316375494f, 0.123324864f, 0.0107178036f, -0.142535284f, -0.0186374411f, -0.0646020025f, -0.207314134f, 0.171420634f, -0.0672408044f, -0.0731080100f, 0.188959002f, -0.101855390f, 0.0899659544f, -0.110914268f, -0.203951776f, -0.120267637f, 0.140605628f, 0.150126263f, -0.281093061f, 0.193177998f, 0.0975595042f, -0.0112933926f, -0.303848326f, 0.167528987f, -0.187445268f, 0.166299224f, -0.0639950186f, -0.0262949765f, 0.0472165681f, -0.142622352f, -0.163499758f, 0.0320103765f, 0.0170780662f, 0.224997059f, -0.209586486f, 0.199482158f, -0.239896148f, -0.0692014620f, -0.227348134f, -0.0743632838f, 0.0262568388f, -0.00871324912f, 0.195190907f, -0.151840150f, -0.00510496087f, -0.197690994f, -0.236719877f, 0.158447340f, -0.0173607022f, 0.192073911f, -0.139860168f, 0.222299814f, 0.0751523152f, -0.274745166f, -0.218081579f, 0.140385419f, -0.227207080f, -0.0243634582f, -0.293867469f,
+  -1.49111104f, 0.0918535143f, 0.142185330f, -1.31786180f, 0.348906428f, 0.0183935072f, 0.106348284f, -0.333676040f, 0.295144320f, -0.330003679f, -0.768926620f, 0.249596283f, -0.0675653517f, 0.493493944f, 0.118108995f, -0.319422752f, 0.0518122949f, -0.367802531f, -0.351199090f, -0.150126368f, 0.500084698f, -0.0551726855f, 0.0107704718f, -0.0873048827f, -0.0896947831f, -0.207159564f, 0.258558780f, 0.235624745f, 0.116266966f, -0.0340736359f, 0.196776211f, 0.162073329f, 0.135948554f, 0.364689976f, -0.612293899f, 0.0627068132f, -0.543432415f, 0.474421144f, -0.0218955390f, -0.158944562f, -0.436592251f, 0.409246296f, -0.543328643f, -0.0617648512f, 0.115175202f, 0.182352915f, 0.269669503f, -0.504702091f, -0.760215878f, 0.323178232f, -0.796408415f, 0.0179366469f, -0.370148838f, -0.0127307400f, -0.119719461f, -0.635902762f, 0.0623826571f, -1.03645658f, 0.223472089f, 0.0171015561f, -0.122428983f, -0.179581583f, 0.0405001938f, 0.100716829f,
+  0.0944430903f, -0.0910958648f, 0.0661753491f, -0.272422791f, 0.152979761f, -0.245533735f, 0.0332408175f, -0.0357804336f, 0.171834886f, 0.0886582136f, 0.182904586f, -0.191229194f, 0.0864140987f, -0.129777744f, 0.144031540f, 0.110844046f, 0.183754653f, -0.286553949f, -0.110895008f, -0.195046946f, 0.0457417108f, -0.230646089f, 0.204284221f, -0.196695447f, 0.138809785f, -0.192366093f, -0.293323696f, 0.0212172661f, 0.146248788f, -0.243641198f, 0.0961012617f, -0.197344258f, -0.196807399f, -0.115766615f, -0.238162965f, 0.0717855394f, -0.135144100f, -0.0695190206f, 0.0303918123f, -0.119607881f, -0.168437123f, -0.131076440f, -0.0982238278f, 0.0980910584f, -0.0233012754f, 0.113905512f, -0.273405999f, 0.0539770834f, -0.272588223f, -0.157559514f, 0.0298456158f, -0.0599742681f, 0.0758487657f, 0.0484117791f, -0.226366356f, 0.0472483486f, 0.178517401f, -0.116244495f, -0.0229038708f, -0.0366228968f, -0.0688358471f, -0.0740863532f, 0.0754356980f, -0.0214774031f,
+  0.116867714f, -0.142566890f, -0.0401745066f, 1.57675135f, -0.0966423005f, 0.183753446f, 0.531379819f, 0.134496078f, 0.0442531444f, 0.126825258f, -0.0689182356f, 0.0243278388f, -0.210329980f, -0.176921010f, 0.201941997f, 0.284067303f, 1.25766408f, 0.199801356f, 0.406895638f, -0.00313475495f, 0.0379433148f, 0.0535730459f, 0.533099830f, 0.125371709f, 0.134266287f, 0.226975575f, -0.241886914f, 0.0767268017f, -0.220600113f, -0.113715507f, 0.226838261f, -0.0856020749f, 0.206446245f, 0.438284069f, -0.318647444f, 0.287310034f, 1.67793560f, -0.378608078f, 0.188226297f, -0.143956915f, -0.153022543f, 1.40111506f, -0.124929518f, 0.860976398f, 0.204898626f, -0.00868439488f, 0.0503615066f, 0.130767733f, 1.17849720f, -0.186699539f, 0.154819638f, 0.0986592472f, 0.245059207f, -0.0840215757f, 0.378076732f, 0.928025007f, 0.0168919023f, -0.105025731f, 0.224969968f, -0.00342468917f, 0.170111343f, 0.198781267f, -0.0911484957f, 0.524558902f,
+  -0.0419073477f, 0.0804433301f, -0.0372936241f, 2.12018728f, 0.210796431f, 0.0533857755f, 0.0159534607f, 0.880917311f, 0.0886234343f, 0.593377709f, -0.0525226444f, -0.272006869f, -0.215162739f, -0.697902143f, 0.0656952932f, -0.0309316684f, 1.29140842f, -0.118224345f, 0.714548588f, -0.133773863f, -0.0702380091f, 0.0454043634f, -0.290901005f, -0.228291348f, 0.343280107f, 0.160216510f, 0.186534882f, 0.0335398167f, -0.0853860080f, -0.284702897f, -0.0523306206f, -0.380383551f, 0.0826919898f, -0.0326156914f, -0.176469266f, -0.0719133317f, 2.35230207f, -0.666202247f, -0.137880072f, 0.0165143982f, 0.168307006f, 1.39294934f, -0.0859071314f, 0.804128528f, -0.274193913f, 0.279906660f, -0.0766320005f, -0.0463246219f, 1.22529364f, 0.171671242f, 0.0755318552f, -0.0690824538f, 0.0498274714f, -0.142705813f, -1.32368863f, 1.06615138f, -0.205171391f, 0.0173146650f, -0.0200492386f, 0.103020757f, -0.0322456099f, -0.0890200585f, 0.154652596f, 0.499441803f,
+  -1.74678218f, -0.0278854072f, -0.305797130f, -0.935952485f, -0.618518651f, 0.180404618f, -0.193437666f, -0.264070094f, 0.350070953f, 0.0532907322f, -0.186270803f, 0.102183349f, -0.0980712920f, 0.108795561f, -0.554179490f, -0.936612964f, -0.208275601f, -0.333022952f, -0.140668318f, -1.09758246f, 0.174038708f, -0.456912726f, 0.297130466f, -0.596909583f, 0.140436456f, -0.107628278f, -0.00166942540f, 0.0911176875f, 0.0234445930f, 0.0828733817f, -0.102507167f, 0.224927351f, -0.248067647f, -0.123108290f, -0.466048032f, -0.240158588f, -0.624675751f, 0.467578679f, 0.128591225f, 0.0897614062f, -0.616043925f, 0.629387498f, -0.743311286f, -0.137432903f, 0.263833374f, -0.134080768f, -0.160399854f, -0.337729067f, -0.662819088f, 0.162605956f, -0.566027164f, 0.0701500475f, -0.177225128f, 0.0694435835f, 1.02620482f, -0.269034326f, 0.131921619f, -0.477025002f, -0.119769856f, 0.0752905309f, -0.121028267f, -0.150719002f, 0.114561647f, -0.0223119035f,
+  -0.0622307099f, -0.161386386f, 0.159652010f, -1.70305204f, -0.392819911f, 0.0790633932f, -0.0563739464f, -0.0724904090f, 0.403915495f, 0.122034557f, -0.215287209f, 0.411689788f, 0.193509519f, 0.422709912f, 0.0253775325f, -0.0278093386f, -1.03074348f, -0.0549948215f, -0.164189056f, 0.126805976f, -0.00419298047f, -0.0702343807f, -0.0462048724f, 0.0405039787f, -0.445272863f, -0.121926270f, 0.603103876f, 0.0454457179f, -0.0713987201f, -0.0328559764f, -0.237681836f, 0.601082981f, 0.00113669038f, 0.0525440760f, 0.208480015f, 0.0589320734f, -2.29558539f, 0.703381240f, 0.243968874f, 0.0933279917f, -0.312910497f, -1.02314687f, -0.187592760f, -0.459068835f, 0.0629759952f, -0.0607756563f, 0.0501688421f, -0.0203928798f, -1.01956546f, 0.217226774f, 0.111983590f, -0.204378247f, 0.00524257170f, 0.00900653377f, -0.599885881f, -0.616807282f, -0.174881369f, -0.154953226f, -0.124795690f, 0.109076798f, -0.196907222f, -0.0777123347f, -0.108518571f, -0.202477291f,
+  0.266861349f, -0.376284599f, -0.194971949f, -2.90834689f, -0.841799796f, 0.0889172629f, -0.0493351445f, -0.420250088f, -0.0107696876f, -0.0683917105f, -0.124351755f, 0.399060756f, -0.131409615f, 0.131660804f, 0.00745776715f, -0.223730341f, -1.05626583f, 0.265757889f, -0.909705818f, 0.172315881f, -0.512689829f, -1.51991010f, 0.455269307f, 0.165221810f, -1.02314782f, -0.0225628298f, 0.0740161464f, -0.0412173346f, -0.245815486f, -0.204620212f, 0.170339227f, 0.412188441f, 0.00713679194f, 0.283719480f, 0.258105576f, -0.128911287f, -1.95442915f, 0.215544999f, 0.0288673658f, 0.283615142f, -1.31254673f, -1.61888945f, -0.245787233f, -0.918148339f, 0.301542640f, -0.260223657f, 0.0413451754f, 0.293273389f, -0.958378971f, -0.840088904f, 0.234329566f, 0.0553978980f, -0.0743185505f, -0.159054548f, 0.553554893f, -0.950048745f, -0.197079077f, 0.216684267f, 0.0178606007f, 0.0811786056f, -0.406655371f, -1.07319176f, 0.0743147135f, -0.348296642f,
+};
+const float ANN_B1[ANN_L1_OUT] ANN_PROGMEM = {
+  0.492017180f, -0.428762406f, -0.114055999f, -0.0730604753f, -0.0682936683f, 0.503950179f, -0.177171499f, -0.0136048542f, -0.167990550f, -0.454162508f, -0.152773798f, 0.514435947f, -0.0808962807f, 0.419365227f, 0.691171348f, 0.421344668f, 0.149476662f, 0.568255186f, -0.0630978569f, 0.577692568f, -0.0799884424f, -0.0405607708f, 0.522757351f, -0.251445651f, -0.0895397589f, 0.563926816f, -0.0827098787f, -0.225092307f, -0.393967092f, 0.394508868f, 0.728201151f, 0.239035472f,
 };
 
-// Layer 4 param 0 length=64
-const float L4_P0[] = { 
--6.68406773f, 6.70946836f, -6.48348665f, 6.45617914f, -0.15806711f, 0.42427468f, -0.51900160f, 0.03717315f, -6.80192423f, 5.80311203f, -4.62480354f, 5.85010624f, -0.51442140f, -0.20359230f, -0.14619476f, 0.24772221f, -7.81664371f, 8.46902180f, -7.82569933f, 8.09727287f, -6.04680777f, 6.13989687f, -5.21760559f, 6.23577881f, -7.37367630f, 6.89842367f, -5.53648567f, 6.11453247f, 0.53649616f, -0.00712171f, -0.32435453f, -0.23316704f, -7.24173641f, 6.57750654f, -6.26366568f, 6.66903162f, 0.27405012f, 0.46132874f, -0.05453125f, -0.31651774f, -6.48996782f, 5.83653688f, -4.75836182f, 5.18265152f, -0.31553188f, 0.24645340f, 0.32710451f, -0.21594369f, -7.63637161f, 6.80607176f, -7.63970852f, 6.71209097f, 0.10235012f, -0.45064834f, 0.37665832f, -0.36621872f, -7.34098577f, 6.77234936f, -7.00379086f, 7.61573124f, -0.02055479f, 0.44212365f, 0.01768293f, -0.29984671f
+constexpr uint16_t ANN_L2_IN = 32;
+constexpr uint16_t ANN_L2_OUT = 16;
+const float ANN_W2[ANN_L2_OUT * ANN_L2_IN] ANN_PROGMEM = {
+  0.0340420678f, 0.702599168f, 0.0415724590f, -0.0160152633f, 0.344424516f, 0.243090436f, 0.492495328f, -0.0496603921f, 0.475931972f, 1.37446654f, 0.440860748f, -0.0556801409f, 0.0365796126f, -0.373964489f, -0.417484194f, -0.00917848106f, 0.467005730f, -0.238685578f, 0.112449408f, -0.301121265f, 0.0401905142f, -0.258631438f, 0.297034562f, 0.538889289f, 0.221581265f, 0.0806373432f, -0.239031345f, 0.391482294f, 0.448485255f, -0.157195807f, -0.262205333f, 0.341316611f,
+  0.556643844f, -0.232799381f, 0.175327986f, -0.0825440884f, 0.147582516f, 0.737961292f, -0.506682158f, -0.305586219f, -0.0375487916f, -1.11045468f, 0.0787260681f, 0.804818749f, 0.581903338f, 0.477414489f, 0.233580753f, 0.0517088659f, -1.05475450f, 0.550093472f, -0.314052045f, 0.841033518f, 0.112321131f, 0.234633535f, 0.146693483f, -0.0346118957f, 0.155908287f, 0.910607278f, 0.168880194f, -0.0497633517f, -0.393118113f, 0.906678438f, 0.703000963f, -0.787882388f,
+  -0.785926342f, -0.433941364f, -0.175882503f, 0.100943342f, -2.27712464f, 0.437116385f, 0.191354960f, -0.207510665f, 0.362435818f, -1.55791306f, 0.525602520f, -0.555061221f, 0.424766302f, -0.753250957f, 0.838485897f, 0.770576119f, 0.118335918f, 0.496362269f, -0.147373497f, -0.446159333f, -0.208631814f, 0.282651007f, 0.799915850f, 0.132457703f, 0.0340958945f, -0.625061333f, -0.351515293f, 0.0620770715f, -0.646702290f, 0.247933000f, 0.664377332f, 0.793484211f,
+  0.345833749f, 0.635956168f, 0.140276626f, 0.171496078f, 0.484574735f, 0.298364401f, 0.513929784f, 0.297059655f, 0.326950043f, 1.52410042f, -0.256067634f, 0.0397759639f, 0.634735584f, -0.366950452f, -0.647019684f, -0.0277329404f, -0.0469907708f, -0.560159206f, 0.175149024f, 0.140765414f, 0.00879102852f, 0.0764728710f, -0.325132161f, 0.113521524f, -0.259735882f, 0.316806674f, -0.0598646365f, -0.143720657f, 0.796238065f, 0.475351214f, -0.712502956f, -0.566043675f,
+  0.243306935f, -0.254969120f, -0.0405431353f, 0.0967114717f, -0.118188180f, 0.179267645f, 0.108413152f, -0.153902650f, -0.121721081f, -1.70712531f, -0.205489337f, 0.274416864f, -0.518521428f, 0.114316925f, 0.592909455f, 0.0273938030f, -0.519945264f, 0.344638944f, -0.269445866f, 0.157819897f, 0.205554426f, -0.259594202f, 0.404016882f, -0.0633234233f, -0.197203115f, 0.132288590f, 0.0136601049f, -0.157747656f, -0.436841786f, 0.110132821f, 0.343254685f, 0.100317828f,
+  0.467857540f, -0.183029205f, 0.200856179f, -0.00804992020f, -0.881504297f, 0.343524665f, 0.0235909130f, 0.250581056f, 0.166742414f, -1.50837517f, 0.0874194205f, 0.0625803024f, 0.212087929f, -0.0415975973f, 0.530888617f, 0.110685892f, -0.0827930048f, 0.599190056f, -0.341585457f, 0.589955926f, -0.0659647807f, 0.199508235f, -0.0831839442f, -0.517489851f, 0.0625469089f, -0.0985226259f, 0.288218319f, -0.449405521f, -0.426663339f, 0.147045434f, 0.798846483f, -0.581652701f,
+  -0.111787409f, 0.272163153f, 0.388757020f, 0.187687352f, -0.174077407f, 0.619202614f, 0.160063922f, 0.0947753191f, 0.330040365f, 1.03247249f, 0.390360236f, -0.146488070f, 0.781862140f, -0.498017192f, -0.578729212f, -0.542025626f, 0.161946923f, -0.264201254f, -0.344786346f, -0.0588147528f, -0.289339930f, 0.301025033f, 0.139450163f, 0.367715567f, -0.151625901f, 0.483784586f, -0.334917784f, 0.176468953f, 0.477704465f, 0.255039722f, 0.0551037118f, -0.330133110f,
+  -0.0461785607f, 0.450538576f, 0.138243347f, -0.177714959f, 0.0549650937f, -0.222295299f, 0.183117077f, -0.262267768f, 0.494640827f, 0.643502593f, 0.345058531f, -0.247944549f, 0.125607371f, -0.633175135f, 0.180051312f, 0.667559862f, 0.921608806f, -0.158100307f, -0.241541028f, -0.152561590f, 0.156786963f, -0.308298349f, -0.292706937f, -0.344455391f, -0.0318371914f, -0.135964662f, -0.212672547f, 0.261692762f, 0.480599552f, 0.322847456f, 0.260423601f, 0.223837331f,
+  0.430466950f, -0.803495109f, -0.362443149f, -0.151088402f, 1.51485395f, 0.509601176f, -1.02642870f, -0.178037435f, -0.356348246f, -0.208211914f, -0.247109503f, -0.136965737f, -0.258707583f, 0.168229520f, 0.338629484f, -0.531982780f, -1.98820651f, -0.271387517f, -0.114443287f, 0.149346262f, 0.235547930f, -0.346161574f, 0.274624318f, -0.936631203f, -0.0378702357f, -0.164553091f, 0.0251125693f, -1.33944070f, -1.32743657f, 0.423535615f, -0.00296090357f, -0.351068795f,
+  0.289838701f, 0.465201288f, 0.426611602f, -0.0785199106f, 0.183149382f, -0.206182316f, -0.0356757492f, 0.110087737f, 0.390153944f, 1.47422147f, 0.495592088f, 0.203412980f, 0.665364742f, -0.253220469f, -0.0545220561f, -0.463077635f, 0.192157879f, -0.531498969f, -0.219007403f, -0.243095532f, 0.304822952f, 0.245960206f, 0.0560554042f, 0.449283183f, 0.168574587f, 0.124425784f, -0.148128673f, 0.424170583f, 0.588637233f, 0.525107801f, -0.109687887f, -0.354215562f,
+  1.13663316f, 0.747618139f, 0.392886698f, 0.0198040213f, 2.23893428f, 0.483131528f, 0.412961483f, 0.207961589f, -0.116716295f, 0.878595054f, -0.0406002365f, 1.12551343f, 0.346316338f, 0.831841826f, 0.131569237f, -0.378746748f, -0.361883014f, 0.0660608932f, -0.00583380647f, 0.990287125f, -0.184508696f, -0.228655204f, 0.0512194745f, -0.0967235267f, 0.280169457f, 0.877623916f, -0.313679338f, 0.163767189f, 0.505673409f, 0.422023207f, 0.331048369f, -0.407677501f,
+  -0.122801796f, -0.203937754f, -0.00529942987f, 0.0383378491f, 0.248925298f, -0.156339481f, -0.0659711137f, -0.240437880f, -0.0409816727f, -0.258569688f, 0.0446320996f, -0.0680204332f, -0.294093341f, -0.251745701f, -0.287027538f, 0.0323348232f, 0.165788218f, -0.0697334558f, -0.162947506f, 0.116963267f, 0.245268255f, 0.275973707f, 0.0385613218f, -0.222540036f, 0.255474895f, -0.112862349f, 0.0647122264f, -0.219241828f, -0.316805422f, -0.0858885646f, 0.00822472945f, -0.289672196f,
+  -0.560053885f, -0.521826625f, -0.138513595f, 0.121522427f, -2.76854658f, 0.456886202f, 0.208917663f, -0.349932581f, 0.198948935f, -1.68644691f, 0.293571621f, -0.177084163f, -0.140561342f, -0.648310363f, 0.855468273f, 0.569598138f, 0.119221471f, 0.910238981f, 0.0215703938f, 0.276290625f, -0.0434804410f, 0.220709398f, 0.512771785f, 0.238670468f, 0.0756094083f, -0.567554533f, -0.259183288f, 0.178029686f, -1.01024234f, -0.0998685807f, 0.653339624f, 0.766570508f,
+  0.830822647f, -0.138235033f, 0.399954528f, -0.189237326f, -0.215905666f, 0.380484968f, -0.417967170f, -0.190449759f, -0.418991208f, -0.996240079f, 0.0394781753f, 0.757581830f, 0.504321158f, 0.804342985f, 0.209260315f, -0.101157263f, -1.09658647f, 0.397666693f, -0.130556449f, 0.647973359f, -0.228116646f, 0.109197654f, 0.421865195f, 0.355772316f, -0.160215512f, 0.918710351f, 0.0789997727f, 0.432202816f, -0.227464855f, 0.782931626f, 0.634099364f, -0.535845101f,
+  0.445598066f, -0.173821360f, 0.00784060080f, 0.00577200856f, 0.957714617f, -0.113845602f, -0.263238847f, -0.0266465507f, -0.171915308f, 0.350658238f, 0.0526779853f, 0.610356629f, -0.0303245243f, 0.821707368f, -0.438643038f, -0.726147234f, -2.30175066f, 0.302662909f, -0.328183830f, 0.0651331767f, -0.0571119376f, -0.135080904f, 0.0375675149f, -0.614419878f, 0.280054390f, 0.450815737f, 0.243907779f, -0.461673558f, -0.414417446f, -0.117528431f, 0.0316787735f, -1.05063426f,
+  -0.248770058f, -0.00693823118f, -0.176926032f, -0.0332025588f, -0.264575243f, 0.289636314f, -0.205073789f, -0.187194556f, -0.190041289f, -0.274164110f, -0.220098138f, -0.250940651f, 0.124032520f, -0.0538897030f, 0.0980573893f, 0.290773124f, 0.0598536208f, 0.0770137683f, 0.288395137f, -0.209013700f, 0.208310813f, -0.0306903720f, -0.284895808f, -0.262893885f, 0.0967340171f, -0.330988675f, 0.287585586f, -0.130681142f, 0.146788538f, -0.0236915518f, -0.281675309f, 0.0280754864f,
+};
+const float ANN_B2[ANN_L2_OUT] ANN_PROGMEM = {
+  -0.153263092f, 0.617878735f, 0.642406344f, -0.323666275f, 0.388505697f, 0.596312284f, -0.0596498996f, -0.0140012540f, -0.0513278991f, -0.147657186f, 0.0684422180f, -0.0124230338f, 0.593050301f, 0.573826551f, -0.221155405f, -0.0274746660f,
 };
 
-// Layer 4 param 1 length=4
-const float L4_P1[] = { 
--0.14366534f, 0.14340012f, -0.08380602f, 0.12034389f
+constexpr uint16_t ANN_L3_IN = 16;
+constexpr uint16_t ANN_L3_OUT = 4;
+const float ANN_W3[ANN_L3_OUT * ANN_L3_IN] ANN_PROGMEM = {
+  0.607388675f, -0.454807580f, -0.331634790f, 0.291504890f, -0.920800149f, -0.921921313f, -0.00231687399f, 0.605514705f, 0.522808552f, 0.740071118f, 0.603618920f, -0.0383333974f, -0.709888875f, 0.0755426735f, 0.121752553f, 0.150829464f,
+  0.0862582251f, -2.24542880f, 0.631394744f, -0.0701543987f, -0.0513427667f, -0.0188516881f, -0.559165359f, 0.573684871f, 0.00287368312f, -0.801551998f, -1.99430645f, -0.428580016f, 0.576862574f, -2.76733041f, -0.872888625f, 0.0414030775f,
+  -0.466696054f, 0.0615786053f, -2.40319920f, -0.148106039f, 0.145144388f, -0.0898378938f, -0.881137311f, -0.575442672f, 0.569385350f, -0.355915159f, 0.552857518f, 0.0719124079f, -1.24006534f, 0.490275383f, 0.516357899f, 0.170492187f,
+  -0.794600070f, 0.252170354f, -0.502861977f, -1.58074439f, 0.406380326f, 0.829756737f, 0.250137806f, 0.107930243f, -0.966830075f, 0.169786707f, -0.290471524f, 0.0267086029f, 0.259869516f, 0.234316945f, -1.86542845f, 0.231416807f,
 };
+const float ANN_B3[ANN_L3_OUT] ANN_PROGMEM = {
+  -0.316581994f, 0.111179195f, -0.228131741f, 0.547673166f,
+};
+
+// Forward pass: normalized inputs -> output logits
+static inline void ann_forward(const float (&x)[ANN_IN_DIM], float (&logits)[ANN_OUT_DIM]) {
+  float a[64], b[32];
+  ann_dense<ANN_L0_IN, ANN_L0_OUT, true>(ANN_W0, ANN_B0, x, ann_view<ANN_L0_OUT>(a));
+  ann_dense<ANN_L1_IN, ANN_L1_OUT, true>(ANN_W1, ANN_B1, ann_view<ANN_L0_OUT>(a), ann_view<ANN_L1_OUT>(b));
+  ann_dense<ANN_L2_IN, ANN_L2_OUT, true>(ANN_W2, ANN_B2, ann_view<ANN_L1_OUT>(b), ann_view<ANN_L2_OUT>(a));
+  ann_dense<ANN_L3_IN, ANN_L3_OUT, false>(ANN_W3, ANN_B3, ann_view<ANN_L2_OUT>(a), logits);
+}
+
+// Normalized inputs -> argmax action
+static inline uint8_t ann_predict(const float (&x)[ANN_IN_DIM]) {
+  float logits[ANN_OUT_DIM];
+  ann_forward(x, logits);
+  return ann_argmax(logits);
+}
+
+#define ANN_MODEL_HASH 0xffc88432u
 
 #endif // ANN_WEIGHTS_H
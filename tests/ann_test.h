@@ -0,0 +1,34 @@
+// tests/ann_test.h
+// Minimal check macros for the host tests: a failed CHECK prints the expression and its location
+// and the test keeps going; ANN_TEST_RESULT() is the process exit code (non-zero if anything failed).
+#ifndef ANN_TEST_H
+#define ANN_TEST_H
+
+#include <iostream>
+
+static int ann_test_failures = 0;
+
+#define CHECK(cond)                                                                              \
+    do {                                                                                         \
+        if (!(cond)) {                                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond "\n";           \
+            ++ann_test_failures;                                                                 \
+        }                                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                           \
+    do {                                                                                         \
+        const auto ann_a_ = (a);                                                                 \
+        const auto ann_b_ = (b);                                                                 \
+        if (!(ann_a_ == ann_b_)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #a " == " #b " ("  \
+                      << +ann_a_ << " vs " << +ann_b_ << ")\n";                                  \
+            ++ann_test_failures;                                                                 \
+        }                                                                                        \
+    } while (0)
+
+#define ANN_TEST_RESULT(name)                                                                    \
+    (ann_test_failures ? (std::cerr << name << ": " << ann_test_failures << " check(s) failed\n", 1) \
+                       : (std::cout << name << ": all checks passed\n", 0))
+
+#endif // ANN_TEST_H
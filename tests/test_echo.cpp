@@ -0,0 +1,220 @@
+// tests/test_echo.cpp
+// Host test for the echo capture (firmware/ann_echo.h) and the angle -> distance map
+// (firmware/ann_scanmap.h). A checked-in width log (tests/data/echo_widths.txt, the firmware_host
+// --echo-log format) is replayed ping by ping through ann_echo_edge / ann_echo_poll / ann_echo_pop
+// with the module's timing from ann_echo.h (ECHO rises ANN_ECHO_RISE_US after the trigger and stays
+// high for the width, or ANN_ECHO_NONE_US when nothing is heard):
+// - every ping gives exactly one sample with the expected width, and a missing echo becomes a
+//   "no echo" sample at the 32 ms timeout (the module's late falling edge is ignored)
+// - a full ring drops new samples and counts them in dropped
+// - ann_map_bin_value median selection and age-out across the 16-bit timestamp wrap
+// - ann_map_sector reports false while any bin of the sector is stale
+// micros() starts just below the 32-bit wrap, and the log is replayed enough times to wrap head/tail.
+// Exits non-zero if any check fails.
+//
+// Build: cmake (target test_echo, run by ctest), or
+//        g++ -O2 -std=c++17 tests/test_echo.cpp -o tests/test_echo
+// Run:   tests/test_echo [widths.txt]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <stdexcept>
+
+#include "../firmware/ann_echo.h"
+#include "../firmware/ann_scanmap.h"
+#include "ann_test.h"
+
+namespace fs = std::filesystem;
+
+static const uint32_t STEP_US = 250;          // main loop poll granularity
+static const uint32_t PING_US = 60000;        // HC-SR04 measurement cycle
+static const uint32_t T0_US = 0xFFFF0000u;    // micros() wraps during the first pings
+
+static std::vector<unsigned long> load_widths(const std::string &path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Cannot open echo log: " + path);
+    std::vector<unsigned long> widths;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        unsigned long w;
+        if (ss >> w) widths.push_back(w);
+    }
+    if (widths.empty()) throw std::runtime_error("empty echo log: " + path);
+    return widths;
+}
+
+// What ann_echo_pop should return for a recorded width
+static uint16_t expected_width(unsigned long w) { return w > ANN_ECHO_TIMEOUT_US ? 0 : (uint16_t)w; }
+
+// One ping at now_us: trigger, ECHO edges as the module would send them, polls every STEP_US until
+// the echo line is low again. Returns the time the sample became available (0 if it never did).
+static uint32_t ping(AnnEcho &e, uint32_t &now_us, unsigned long w, uint8_t angle) {
+    const uint32_t trig = now_us;
+    ann_echo_trigger(e, trig, angle);
+    const uint32_t rise = trig + ANN_ECHO_RISE_US, fall = rise + (w ? w : ANN_ECHO_NONE_US);
+    const uint8_t head = e.head;
+    const uint8_t dropped = e.dropped;
+    bool rose = false, fell = false;
+    uint32_t ready = 0;
+    while (!fell) {
+        now_us += STEP_US;
+        const uint32_t dt = now_us - trig;
+        if (!rose && dt >= rise - trig) { ann_echo_edge(e, true, rise); rose = true; }
+        if (!fell && dt >= fall - trig) { ann_echo_edge(e, false, fall); fell = true; }
+        ann_echo_poll(e, now_us);
+        if (!ready && (e.head != head || e.dropped != dropped)) ready = dt;
+    }
+    CHECK(!ann_echo_busy(e));
+    now_us = trig + PING_US;
+    return ready;
+}
+
+static void test_replay(const std::vector<unsigned long> &widths) {
+    AnnEcho e;
+    ann_echo_init(e);
+    uint32_t now = T0_US;
+    size_t n = 0, timeouts = 0;
+    for (int rep = 0; rep < 12; ++rep) {  // > 256 pings: head and tail wrap
+        for (size_t i = 0; i < widths.size(); ++i, ++n) {
+            const uint8_t angle = uint8_t(30 + 15 * (n % ANN_MAP_BINS));
+            const uint32_t trig = now;
+            const uint32_t ready = ping(e, now, widths[i], angle);
+            AnnEchoSample s = {}, extra;
+            CHECK(ann_echo_pop(e, s));
+            CHECK(!ann_echo_pop(e, extra));  // one sample per ping, the late edge after a timeout adds none
+            CHECK_EQ(s.t_us, trig);
+            CHECK_EQ(s.angle, angle);
+            CHECK_EQ(s.width_us, expected_width(widths[i]));
+            if (widths[i] == 0) {
+                // nothing heard: ann_echo_poll gives up at the first poll past START + TIMEOUT (32 ms)
+                ++timeouts;
+                CHECK(ready > ANN_ECHO_START_US + ANN_ECHO_TIMEOUT_US);
+                CHECK(ready <= ANN_ECHO_START_US + ANN_ECHO_TIMEOUT_US + STEP_US);
+            } else {
+                CHECK(ready >= ANN_ECHO_RISE_US + widths[i]);
+                CHECK(ready < ANN_ECHO_RISE_US + widths[i] + STEP_US);
+            }
+        }
+    }
+    CHECK(timeouts > 0);
+    CHECK_EQ(int(e.dropped), 0);
+    CHECK_EQ(ann_echo_cm(11765), 200u);
+    CHECK_EQ(ann_echo_cm(1176), 20u);
+    CHECK_EQ(ann_echo_cm(588), 10u);
+    CHECK_EQ(ann_echo_cm(0), 999u);
+    CHECK_EQ(e.head, e.tail);
+    CHECK_EQ(e.head, uint8_t(n));
+}
+
+static void test_overflow(const std::vector<unsigned long> &widths) {
+    AnnEcho e;
+    ann_echo_init(e);
+    uint32_t now = T0_US;
+    const size_t pings = ANN_ECHO_RING + 3;
+    for (size_t i = 0; i < pings; ++i) ping(e, now, widths[i % widths.size()], 90);
+    CHECK_EQ(uint8_t(e.head - e.tail), ANN_ECHO_RING);
+    CHECK_EQ(int(e.dropped), 3);
+    // the oldest samples are kept, the newest were dropped
+    AnnEchoSample s = {};
+    for (size_t i = 0; i < ANN_ECHO_RING; ++i) {
+        CHECK(ann_echo_pop(e, s));
+        CHECK_EQ(s.width_us, expected_width(widths[i % widths.size()]));
+    }
+    CHECK(!ann_echo_pop(e, s));
+    // drained: the next ping gets through again
+    ping(e, now, 1176, 90);
+    CHECK(ann_echo_pop(e, s));
+    CHECK_EQ(s.width_us, 1176);
+    CHECK_EQ(int(e.dropped), 3);
+}
+
+static void test_map_median() {
+    AnnScanMap m;
+    ann_map_init(m, 30, 15, 1500);
+    const int8_t b = ann_map_bin_of(m, 90);
+    CHECK_EQ(b, 4);
+    CHECK_EQ(ann_map_bin_of(m, 97), 4);
+    CHECK_EQ(ann_map_bin_of(m, 98), 5);
+    CHECK_EQ(ann_map_bin_of(m, 22), -1);
+    CHECK_EQ(ann_map_bin_of(m, 158), -1);
+
+    // millis() such that the 16-bit timestamps wrap between the readings
+    const uint32_t t = 0x0003FFE0u;
+    unsigned int cm = 0;
+    CHECK(!ann_map_bin_value(m, uint8_t(b), t, cm));  // empty
+    ann_map_add(m, 90, 200, t);
+    ann_map_add(m, 90, 5, t + 20);     // ghost echo
+    ann_map_add(m, 90, 198, t + 40);   // stored as 0x0008
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 60, cm));
+    CHECK_EQ(cm, 198u);  // median of 200, 5, 198: the ghost doesn't win
+    // the first reading ages out: two fresh readings report the nearer one
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 1501, cm));
+    CHECK_EQ(cm, 5u);
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 1500, cm));
+    CHECK_EQ(cm, 198u);  // exactly max_age old still counts
+    // one fresh reading left, then none
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 1521, cm));
+    CHECK_EQ(cm, 198u);
+    CHECK(!ann_map_bin_value(m, uint8_t(b), t + 1541, cm));
+    // a shorter per-call limit ages readings out sooner
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 440, cm, 400));
+    CHECK_EQ(cm, 198u);
+    // a fourth reading replaces the oldest
+    ann_map_add(m, 90, 150, t + 60);
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 80, cm));
+    CHECK_EQ(cm, 150u);  // median of 5, 198, 150
+    ann_map_add(m, 90, 2000, t + 80);  // clamped to 999 (no echo)
+    CHECK(ann_map_bin_value(m, uint8_t(b), t + 100, cm));
+    CHECK_EQ(cm, 198u);  // median of 198, 150, 999
+    ann_map_clear(m);
+    CHECK(!ann_map_bin_value(m, uint8_t(b), t + 100, cm));
+}
+
+static void test_map_sector() {
+    AnnScanMap m;
+    ann_map_init(m, 30, 15, 1500);
+    const uint32_t t = 0x0001FF00u;
+    unsigned int cm = 0;
+    CHECK(!ann_map_sector(m, 75, 105, t, cm));  // nothing measured yet is never "clear"
+    ann_map_add(m, 75, 120, t);
+    ann_map_add(m, 90, 80, t);
+    CHECK(!ann_map_sector(m, 75, 105, t, cm));  // 105 still unknown
+    ann_map_add(m, 105, 60, t + 40);
+    CHECK(ann_map_sector(m, 75, 105, t + 100, cm));
+    CHECK_EQ(cm, 60u);
+    CHECK(ann_map_sector(m, 105, 75, t + 100, cm));  // bounds in either order
+    CHECK_EQ(cm, 60u);
+    // 75 and 90 refreshed, 105 not: the sector goes stale with 105
+    ann_map_add(m, 75, 110, t + 1000);
+    ann_map_add(m, 90, 90, t + 1000);
+    CHECK(ann_map_sector(m, 75, 105, t + 1540, cm));
+    CHECK(!ann_map_sector(m, 75, 105, t + 1541, cm));
+    CHECK(ann_map_sector(m, 75, 90, t + 1541, cm));
+    CHECK_EQ(cm, 90u);  // only the refreshed readings (110, 90) are still fresh
+    // the driving limit (400 ms) makes the whole front stale much sooner
+    CHECK(!ann_map_sector(m, 75, 90, t + 1401, cm, 400));
+    CHECK(!ann_map_sector(m, 0, 90, t + 1100, cm));  // outside the map
+}
+
+int main(int argc, char **argv) {
+    try {
+        const std::string path = argc > 1 ? std::string(argv[1])
+                                          : (fs::path(__FILE__).parent_path() / "data" / "echo_widths.txt").string();
+        const std::vector<unsigned long> widths = load_widths(path);
+        std::cout << "Replaying " << widths.size() << " echo widths from " << path << "\n";
+        test_replay(widths);
+        test_overflow(widths);
+        test_map_median();
+        test_map_sector();
+        return ANN_TEST_RESULT("test_echo");
+    } catch (const std::exception &ex) {
+        std::cerr << "Exception: " << ex.what() << std::endl;
+        return 1;
+    }
+}
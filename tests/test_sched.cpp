@@ -0,0 +1,143 @@
+// tests/test_sched.cpp
+// Host test for the cooperative scheduler (firmware/ann_sched.h) and the sketch's loop() built on
+// the host HAL (firmware/host):
+// - AnnTimer across the millis() wrap
+// - ann_sched_run periods and max_us bookkeeping with a fake microsecond clock (also across the wrap)
+// - a critical front echo cuts the motors (ENA = 0) in the same loop() pass that pops it
+// - no loop() pass blocks: the longest pass stays under ANN_TEST_MAX_PASS_US of board time
+// Exits non-zero if any check fails.
+//
+// Needs models/arduino_weights.h (checked in, or a train_ann export).
+// Build: cmake (target test_sched, run by ctest), or
+//        g++ -O2 -std=c++17 -I firmware/host tests/test_sched.cpp -o tests/test_sched
+// Run:   tests/test_sched
+
+#include <iostream>
+#include <stdexcept>
+
+#include "../firmware/robot_ann.ino"
+#include "ann_test.h"
+
+// loop() only fires pings (12 us of delayMicroseconds) and never waits for an echo, a servo or a
+// timer; a blocking call (pulseIn, delay) would take milliseconds
+static const uint64_t ANN_TEST_MAX_PASS_US = 100;
+
+// --- ann_sched.h on its own ---
+static uint32_t g_clock_us = 0;
+static uint32_t fake_clock_us() { return g_clock_us; }
+
+static unsigned g_calls[3];
+static uint32_t g_cost_us[3];
+static void task0(uint32_t) { ++g_calls[0]; g_clock_us += g_cost_us[0]; }
+static void task1(uint32_t) { ++g_calls[1]; g_clock_us += g_cost_us[1]; }
+static void task2(uint32_t) { ++g_calls[2]; g_clock_us += g_cost_us[2]; }
+
+static void test_timer_wrap() {
+    AnnTimer t;
+    t.set(0xFFFFFF00u, 0x200);
+    CHECK(!t.expired(0xFFFFFF00u));
+    CHECK(!t.expired(0xFFFFFFFFu));
+    CHECK(!t.expired(0x00000000u));
+    CHECK(!t.expired(0x000000FFu));  // 0x1FF ms elapsed
+    CHECK(t.expired(0x00000100u));   // exactly 0x200
+    CHECK(t.expired(0x00001000u));
+
+    AnnTimer z;
+    z.set(0xFFFFFFFFu, 0);  // zero duration: due at once
+    CHECK(z.expired(0xFFFFFFFFu));
+    CHECK(z.expired(0));
+}
+
+static void test_sched_run(uint32_t start_ms, uint32_t start_us) {
+    AnnTask tasks[] = {
+        { task0, 0, start_ms, 0 },   // every pass
+        { task1, 10, start_ms, 0 },
+        { task2, 25, start_ms, 0 },
+    };
+    g_calls[0] = g_calls[1] = g_calls[2] = 0;
+    g_clock_us = start_us;
+    for (uint32_t i = 0; i < 100; ++i) {
+        g_cost_us[0] = i % 7;
+        g_cost_us[1] = 40 + (i == 50 ? 200 : 0);
+        g_cost_us[2] = 5;
+        ann_sched_run(tasks, start_ms + i, fake_clock_us);
+        g_clock_us += 1000 - 300;  // rest of the millisecond
+    }
+    CHECK_EQ(g_calls[0], 100u);
+    CHECK_EQ(g_calls[1], 9u);   // +10 ... +90
+    CHECK_EQ(g_calls[2], 3u);   // +25, +50, +75
+    CHECK_EQ(tasks[1].last_ms, start_ms + 90);
+    CHECK_EQ(tasks[2].last_ms, start_ms + 75);
+    CHECK_EQ(tasks[0].max_us, 6u);
+    CHECK_EQ(tasks[1].max_us, 240u);  // the slow run at +50
+    CHECK_EQ(tasks[2].max_us, 5u);
+    CHECK_EQ(ann_sched_max_us(tasks), 240u);
+}
+
+// --- robot_ann.ino on the host HAL ---
+static unsigned int g_front_cm = 200, g_side_cm = 200;
+
+static void test_sketch() {
+    AnnHostHal &hal = ann_host_hal();
+    hal.echo_us = [&](uint64_t) -> unsigned long {
+        const int a = hal.servo_angle;
+        const unsigned int d = (a >= 120 || a <= 60) ? g_side_cm : g_front_cm;
+        return (unsigned long)(d * 2.0 / 0.034);
+    };
+    setup();
+
+    uint64_t max_pass_us = 0;
+    bool drove = false, cut = false;
+    uint64_t onset_us = 0;
+    const uint64_t end_us = 3000 * 1000;
+    while (hal.now_us < end_us) {
+        if (!onset_us && drove && hal.now_us >= 1500 * 1000) {
+            g_front_cm = 8;  // something steps in front of the robot
+            onset_us = hal.now_us;
+        }
+        const AnnCtlState before = ctl.state;
+        const bool forward = hal.pwm[ENA] > 0 && ctl.motor == ANN_M_FORWARD;
+        const uint8_t tail = echo.tail;
+        const uint64_t t0 = hal.now_us;
+        loop();
+        const uint64_t pass = hal.now_us - t0;
+        if (pass > max_pass_us) max_pass_us = pass;
+        if (forward) drove = true;
+        if (before == ANN_ST_DRIVE && ctl.state == ANN_ST_CRITICAL) {
+            // ENA is already 0 when the pass that went critical returns
+            CHECK(forward);
+            CHECK_EQ(hal.pwm[ENA], 0);
+            CHECK_EQ(hal.pwm[ENB], 0);
+            CHECK(onset_us != 0);
+            if (!cut && onset_us) {
+                cut = true;
+                // the first cut comes from the echo popped in this very pass (later ones may come from
+                // the map once the critical hold ends), one ping interval plus the round trip after onset
+                CHECK(echo.tail != tail);
+                CHECK_EQ(ctl.crit_cm, g_front_cm);
+                CHECK(hal.now_us - onset_us <= uint64_t(ANN_PING_INTERVAL_MS) * 1000 + ANN_ECHO_START_US + ANN_ECHO_TIMEOUT_US);
+            }
+        }
+        ann_host_advance(50);
+    }
+    CHECK(drove);
+    CHECK(cut);
+    std::cout << "longest loop() pass " << max_pass_us << " us (bound " << ANN_TEST_MAX_PASS_US << " us), scheduler worst "
+              << ann_sched_max_us(TASKS) << " us\n";
+    CHECK(max_pass_us < ANN_TEST_MAX_PASS_US);
+    CHECK(ann_sched_max_us(TASKS) < ANN_TEST_MAX_PASS_US);
+    CHECK_EQ(int(echo.dropped), 0);
+}
+
+int main() {
+    try {
+        test_timer_wrap();
+        test_sched_run(0, 0);
+        test_sched_run(0xFFFFFFF0u, 0xFFFFFF00u);  // millis() and micros() both wrap mid-run
+        test_sketch();
+        return ANN_TEST_RESULT("test_sched");
+    } catch (const std::exception &ex) {
+        std::cerr << "Exception: " << ex.what() << std::endl;
+        return 1;
+    }
+}
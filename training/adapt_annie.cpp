@@ -0,0 +1,405 @@
+// training/adapt_annie.cpp
+// Convert the Dynamic Indoor Robot Navigation dataset (training/dataset_download.py) to ANNie format
+// (replaces adapt-annie.py; same conversion and labelling rules, no Python needed)
+// Each output row: front,left,right,diff,minLR,action
+// - Source columns are found by header name: lidar_min (front), ultrasonic_left, ultrasonic_right in
+//   metres and collision_flag (missing = 0). Distances become cm clipped to 0..100 and truncated to whole
+//   cm like the script's astype(int); diff = left - right and minLR = min(left, right) follow the input
+//   contract (firmware/ann_features.h), i.e. they come from the whole-cm distances the robot would read
+// - Labels come from the clipped, untruncated distances: collision or all three < 20 -> STOP,
+//   front > 40 and the largest -> FORWARD, else the wider side above 30 -> LEFT / RIGHT, else STOP
+// - Streaming: the CSV is read in fixed-size blocks cut at line ends, blocks are parsed on the thread
+//   pool and consumed in file order with a bounded number in flight (memory ~ 2 * threads * block size)
+// - Balancing, pass 1: per-class counts plus a reservoir of up to --reservoir row indices per class
+//   (Algorithm R). Every smaller class draws (largest count - its count) extra copies with replacement
+//   from its reservoir, stored as a copy count per reservoir entry (exact while the class fits).
+//   Pass 2 re-streams the source and writes each row followed by its extra copies; rows are never
+//   held in memory. Output keeps source order (train_ann shuffles before splitting)
+// - Rows with a missing or malformed distance are skipped and counted (the script failed on them)
+// - --format bin writes the binary dataset format from dataset_io.h; its row count is known after pass 1
+//
+// Compile: cl /EHsc /O2 /std:c++17 training\adapt_annie.cpp /Fe:training\adapt_annie.exe
+// Run: training\adapt_annie.exe [--in data\dataset1.csv] [--out data\dataset_converted.csv] [--format csv|bin]
+//                              [--threads T] [--block-mb M] [--reservoir N] [--seed X] [--no-balance]
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dataset_io.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+static const char *CLASS_NAMES[4] = {"FORWARD", "LEFT", "RIGHT", "STOP"};
+
+// Same rules as derive_label() in the old adapt-annie.py
+static inline int derive_label(double front, double left, double right, int collision) {
+    if (collision == 1) return 3;                                     // STOP
+    if (front < 20 && left < 20 && right < 20) return 3;              // STOP
+    if (front > 40 && front > left && front > right) return 0;        // FORWARD
+    if (left > right && left > 30) return 1;                          // LEFT
+    if (right > left && right > 30) return 2;                         // RIGHT
+    return 3;                                                         // fallback = STOP
+}
+
+struct Converted {
+    uint8_t front, left, right, minLR; // cm
+    int8_t diff, action;
+};
+
+// Column indices of the source fields in use
+struct SourceColumns {
+    int front = -1, left = -1, right = -1, collision = -1;
+    int last() const { return std::max({front, left, right, collision}); }
+};
+
+static inline std::string trim_field(const char *b, const char *e) {
+    while (b < e && (*b == ' ' || *b == '\t' || *b == '"' || *b == '\r')) ++b;
+    while (e > b && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '"' || e[-1] == '\r')) --e;
+    return std::string(b, e);
+}
+
+static SourceColumns map_columns(const std::string &header) {
+    SourceColumns c;
+    const char *p = header.data(), *end = p + header.size();
+    for (int k = 0;; ++k) {
+        const char *comma = static_cast<const char *>(std::memchr(p, ',', size_t(end - p)));
+        const std::string name = trim_field(p, comma ? comma : end);
+        if (name == "lidar_min") c.front = k;
+        else if (name == "ultrasonic_left") c.left = k;
+        else if (name == "ultrasonic_right") c.right = k;
+        else if (name == "collision_flag") c.collision = k;
+        if (!comma) break;
+        p = comma + 1;
+    }
+    if (c.front < 0 || c.left < 0 || c.right < 0)
+        throw std::runtime_error("source header needs lidar_min, ultrasonic_left and ultrasonic_right columns");
+    return c;
+}
+
+// Parse a number field; false if empty, malformed or NaN
+static inline bool parse_number(const char *b, const char *e, double &v) {
+    while (b < e && (*b == ' ' || *b == '\t' || *b == '"' || *b == '+')) ++b;
+    while (e > b && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '"' || e[-1] == '\r')) --e;
+    if (b == e) return false;
+    auto res = std::from_chars(b, e, v);
+    return res.ec == std::errc() && res.ptr == e && !std::isnan(v);
+}
+
+static inline double to_cm(double metres) { return std::clamp(metres * 100.0, 0.0, 100.0); }
+
+// Convert one source line; false if a distance is missing or malformed
+static bool convert_line(const char *p, const char *end, const SourceColumns &cols, Converted &out) {
+    double v[3] = {0, 0, 0}, collision = 0;
+    bool have[3] = {false, false, false};
+    const int last = cols.last();
+    for (int k = 0; k <= last; ++k) {
+        const char *comma = static_cast<const char *>(std::memchr(p, ',', size_t(end - p)));
+        const char *fend = comma ? comma : end;
+        if (k == cols.front) have[0] = parse_number(p, fend, v[0]);
+        else if (k == cols.left) have[1] = parse_number(p, fend, v[1]);
+        else if (k == cols.right) have[2] = parse_number(p, fend, v[2]);
+        else if (k == cols.collision && !parse_number(p, fend, collision)) collision = 0; // fillna(0)
+        if (!comma) break;
+        p = comma + 1;
+    }
+    if (!have[0] || !have[1] || !have[2]) return false;
+    const double f = to_cm(v[0]), l = to_cm(v[1]), r = to_cm(v[2]);
+    out.front = uint8_t(f);
+    out.left = uint8_t(l);
+    out.right = uint8_t(r);
+    out.diff = int8_t(out.left - out.right);
+    out.minLR = std::min(out.left, out.right);
+    out.action = int8_t(derive_label(f, l, r, int(collision)));
+    return true;
+}
+
+struct ParsedBlock {
+    std::vector<Converted> rows;
+    size_t skipped = 0;
+};
+
+static ParsedBlock parse_block(const std::string &text, const SourceColumns &cols) {
+    ParsedBlock b;
+    b.rows.reserve(text.size() / 32);
+    const char *p = text.data(), *end = p + text.size();
+    while (p < end) {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+        const char *eol = nl ? nl : end;
+        const char *lend = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+        Converted c;
+        if (lend > p) {
+            if (convert_line(p, lend, cols, c)) b.rows.push_back(c);
+            else ++b.skipped;
+        }
+        p = nl ? nl + 1 : end;
+    }
+    return b;
+}
+
+// Sequential reader handing out blocks of whole lines
+class BlockReader {
+public:
+    BlockReader(const fs::path &path, size_t block) : in_(path, std::ios::binary), block_(block) {
+        if (!in_) throw std::runtime_error("cannot open " + path.string());
+        if (!std::getline(in_, header_)) throw std::runtime_error("empty source file " + path.string());
+    }
+    const std::string &header() const { return header_; }
+
+    bool next(std::string &buf) {
+        buf.swap(carry_);
+        carry_.clear();
+        for (;;) {
+            const size_t old = buf.size();
+            buf.resize(old + block_);
+            in_.read(&buf[old], std::streamsize(block_));
+            buf.resize(old + size_t(in_.gcount()));
+            if (!in_) return !buf.empty(); // end of file: the rest is the last block
+            const size_t nl = buf.rfind('\n');
+            if (nl != std::string::npos && nl >= old) { // cut after the last complete line
+                carry_.assign(buf, nl + 1, std::string::npos);
+                buf.resize(nl + 1);
+                return true;
+            }
+        }
+    }
+
+private:
+    std::ifstream in_;
+    std::string header_, carry_;
+    size_t block_;
+};
+
+// One pass over the source: blocks parsed on the pool, consume() called in file order
+template <class F>
+static size_t stream_source(const fs::path &path, size_t block, ThreadPool &pool, F &&consume) {
+    BlockReader reader(path, block);
+    const SourceColumns cols = map_columns(reader.header());
+    const size_t window = 2 * pool.size();
+    std::deque<std::future<ParsedBlock>> inflight;
+    size_t skipped = 0;
+    auto drain_one = [&]() {
+        ParsedBlock b = inflight.front().get();
+        inflight.pop_front();
+        skipped += b.skipped;
+        consume(b);
+    };
+    std::string text;
+    while (reader.next(text)) {
+        inflight.push_back(pool.submit([t = std::move(text), &cols]() { return parse_block(t, cols); }));
+        text = std::string();
+        if (inflight.size() >= window) drain_one();
+    }
+    while (!inflight.empty()) drain_one();
+    return skipped;
+}
+
+// Buffered output in either format; bin columns are flushed in chunks at their final offsets
+class ConvertedWriter {
+public:
+    ConvertedWriter(const fs::path &path, bool binary, uint64_t rows)
+        : out_(path, std::ios::binary), binary_(binary), rows_(rows) {
+        if (!out_) throw std::runtime_error("cannot open " + path.string());
+        if (binary_) {
+            DatasetBinHeader h = make_bin_header(rows_, default_feature_norm());
+            out_.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        } else {
+            out_ << "front,left,right,diff,minLR,action\n";
+        }
+    }
+
+    void put(const Converted &c) {
+        ++written_;
+        if (binary_) {
+            float v[ANN_FEAT_COUNT];
+            ann_features(c.front, c.left, c.right, v);
+            for (size_t j = 0; j < NUM_FEATURES; ++j) cols_[j].push_back(v[j]);
+            labels_.push_back(c.action);
+            if (labels_.size() == CHUNK) flush();
+        } else {
+            char *p = line_;
+            p = std::to_chars(p, line_ + sizeof(line_), int(c.front)).ptr; *p++ = ',';
+            p = std::to_chars(p, line_ + sizeof(line_), int(c.left)).ptr; *p++ = ',';
+            p = std::to_chars(p, line_ + sizeof(line_), int(c.right)).ptr; *p++ = ',';
+            p = std::to_chars(p, line_ + sizeof(line_), int(c.diff)).ptr; *p++ = ',';
+            p = std::to_chars(p, line_ + sizeof(line_), int(c.minLR)).ptr; *p++ = ',';
+            *p++ = char('0' + c.action);
+            *p++ = '\n';
+            text_.append(line_, p);
+            if (text_.size() >= (1u << 20)) flush();
+        }
+    }
+
+    uint64_t close() {
+        flush();
+        out_.close();
+        if (!out_) throw std::runtime_error("failed writing output");
+        if (binary_ && written_ != rows_) throw std::runtime_error("row count changed between passes (source modified?)");
+        return written_;
+    }
+
+private:
+    static const size_t CHUNK = 1 << 16;
+
+    void flush() {
+        if (binary_) {
+            if (labels_.empty()) return;
+            const uint64_t first = written_ - labels_.size();
+            if (written_ > rows_) throw std::runtime_error("row count changed between passes (source modified?)");
+            for (size_t j = 0; j < NUM_FEATURES; ++j) {
+                out_.seekp(std::streamoff(bin_column_offset(rows_, j) + first * sizeof(float)));
+                out_.write(reinterpret_cast<const char *>(cols_[j].data()), std::streamsize(cols_[j].size() * sizeof(float)));
+                cols_[j].clear();
+            }
+            out_.seekp(std::streamoff(bin_label_offset(rows_) + first));
+            out_.write(reinterpret_cast<const char *>(labels_.data()), std::streamsize(labels_.size()));
+            labels_.clear();
+        } else {
+            out_.write(text_.data(), std::streamsize(text_.size()));
+            text_.clear();
+        }
+    }
+
+    std::ofstream out_;
+    bool binary_;
+    uint64_t rows_, written_ = 0;
+    std::array<std::vector<float>, NUM_FEATURES> cols_;
+    std::vector<int8_t> labels_;
+    std::string text_;
+    char line_[32];
+};
+
+static bool parse_u64(const char *s, uint64_t &v) {
+    auto res = std::from_chars(s, s + std::strlen(s), v);
+    return res.ec == std::errc() && *res.ptr == '\0';
+}
+
+int main(int argc, char **argv) {
+    try {
+        fs::path repoRoot = fs::path(__FILE__).parent_path().parent_path();
+        fs::path inPath = repoRoot / "data" / "dataset1.csv", outPath;
+        uint64_t threads = std::max(1u, std::thread::hardware_concurrency());
+        uint64_t blockMb = 8, reservoirCap = 1 << 20, seed = 42;
+        bool binary = false, balance = true;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto next = [&]() -> const char * {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+                return argv[++i];
+            };
+            bool ok = true;
+            if (a == "--in") inPath = next();
+            else if (a == "--out") outPath = next();
+            else if (a == "--threads") ok = parse_u64(next(), threads);
+            else if (a == "--block-mb") ok = parse_u64(next(), blockMb);
+            else if (a == "--reservoir") ok = parse_u64(next(), reservoirCap);
+            else if (a == "--seed") ok = parse_u64(next(), seed);
+            else if (a == "--no-balance") balance = false;
+            else if (a == "--format") {
+                std::string f = next();
+                if (f == "bin") binary = true;
+                else if (f != "csv") ok = false;
+            } else {
+                std::cerr << "Usage: adapt_annie [--in source.csv] [--out path] [--format csv|bin] [--threads T]\n"
+                             "                   [--block-mb M] [--reservoir N] [--seed X] [--no-balance]\n";
+                return 1;
+            }
+            if (!ok) throw std::runtime_error("invalid value for " + a);
+        }
+        if (threads == 0 || blockMb == 0 || reservoirCap == 0)
+            throw std::runtime_error("--threads, --block-mb and --reservoir must be > 0");
+        if (outPath.empty()) outPath = repoRoot / "data" / (binary ? "dataset_converted.annb" : "dataset_converted.csv");
+        if (outPath.has_parent_path()) fs::create_directories(outPath.parent_path());
+        const size_t block = size_t(blockMb) << 20;
+        ThreadPool pool(threads);
+
+        // Pass 1: class counts and per-class reservoirs of row indices
+        auto t0 = std::chrono::steady_clock::now();
+        auto seconds = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+        std::mt19937_64 rng(seed);
+        std::array<uint64_t, 4> counts = {0, 0, 0, 0};
+        std::array<std::vector<uint64_t>, 4> reservoir;
+        uint64_t row = 0;
+        const size_t skipped = stream_source(inPath, block, pool, [&](const ParsedBlock &b) {
+            for (const Converted &c : b.rows) {
+                const uint64_t seen = counts[c.action]++;
+                std::vector<uint64_t> &res = reservoir[c.action];
+                if (res.size() < reservoirCap) res.push_back(row);
+                else {
+                    const uint64_t j = std::uniform_int_distribution<uint64_t>(0, seen)(rng);
+                    if (j < reservoirCap) res[j] = row;
+                }
+                ++row;
+            }
+        });
+        const double pass1 = seconds();
+        if (row == 0) throw std::runtime_error("no valid rows in " + inPath.string());
+        std::cout << "Pass 1: " << row << " rows, " << skipped << " skipped (missing/malformed distance) in " << pass1 << " s\n";
+
+        // Extra copies: multinomial over each class's reservoir, drawn as sequential binomials
+        const uint64_t target = *std::max_element(counts.begin(), counts.end());
+        std::vector<std::pair<uint64_t, uint32_t>> extra; // (row, copies), sorted by row
+        std::array<uint64_t, 4> outCounts = counts;
+        for (int c = 0; c < 4 && balance; ++c) {
+            if (counts[c] == 0 || counts[c] == target) continue;
+            uint64_t left = target - counts[c];
+            outCounts[c] = target;
+            const std::vector<uint64_t> &res = reservoir[c];
+            for (size_t k = 0; k < res.size() && left; ++k) {
+                const uint64_t copies = (k + 1 == res.size())
+                    ? left : std::binomial_distribution<uint64_t>(left, 1.0 / double(res.size() - k))(rng);
+                if (copies) extra.emplace_back(res[k], uint32_t(copies));
+                left -= copies;
+            }
+            if (counts[c] > reservoirCap)
+                std::cout << "  " << CLASS_NAMES[c] << ": oversampled from a " << reservoirCap << "-row reservoir of "
+                          << counts[c] << " rows\n";
+        }
+        for (auto &res : reservoir) std::vector<uint64_t>().swap(res);
+        std::sort(extra.begin(), extra.end());
+        uint64_t total = 0;
+        for (uint64_t n : outCounts) total += n;
+
+        // Pass 2: re-stream and write each row plus its extra copies
+        ConvertedWriter writer(outPath, binary, total);
+        size_t e = 0;
+        row = 0;
+        stream_source(inPath, block, pool, [&](const ParsedBlock &b) {
+            for (const Converted &c : b.rows) {
+                writer.put(c);
+                for (; e < extra.size() && extra[e].first == row; ++e)
+                    for (uint32_t k = 0; k < extra[e].second; ++k) writer.put(c);
+                ++row;
+            }
+        });
+        const uint64_t written = writer.close();
+        const double secs = seconds();
+
+        std::cout << "Wrote " << outPath.string() << " with " << written << " rows (" << (binary ? "bin" : "csv") << ", "
+                  << threads << " threads, " << secs << " s, pass 2 " << secs - pass1 << " s)\n";
+        std::cout << "Original counts ->";
+        for (int c = 0; c < 4; ++c) std::cout << " " << CLASS_NAMES[c] << "=" << counts[c];
+        std::cout << "\nBalanced counts ->";
+        for (int c = 0; c < 4; ++c) std::cout << " " << CLASS_NAMES[c] << "=" << outCounts[c];
+        std::cout << std::endl;
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "Exception: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,382 @@
+// training/bench_annie.cpp
+// Benchmarks for ANNie's host pipeline and firmware kernels; results go to JSON for tracking across commits.
+// - load:     CSV parse (rows/s) and binary dataset load, on an in-memory synthetic CSV
+// - convert:  Dataset -> tiny-dnn vec_t (to_tiny)
+// - predict:  single-sample latency (p50/p99) for tiny-dnn net.predict and MlpEngine, batched MlpEngine throughput,
+//             argmax agreement of the two (1.0 expected, see mlp_engine.h)
+// - train:    seconds per epoch for tiny-dnn and the native trainer (1 and N threads)
+// - firmware: float (ann_mlp.h) and int8 (ann_q8.h) kernels compiled for the host through ann_pgm.h,
+//             MACs per decision counted through ANN_MAC_HOOK in a separate instrumented instantiation,
+//             ns per decision on this machine with the plain one
+//
+// Build: cmake (target bench_annie, see CMakeLists.txt), or (Linux):
+//   g++ -O2 -std=c++17 -mavx2 -ffp-contract=off -pthread training/bench_annie.cpp -I vendor/tiny-dnn -o training/bench_annie
+// Build (Developer Command Prompt):
+//   cl /EHsc /O2 /std:c++17 /arch:AVX2 training\bench_annie.cpp /I vendor\tiny-dnn /Fe:training\bench_annie.exe
+// Run:
+//   training/bench_annie [--rows N] [--epochs N] [--threads N] [--out models/bench.json]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <charconv>
+#include <thread>
+#include <filesystem>
+
+#include "tiny_dnn/tiny_dnn.h"
+#include "dataset_io.h"
+#include "mlp_engine.h"
+#include "mlp_trainer.h"
+#include "quantize.h"
+#include "tiny_bridge.h"
+
+// The firmware float kernel twice: mac_count:: increments g_macs once per MAC through ANN_MAC_HOOK
+// and only runs to count them; the timed loop runs the plain global instantiation.
+// (ann_pgm.h and <stdint.h> are already included above, so only the kernel lands in the namespace.)
+static unsigned long g_macs = 0;
+namespace mac_count {
+#define ANN_MAC_HOOK() (++g_macs)
+#include "../firmware/ann_mlp.h"
+#undef ANN_MAC_HOOK
+#undef ANN_MLP_H
+}
+#include "../firmware/ann_mlp.h"
+
+namespace fs = std::filesystem;
+using clk = std::chrono::steady_clock;
+
+static double seconds_since(clk::time_point t0) { return std::chrono::duration<double>(clk::now() - t0).count(); }
+
+// Percentile of a sample set (nearest rank)
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t k = static_cast<size_t>(p / 100.0 * double(v.size() - 1) + 0.5);
+    return v[std::min(k, v.size() - 1)];
+}
+
+// Flat JSON writer: "section": { "key": value, ... }
+struct JsonOut {
+    std::ostringstream os;
+    bool first_section = true, first_key = true;
+    JsonOut() { os << "{\n"; }
+    void section(const std::string &name) {
+        if (!first_section) os << "\n  },\n";
+        first_section = false;
+        first_key = true;
+        os << "  \"" << name << "\": {";
+    }
+    template <class T>
+    void put(const std::string &key, const T &v) {
+        os << (first_key ? "\n" : ",\n") << "    \"" << key << "\": " << v;
+        first_key = false;
+        const std::ios::fmtflags flags = std::cout.flags();
+        std::cout << "  " << std::left << std::setw(34) << key << v << "\n";
+        std::cout.flags(flags);
+    }
+    void put_str(const std::string &key, const std::string &v) { put(key, "\"" + v + "\""); }
+    std::string str() { return os.str() + (first_section ? "" : "\n  }") + "\n}\n"; }
+};
+
+// Same rules as generate_synthetic.cpp, formatted the same way
+static std::string make_csv(size_t rows, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0f, 100.0f);
+    std::string s = "front,left,right,diff,minLR,action\n";
+    s.reserve(rows * 48);
+    char buf[128];
+    for (size_t i = 0; i < rows; ++i) {
+        float f = dist(rng), l = dist(rng), r = dist(rng);
+        int a = f > 70.0f ? 0 : (l - r) > 5.0f ? 1 : (r - l) > 5.0f ? 2 : 3;
+        const float v[5] = {f, l, r, l - r, std::min(l, r)};
+        char *p = buf;
+        for (float x : v) {
+            p = std::to_chars(p, buf + sizeof(buf), x, std::chars_format::general, 6).ptr;
+            *p++ = ',';
+        }
+        *p++ = char('0' + a);
+        *p++ = '\n';
+        s.append(buf, p);
+    }
+    return s;
+}
+
+// Layer l of p in the firmware's row-major [out][in] layout
+static void copy_firmware_layer(const MlpParams &p, size_t l, float *W, float *B) {
+    const size_t in = p.dims[l], out = p.dims[l + 1];
+    for (size_t o = 0; o < out; ++o)
+        for (size_t c = 0; c < in; ++c) W[o * in + c] = p.W[l][c * out + o];
+    for (size_t o = 0; o < out; ++o) B[o] = p.b[l][o];
+}
+
+// Which ann_dense instantiation a FirmwareMlp runs
+struct PlainDense {
+    template <uint16_t IN, uint16_t OUT, bool RELU>
+    static void run(const float (&W)[OUT * IN], const float (&B)[OUT], const float (&in)[IN], float (&out)[OUT]) {
+        ann_dense<IN, OUT, RELU>(W, B, in, out);
+    }
+};
+struct CountedDense {
+    template <uint16_t IN, uint16_t OUT, bool RELU>
+    static void run(const float (&W)[OUT * IN], const float (&B)[OUT], const float (&in)[IN], float (&out)[OUT]) {
+        mac_count::ann_dense<IN, OUT, RELU>(W, B, in, out);
+    }
+};
+
+// Firmware float kernel (ann_dense per layer, ReLU on all but the last) for a compile-time topology
+template <class K, uint16_t... D>
+struct FirmwareMlp;
+
+template <class K, uint16_t IN, uint16_t OUT>
+struct FirmwareMlp<K, IN, OUT> {
+    float W[OUT * IN], B[OUT];
+    static std::vector<size_t> dims() { return {IN, OUT}; }
+    void load(const MlpParams &p, size_t l) { copy_firmware_layer(p, l, W, B); }
+    uint8_t predict(const float (&x)[IN]) const {
+        float logits[OUT];
+        K::template run<IN, OUT, false>(W, B, x, logits);
+        return ann_argmax(logits);
+    }
+};
+
+template <class K, uint16_t IN, uint16_t OUT, uint16_t... REST>
+struct FirmwareMlp<K, IN, OUT, REST...> {
+    float W[OUT * IN], B[OUT];
+    FirmwareMlp<K, OUT, REST...> next;
+    static std::vector<size_t> dims() {
+        std::vector<size_t> d = FirmwareMlp<K, OUT, REST...>::dims();
+        d.insert(d.begin(), IN);
+        return d;
+    }
+    void load(const MlpParams &p, size_t l = 0) {
+        if (l == 0 && p.dims != dims()) throw std::runtime_error("firmware kernel topology does not match the trained params");
+        copy_firmware_layer(p, l, W, B);
+        next.load(p, l + 1);
+    }
+    uint8_t predict(const float (&x)[IN]) const {
+        float h[OUT];
+        K::template run<IN, OUT, true>(W, B, x, h);
+        return next.predict(h);
+    }
+};
+
+// Kernel benchmarked under [firmware]: the default topology (checked against MlpConfig at startup)
+typedef FirmwareMlp<PlainDense, NUM_FEATURES, 64, 32, 16, NUM_CLASSES> BenchFirmware;
+typedef FirmwareMlp<CountedDense, NUM_FEATURES, 64, 32, 16, NUM_CLASSES> BenchFirmwareCounted;
+
+int main(int argc, char **argv) {
+    try {
+        size_t rows = 200000;
+        int epochs = 1;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        fs::path repoRoot = fs::path(__FILE__).parent_path().parent_path();
+        fs::path outPath = repoRoot / "models" / "bench.json";
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            bool has = i + 1 < argc;
+            if (a == "--rows" && has) rows = std::stoul(argv[++i]);
+            else if (a == "--epochs" && has) epochs = std::stoi(argv[++i]);
+            else if (a == "--threads" && has) threads = std::stoul(argv[++i]);
+            else if (a == "--out" && has) outPath = argv[++i];
+            else {
+                std::cerr << "Usage: bench_annie [--rows N] [--epochs N] [--threads N] [--out path.json]\n";
+                return 1;
+            }
+        }
+
+        JsonOut js;
+        js.section("env");
+#if defined(MLP_ENGINE_AVX2)
+        js.put_str("simd", "avx2");
+#elif defined(MLP_ENGINE_SSE)
+        js.put_str("simd", "sse");
+#else
+        js.put_str("simd", "scalar");
+#endif
+#if defined(__VERSION__)
+        js.put_str("compiler", std::string(__VERSION__));
+#elif defined(_MSC_VER)
+        js.put("compiler_msc_ver", _MSC_VER);
+#endif
+        js.put("hardware_threads", std::thread::hardware_concurrency());
+        js.put("rows", rows);
+
+        // ---- load ----
+        std::cout << "[load]\n";
+        const std::string csv = make_csv(rows, 42);
+        Dataset ds;
+        size_t skipped = 0;
+        auto t0 = clk::now();
+        parse_dataset_csv(csv.data(), csv.size(), ds, skipped, false);
+        double parse_s = seconds_since(t0);
+
+        const fs::path tmpBin = fs::temp_directory_path() / "annie_bench.annb";
+        write_dataset_bin(tmpBin.string(), ds);
+        Dataset ds2;
+        t0 = clk::now();
+        read_dataset_bin(tmpBin.string(), ds2);
+        double bin_s = seconds_since(t0);
+        fs::remove(tmpBin);
+
+        js.section("load");
+        js.put("csv_bytes", csv.size());
+        js.put("csv_parse_seconds", parse_s);
+        js.put("csv_rows_per_sec", double(ds.size()) / parse_s);
+        js.put("csv_mb_per_sec", double(csv.size()) / 1e6 / parse_s);
+        js.put("bin_load_seconds", bin_s);
+        js.put("bin_rows_per_sec", double(ds2.size()) / bin_s);
+
+        // ---- convert ----
+        std::cout << "[convert]\n";
+        std::vector<size_t> all_rows(ds.size());
+        for (size_t i = 0; i < all_rows.size(); ++i) all_rows[i] = i;
+        std::vector<vec_t> X;
+        std::vector<label_t> Y;
+        t0 = clk::now();
+        to_tiny(ds, all_rows, X, Y);
+        double conv_s = seconds_since(t0);
+        js.section("convert");
+        js.put("to_tiny_seconds", conv_s);
+        js.put("to_tiny_rows_per_sec", double(ds.size()) / conv_s);
+
+        // ---- train ----
+        std::cout << "[train]\n";
+        MlpConfig cfg;
+        cfg.epochs = epochs;
+        if (cfg.dims() != BenchFirmware::dims())
+            throw std::runtime_error("MlpConfig's default topology " + cfg.topology() +
+                                     " differs from BenchFirmware; update the typedef in bench_annie.cpp");
+        js.section("train");
+        js.put_str("topology", cfg.topology());
+        js.put("epochs", epochs);
+
+        MlpParams params = init_mlp(cfg.dims(), cfg.seed);
+        t0 = clk::now();
+        train_mlp(params, ds, all_rows, cfg);
+        js.put("native_1t_seconds_per_epoch", seconds_since(t0) / epochs);
+
+        if (threads > 1) {
+            MlpParams p2 = init_mlp(cfg.dims(), cfg.seed);
+            TrainOptions opts;
+            opts.threads = threads;
+            t0 = clk::now();
+            train_mlp(p2, ds, all_rows, cfg, opts);
+            js.put("native_threads", threads);
+            js.put("native_mt_seconds_per_epoch", seconds_since(t0) / epochs);
+        }
+
+        network<sequential> net;
+        build_tiny_net(net, cfg.dims());
+        adam optimizer;
+        t0 = clk::now();
+        net.train<cross_entropy_multiclass>(optimizer, X, Y, cfg.batch, epochs);
+        js.put("tinydnn_seconds_per_epoch", seconds_since(t0) / epochs);
+
+        // Benchmarks below use the natively trained weights
+        copy_to_tiny(net, params);
+        MlpEngine engine = MlpEngine::from_tiny_dnn(net);
+
+        // ---- predict ----
+        std::cout << "[predict]\n";
+        const size_t nlat = std::min<size_t>(20000, ds.size());
+        std::vector<float> Xflat(ds.size() * NUM_FEATURES);
+        for (size_t i = 0; i < ds.size(); ++i)
+            for (size_t j = 0; j < NUM_FEATURES; ++j) Xflat[i * NUM_FEATURES + j] = ds.at(i, j);
+
+        std::vector<double> lat_tiny(nlat), lat_eng(nlat);
+        std::vector<int> pred_tiny(nlat);
+        size_t sink = 0, tiny_agree = 0;
+        for (size_t i = 0; i < nlat; ++i) {
+            auto s = clk::now();
+            vec_t r = net.predict(X[i]);
+            pred_tiny[i] = int(std::max_element(r.begin(), r.end()) - r.begin());
+            lat_tiny[i] = seconds_since(s) * 1e9;
+        }
+        for (size_t i = 0; i < nlat; ++i) {
+            auto s = clk::now();
+            const int p = engine.predict(&Xflat[i * NUM_FEATURES]);
+            lat_eng[i] = seconds_since(s) * 1e9;
+            tiny_agree += (p == pred_tiny[i]);
+            sink += size_t(p);
+        }
+        js.section("predict");
+        js.put("tinydnn_single_p50_ns", percentile(lat_tiny, 50));
+        js.put("tinydnn_single_p99_ns", percentile(lat_tiny, 99));
+        js.put("engine_single_p50_ns", percentile(lat_eng, 50));
+        js.put("engine_single_p99_ns", percentile(lat_eng, 99));
+        js.put("engine_tinydnn_agreement", nlat ? double(tiny_agree) / double(nlat) : 1.0);
+
+        const size_t batch = 1024;
+        std::vector<int> labels(batch);
+        std::vector<double> lat_batch;
+        t0 = clk::now();
+        for (size_t s = 0; s + batch <= ds.size(); s += batch) {
+            auto b0 = clk::now();
+            engine.predict_batch(&Xflat[s * NUM_FEATURES], batch, labels.data());
+            lat_batch.push_back(seconds_since(b0) * 1e9 / double(batch));
+            sink += size_t(labels[0]);
+        }
+        double batch_s = seconds_since(t0);
+        js.put("engine_batch_size", batch);
+        js.put("engine_batch_p50_ns_per_sample", percentile(lat_batch, 50));
+        js.put("engine_batch_p99_ns_per_sample", percentile(lat_batch, 99));
+        js.put("engine_batch_samples_per_sec", double(lat_batch.size() * batch) / batch_s);
+
+        // ---- firmware kernels on the host ----
+        std::cout << "[firmware]\n";
+        static BenchFirmware fw;
+        static BenchFirmwareCounted fw_counted;
+        fw.load(params);
+        fw_counted.load(params);
+        g_macs = 0;
+        float x0[NUM_FEATURES];
+        for (size_t j = 0; j < NUM_FEATURES; ++j) x0[j] = Xflat[j];
+        if (fw_counted.predict(x0) != fw.predict(x0)) throw std::runtime_error("instrumented firmware kernel disagrees with the plain one");
+        const unsigned long float_macs = g_macs;
+
+        const size_t nfw = std::min<size_t>(20000, ds.size());
+        std::vector<int> fw_pred(nfw);
+        t0 = clk::now();
+        for (size_t i = 0; i < nfw; ++i) {
+            float x[NUM_FEATURES];
+            for (size_t j = 0; j < NUM_FEATURES; ++j) x[j] = Xflat[i * NUM_FEATURES + j];
+            fw_pred[i] = fw.predict(x);
+        }
+        double fw_s = seconds_since(t0);
+        size_t agree = 0;
+        for (size_t i = 0; i < nfw; ++i) agree += (fw_pred[i] == engine.predict(&Xflat[i * NUM_FEATURES]));
+
+        QuantModel qm = quantize_model(engine, Xflat.data(), ds.size());
+        std::vector<int8_t> qbuf;
+        std::vector<int32_t> qlog;
+        t0 = clk::now();
+        for (size_t i = 0; i < nfw; ++i) sink += size_t(qm.predict(&Xflat[i * NUM_FEATURES], qbuf, qlog));
+        double q8_s = seconds_since(t0);
+        size_t q8_macs = 0;
+        for (const auto &L : qm.layers) q8_macs += L.in * L.out;
+
+        js.section("firmware");
+        js.put("float_macs_per_decision", float_macs);
+        js.put("float_flash_bytes", engine.param_count() * sizeof(float));
+        js.put("float_host_ns_per_decision", fw_s * 1e9 / double(nfw));
+        js.put("float_engine_agreement", double(agree) / double(nfw));
+        js.put("int8_macs_per_decision", q8_macs);
+        js.put("int8_flash_bytes", qm.flash_bytes());
+        js.put("int8_host_ns_per_decision", q8_s * 1e9 / double(nfw));
+
+        if (outPath.has_parent_path()) fs::create_directories(outPath.parent_path());
+        std::ofstream out(outPath);
+        out << js.str();
+        std::cout << "Saved benchmark results to: " << outPath.string() << " (checksum " << sink << ")\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "EXCEPTION: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,401 @@
+// training/compile_lattice.cpp
+// Compiles the exported model into a decision lattice for the firmware (firmware/ann_lattice.h):
+// - Evaluates the generated forward pass on every integer-cm input the sketch can produce
+//   (front, left, right in 0..100: 101^3 points), sliced by front distance across a thread pool.
+//   It includes models/arduino_weights.h like robot_ann.ino, so the grid holds the firmware's own
+//   float decisions, not a host re-implementation
+// - The lattice replaces the forward pass, so it is compiled from the float model: the int8 model's
+//   rounding noise would only add exceptions. How often the int8 model disagrees is reported.
+// - Compresses the grid into a decision tree over the model's features in cm (front, left, right,
+//   diff, minLR): greedy Gini splits down to single-action regions, then pruned bottom-up wherever
+//   listing the region's odd points as exceptions takes fewer flash bytes than the subtree
+// - Proves equivalence: the firmware lookup is run on all grid points against the network
+// - Regression check: the previous grid (models/lattice_grid.bin) is diffed against the new one,
+//   so a retrained model reports how many inputs changed action
+// - Writes models/arduino_lattice.h (PROGMEM tree, tagged with the source model's hash) and
+//   models/lattice_report.csv; nothing is written when any grid point disagrees
+//
+// Needs a train_ann export in models/; rebuild after every train_ann run (the model is compiled in).
+// Build: g++ -O2 -std=c++17 -pthread training/compile_lattice.cpp -o training/compile_lattice
+//        cl /EHsc /O2 /std:c++17 training\compile_lattice.cpp /Fe:training\compile_lattice.exe
+// Run:   training/compile_lattice [--threads N] [--max-bytes N] [--out models/arduino_lattice.h]
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "thread_pool.h"
+#include "../models/arduino_weights.h"
+#if __has_include("../models/arduino_weights_q8.h")
+  #include "../models/arduino_weights_q8.h"
+#endif
+#include "../firmware/ann_lattice.h"
+
+static_assert(ANN_IN_DIM == 5 && ANN_OUT_DIM == 4, "model must be 5 -> 4");
+#ifndef ANN_MODEL_FEATURES
+  #error "models/arduino_weights.h predates the input contract (ANN_MODEL_FEATURES missing): re-run train_ann"
+#endif
+static_assert(ANN_MODEL_FEATURES == ANN_FEAT_CONTRACT, "model was trained with another input contract: re-run train_ann");
+#if defined(ANN_Q8_MODEL) && !defined(Q8_IN_MULT)
+  #error "models/arduino_weights_q8.h predates the integer input path (Q8_IN_MULT missing): re-run train_ann"
+#endif
+
+static const size_t GRID = ANN_LATTICE_MAX_CM + 1;
+static const size_t GRID_POINTS = GRID * GRID * GRID;
+static const char *const ACTIONS[4] = {"FORWARD", "LEFT", "RIGHT", "STOP"};
+
+static size_t grid_index(size_t f, size_t l, size_t r) { return (f * GRID + l) * GRID + r; }
+
+
+#ifdef ANN_Q8_MODEL
+// The int8 model's action as robot_ann.ino computes it (Q14 features, integer input requantization)
+static uint8_t q8_action(unsigned f, unsigned l, unsigned r) {
+    int16_t in_q14[ANN_FEAT_COUNT];
+    ann_features_q14(f, l, r, in_q14);
+    int8_t qin[Q8_IN_DIM];
+    for (uint8_t i = 0; i < Q8_IN_DIM; ++i) qin[i] = ann_q8_quantize_q14(in_q14[i], Q8_IN_MULT, Q8_IN_SHIFT);
+    return ann_q8_predict(qin);
+}
+#endif
+
+// Feature k of a grid point in the lattice's units (see ann_lattice_lookup)
+static uint8_t point_feature(uint32_t i, int k) {
+    const uint8_t r = uint8_t(i % GRID), l = uint8_t(i / GRID % GRID), f = uint8_t(i / (GRID * GRID));
+    switch (k) {
+        case 0: return f;
+        case 1: return l;
+        case 2: return r;
+        case 3: return uint8_t(ANN_LATTICE_MAX_CM + l - r);
+        default: return l < r ? l : r;
+    }
+}
+
+// Cost of a region in flash: a leaf byte plus one exception entry per point that disagrees with it
+static const size_t LEAF_BYTES = 1, SPLIT_BYTES = 4, EXCEPTION_BYTES = 2;
+
+struct LatticeNode {
+    uint8_t feature = 0, threshold = 0;
+    int left = -1, right = -1;    // -1 = leaf
+    std::array<size_t, 4> cls{};  // grid points per action in this region
+    uint8_t majority() const { return uint8_t(std::max_element(cls.begin(), cls.end()) - cls.begin()); }
+};
+
+struct LatticeBuild {
+    const std::vector<uint8_t> &grid;
+    std::vector<LatticeNode> nodes;
+    std::vector<uint8_t> bytes;         // serialized tree
+    std::vector<uint16_t> exc_start;    // per front distance: first exception entry (GRID + 1 entries)
+    std::vector<uint16_t> exceptions;   // (left * GRID + right) << 2 | action, sorted within each bucket
+    size_t splits = 0, leaves = 0, n_exceptions = 0, max_depth = 0;
+
+    explicit LatticeBuild(const std::vector<uint8_t> &g) : grid(g) {}
+
+    // Exact tree for pts[lo, hi): split until every region holds a single action
+    int build(std::vector<uint32_t> &pts, size_t lo, size_t hi) {
+        const int id = int(nodes.size());
+        nodes.emplace_back();
+        const size_t n = hi - lo;
+        std::array<size_t, 4> cls = {};
+        for (size_t i = lo; i < hi; ++i) ++cls[grid[pts[i]]];
+        nodes[id].cls = cls;
+        if (*std::max_element(cls.begin(), cls.end()) == n) return id;
+
+        // Per-feature histograms of actions over feature values (diff spans 0..200)
+        static const size_t VALUES = 2 * ANN_LATTICE_MAX_CM + 1;
+        std::vector<std::array<size_t, 4>> hist(ANN_LATTICE_FEATURES * VALUES);
+        for (size_t i = lo; i < hi; ++i)
+            for (int k = 0; k < ANN_LATTICE_FEATURES; ++k) ++hist[k * VALUES + point_feature(pts[i], k)][grid[pts[i]]];
+
+        // Split maximizing sum(c^2)/n over both sides (minimum weighted Gini impurity)
+        double best = -1.0;
+        int best_k = -1;
+        size_t best_t = 0;
+        for (int k = 0; k < ANN_LATTICE_FEATURES; ++k) {
+            std::array<size_t, 4> left = {};
+            size_t nl = 0;
+            for (size_t t = 0; t + 1 < VALUES; ++t) {
+                const auto &h = hist[k * VALUES + t];
+                for (int a = 0; a < 4; ++a) left[a] += h[a], nl += h[a];
+                if (nl == 0 || nl == n) continue;
+                double sl = 0.0, sr = 0.0;
+                for (int a = 0; a < 4; ++a) {
+                    sl += double(left[a]) * double(left[a]);
+                    sr += double(cls[a] - left[a]) * double(cls[a] - left[a]);
+                }
+                const double score = sl / double(nl) + sr / double(n - nl);
+                if (score > best) { best = score; best_k = k; best_t = t; }
+            }
+        }
+        if (best_k < 0) throw std::runtime_error("lattice: mixed actions on identical features");
+
+        const size_t mid = size_t(std::partition(pts.begin() + lo, pts.begin() + hi,
+                                                 [&](uint32_t p) { return point_feature(p, best_k) <= best_t; }) - pts.begin());
+        nodes[id].feature = uint8_t(best_k);
+        nodes[id].threshold = uint8_t(best_t);
+        const int l = build(pts, lo, mid);
+        const int r = build(pts, mid, hi);
+        nodes[id].left = l;
+        nodes[id].right = r;
+        return id;
+    }
+
+    // Bottom-up: collapse a subtree into a leaf whenever its disagreeing points cost fewer bytes as exceptions
+    size_t prune(int id) {
+        LatticeNode &nd = nodes[id];
+        size_t n = 0;
+        for (size_t c : nd.cls) n += c;
+        const size_t as_leaf = LEAF_BYTES + EXCEPTION_BYTES * (n - nd.cls[nd.majority()]);
+        if (nd.left < 0) return as_leaf;
+        const size_t as_split = SPLIT_BYTES + prune(nd.left) + prune(nd.right);
+        if (as_leaf <= as_split) {
+            nd.left = nd.right = -1;
+            return as_leaf;
+        }
+        return as_split;
+    }
+
+    void serialize(int id, size_t depth) {
+        const LatticeNode &nd = nodes[id];
+        if (nd.left < 0) {
+            bytes.push_back(uint8_t(ANN_LATTICE_LEAF | nd.majority()));
+            ++leaves;
+            max_depth = std::max(max_depth, depth);
+            return;
+        }
+        const size_t at = bytes.size();
+        bytes.insert(bytes.end(), {nd.feature, nd.threshold, 0, 0});
+        ++splits;
+        serialize(nd.left, depth + 1);
+        if (bytes.size() > 0xFFFF) throw std::runtime_error("lattice: tree exceeds 64 KB offsets");
+        bytes[at + 2] = uint8_t(bytes.size());
+        bytes[at + 3] = uint8_t(bytes.size() >> 8);
+        serialize(nd.right, depth + 1);
+    }
+
+    // Build, prune, serialize the tree, then list the grid points it gets wrong (ascending index)
+    void compile() {
+        std::vector<uint32_t> pts(grid.size());
+        for (size_t i = 0; i < pts.size(); ++i) pts[i] = uint32_t(i);
+        build(pts, 0, pts.size());
+        prune(0);
+        serialize(0, 0);
+        exc_start.assign(GRID + 1, 0);
+        for (size_t f = 0; f < GRID; ++f) {
+            exc_start[f] = uint16_t(exceptions.size());
+            for (size_t lr = 0; lr < GRID * GRID; ++lr) {
+                const uint8_t a = grid[f * GRID * GRID + lr];
+                if (ann_lattice_lookup(bytes.data(), exc_start.data(), exceptions.data(), uint8_t(f), uint8_t(lr / GRID),
+                                       uint8_t(lr % GRID)) == a)
+                    continue;
+                if (exceptions.size() == 0xFFFF) throw std::runtime_error("lattice: more than 65535 exceptions");
+                exceptions.push_back(uint16_t(lr << 2 | a));
+            }
+        }
+        exc_start[GRID] = uint16_t(exceptions.size());
+        n_exceptions = exceptions.size();
+    }
+
+    size_t exception_bytes() const { return 2 * (exc_start.size() + exceptions.size()); }
+    size_t flash_bytes() const { return bytes.size() + exception_bytes(); }
+    uint8_t lookup(uint8_t f, uint8_t l, uint8_t r) const {
+        return ann_lattice_lookup(bytes.data(), exc_start.data(), exceptions.data(), f, l, r);
+    }
+};
+
+static void write_lattice_header(const std::string &path, const LatticeBuild &lb, uint32_t source_hash) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+    out << "// Auto-generated decision lattice from compile_lattice.cpp\n";
+    out << "// Source: models/arduino_weights.h, equal to its ann_predict() on all " << GRID_POINTS << " integer-cm inputs\n";
+    out << "// " << lb.splits << " splits, " << lb.leaves << " leaves (depth <= " << lb.max_depth << "), " << lb.n_exceptions
+        << " exceptions, " << lb.flash_bytes() << " bytes in flash\n";
+    out << "#ifndef ANN_LATTICE_MODEL_H\n#define ANN_LATTICE_MODEL_H\n\n";
+    out << "#include \"../firmware/ann_lattice.h\"\n\n";
+    out << "#define ANN_LATTICE 1\n";
+    out << "#define ANN_LATTICE_SOURCE_HASH 0x" << std::hex << std::setw(8) << std::setfill('0') << source_hash << "u\n"
+        << std::dec << std::setfill(' ');
+    out << "\n";
+    auto table = [&](const char *type, const char *name, const auto &v) {
+        out << "const " << type << " " << name << "[" << std::max<size_t>(v.size(), 1) << "] ANN_PROGMEM = {";
+        for (size_t i = 0; i < v.size(); ++i) out << (i % 16 == 0 ? "\n  " : " ") << unsigned(v[i]) << ",";
+        out << (v.empty() ? " 0" : "") << "\n};\n";
+    };
+    table("uint8_t", "ANN_LATTICE_TREE", lb.bytes);
+    table("uint16_t", "ANN_LATTICE_EXC_START", lb.exc_start);
+    table("uint16_t", "ANN_LATTICE_EXC", lb.exceptions);
+    out << "\n// Distances in cm (999 = no echo) -> action, as the network would choose\n";
+    out << "static inline uint8_t ann_lattice_predict(unsigned int front, unsigned int left, unsigned int right) {\n";
+    out << "  return ann_lattice_lookup(ANN_LATTICE_TREE, ANN_LATTICE_EXC_START, ANN_LATTICE_EXC,\n";
+    out << "                            ann_lattice_cm(front), ann_lattice_cm(left), ann_lattice_cm(right));\n";
+    out << "}\n\n#endif // ANN_LATTICE_MODEL_H\n";
+}
+
+int main(int argc, char **argv) {
+    try {
+        size_t threads = 0, max_bytes = 0;
+        std::string outPath = "models/arduino_lattice.h", reportPath = "models/lattice_report.csv",
+                    gridPath = "models/lattice_grid.bin";
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+                return argv[++i];
+            };
+            if (a == "--threads") threads = std::stoul(next());
+            else if (a == "--max-bytes") max_bytes = std::stoul(next());
+            else if (a == "--out") outPath = next();
+            else {
+                std::cerr << "Usage: compile_lattice [--threads N] [--max-bytes N] [--out models/arduino_lattice.h]\n";
+                return 1;
+            }
+        }
+        const uint32_t source_hash = ANN_MODEL_HASH;
+        ThreadPool pool(threads);
+
+        // 1. Network on every grid point, one task per front distance
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<uint8_t> grid(GRID_POINTS);
+        std::atomic<size_t> q8_disagree{0};
+        for (size_t f = 0; f < GRID; ++f) {
+            pool.submit([&, f] {
+                size_t disagree = 0;
+                float in[ANN_IN_DIM];
+                for (size_t l = 0; l < GRID; ++l)
+                    for (size_t r = 0; r < GRID; ++r) {
+                        ann_features(unsigned(f), unsigned(l), unsigned(r), in);
+                        const uint8_t a = ann_predict(in);
+                        grid[grid_index(f, l, r)] = a;
+#ifdef ANN_Q8_MODEL
+                        disagree += q8_action(unsigned(f), unsigned(l), unsigned(r)) != a;
+#endif
+                    }
+                q8_disagree += disagree;
+            });
+        }
+        pool.wait_idle();
+        const double eval_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::array<size_t, 4> counts = {};
+        for (uint8_t a : grid) {
+            if (a > 3) throw std::runtime_error("network returned action " + std::to_string(a));
+            ++counts[a];
+        }
+        std::cout << "Evaluated " << GRID_POINTS << " grid points in " << std::fixed << std::setprecision(2) << eval_s << " s:";
+        for (int a = 0; a < 4; ++a) std::cout << " " << ACTIONS[a] << "=" << counts[a];
+        std::cout << "\n";
+#ifdef ANN_Q8_MODEL
+        std::cout << "int8 model (arduino_weights_q8.h) differs on " << q8_disagree << " grid points\n";
+#endif
+
+        // 2. Tree + exceptions
+        t0 = std::chrono::steady_clock::now();
+        LatticeBuild lb(grid);
+        lb.compile();
+        const double build_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "Lattice: " << lb.splits << " splits, " << lb.leaves << " leaves (" << lb.bytes.size() << " bytes, depth <= "
+                  << lb.max_depth << "), " << lb.n_exceptions << " exceptions (" << lb.exception_bytes() << " bytes); "
+                  << lb.flash_bytes() << " bytes in flash, built in " << build_s << " s\n";
+
+        // 3. Equivalence on every grid point through the firmware lookup
+        std::atomic<size_t> mismatches{0};
+        for (size_t f = 0; f < GRID; ++f) {
+            pool.submit([&, f] {
+                size_t bad = 0;
+                for (size_t l = 0; l < GRID; ++l)
+                    for (size_t r = 0; r < GRID; ++r)
+                        bad += lb.lookup(uint8_t(f), uint8_t(l), uint8_t(r)) != grid[grid_index(f, l, r)];
+                mismatches += bad;
+            });
+        }
+        pool.wait_idle();
+        // Out-of-range readings clamp onto the grid's far face, like taskInference
+        const unsigned int probes[] = {101, 250, 999};
+        for (unsigned int d : probes)
+            mismatches += lb.lookup(ann_lattice_cm(d), ann_lattice_cm(d), ann_lattice_cm(7)) !=
+                          grid[grid_index(GRID - 1, GRID - 1, 7)];
+        std::cout << "Equivalence: " << mismatches << " mismatches on " << GRID_POINTS << " grid points\n";
+        if (mismatches != 0) {
+            std::cerr << "Lattice is not equivalent to the network; nothing written\n";
+            return 1;
+        }
+
+        // Host cost per decision: lookup vs forward pass
+        auto time_ns = [&](auto &&fn) {
+            const size_t n = 200000;
+            volatile uint32_t sink = 0;
+            uint32_t s = 12345;
+            auto ts = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                s = s * 1664525u + 1013904223u;
+                sink = sink + fn(uint8_t((s >> 8) % GRID), uint8_t((s >> 16) % GRID), uint8_t((s >> 24) % GRID));
+            }
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - ts).count() / double(n);
+            return ns;
+        };
+        const double lookup_ns = time_ns([&](uint8_t f, uint8_t l, uint8_t r) { return lb.lookup(f, l, r); });
+        const double net_ns = time_ns([&](uint8_t f, uint8_t l, uint8_t r) {
+            float in[ANN_IN_DIM];
+            ann_features(f, l, r, in);
+            return ann_predict(in);
+        });
+        std::cout << "Host ns per decision: lattice " << std::setprecision(1) << lookup_ns << ", network " << net_ns << "\n";
+
+        // Regression check against the previous compile
+        size_t changed = 0;
+        bool have_prev = false;
+        std::array<std::array<size_t, 4>, 4> transitions = {};
+        {
+            std::ifstream prev(gridPath, std::ios::binary);
+            std::vector<uint8_t> old(GRID_POINTS);
+            if (prev.read(reinterpret_cast<char *>(old.data()), std::streamsize(old.size())) && prev.peek() == EOF) {
+                have_prev = true;
+                for (size_t i = 0; i < GRID_POINTS; ++i)
+                    if (old[i] < 4 && old[i] != grid[i]) { ++changed; ++transitions[old[i]][grid[i]]; }
+            }
+        }
+        if (have_prev) {
+            std::cout << "Since the previous lattice: " << changed << " grid points changed action";
+            for (int a = 0; a < 4; ++a)
+                for (int b = 0; b < 4; ++b)
+                    if (transitions[a][b]) std::cout << ", " << ACTIONS[a] << "->" << ACTIONS[b] << " " << transitions[a][b];
+            std::cout << "\n";
+        }
+
+        if (max_bytes && lb.flash_bytes() > max_bytes) {
+            std::cerr << "Lattice is " << lb.flash_bytes() << " bytes, over --max-bytes " << max_bytes << "; nothing written\n";
+            return 1;
+        }
+        write_lattice_header(outPath, lb, source_hash);
+        {
+            std::ofstream g(gridPath, std::ios::binary);
+            if (!g.is_open()) throw std::runtime_error("Cannot write " + gridPath);
+            g.write(reinterpret_cast<const char *>(grid.data()), std::streamsize(grid.size()));
+        }
+        std::ofstream rep(reportPath);
+        if (!rep.is_open()) throw std::runtime_error("Cannot write " + reportPath);
+        rep << "metric,value\n";
+        rep << "source_hash,0x" << std::hex << std::setw(8) << std::setfill('0') << source_hash << std::dec << std::setfill(' ') << "\n";
+        rep << "grid_points," << GRID_POINTS << "\n";
+        for (int a = 0; a < 4; ++a) rep << "points_" << ACTIONS[a] << "," << counts[a] << "\n";
+        rep << "mismatches," << mismatches << "\n";
+#ifdef ANN_Q8_MODEL
+        rep << "int8_disagreements," << q8_disagree << "\n";
+#endif
+        rep << "splits," << lb.splits << "\nleaves," << lb.leaves << "\nmax_depth," << lb.max_depth << "\n";
+        rep << "exceptions," << lb.n_exceptions << "\n";
+        rep << "tree_bytes," << lb.bytes.size() << "\nexception_bytes," << lb.exception_bytes() << "\nflash_bytes," << lb.flash_bytes() << "\n";
+        rep << "host_lookup_ns," << lookup_ns << "\nhost_network_ns," << net_ns << "\n";
+        rep << "changed_since_previous," << (have_prev ? std::to_string(changed) : std::string("")) << "\n";
+        std::cout << "Saved " << outPath << ", " << reportPath << " and " << gridPath << "\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "Exception: " << ex.what() << std::endl;
+        return 1;
+    }
+}
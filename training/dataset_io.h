@@ -0,0 +1,419 @@
+// training/dataset_io.h
+// Fast dataset loading for ANNie (CSV: front,left,right,diff,minLR,action)
+// - The CSV is memory-mapped and parsed in place with std::from_chars (no getline/stringstream/strings)
+// - Raw cm values are parsed straight into a flat structure-of-arrays buffer, then the input contract
+//   (firmware/ann_features.h, shared with the simulators and the firmware) runs as one vectorized pass
+//   over whole columns: front/left/right clamped to the range (999 = no echo -> max), diff and minLR
+//   recomputed from the clamped distances (the CSV's own columns are only validated), all scaled
+// - A binary cache (<csv>.annb: header, normalization constants, float32 columns, int8 labels)
+//   is written next to the CSV; later runs map it and copy the columns in one pass.
+//   The cache is rebuilt when the CSV size/mtime, the normalization constants or the contract change.
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#endif
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "../firmware/ann_features.h"
+
+static const size_t NUM_FEATURES = ANN_FEAT_COUNT;
+static const float INPUT_RANGE_CM = float(ANN_FEAT_RANGE_CM);
+
+// Feature ranges of the contract, recorded in binary datasets: x_norm = clamp(x, lo, hi) / scale
+struct FeatureNorm {
+    float lo, hi, scale;
+};
+
+static inline std::array<FeatureNorm, NUM_FEATURES> default_feature_norm() {
+    const float R = INPUT_RANGE_CM;
+    return {{ {0.0f, R, R},    // front  0..1
+              {0.0f, R, R},    // left   0..1
+              {0.0f, R, R},    // right  0..1
+              {-R, R, R},      // diff  -1..1
+              {0.0f, R, R} }}; // minLR  0..1
+}
+
+// The input contract over whole columns, in place: raw cm in front/left/right, features out in all five.
+// Same operations as ann_features_cm() (clamp, subtract, min, divide), so the results are bit-identical.
+static inline void apply_feature_contract(float *front, float *left, float *right, float *diff, float *minlr, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 lo = _mm256_setzero_ps(), range = _mm256_set1_ps(INPUT_RANGE_CM);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 f = _mm256_min_ps(range, _mm256_max_ps(lo, _mm256_loadu_ps(front + i)));
+        const __m256 l = _mm256_min_ps(range, _mm256_max_ps(lo, _mm256_loadu_ps(left + i)));
+        const __m256 r = _mm256_min_ps(range, _mm256_max_ps(lo, _mm256_loadu_ps(right + i)));
+        _mm256_storeu_ps(front + i, _mm256_div_ps(f, range));
+        _mm256_storeu_ps(left + i, _mm256_div_ps(l, range));
+        _mm256_storeu_ps(right + i, _mm256_div_ps(r, range));
+        _mm256_storeu_ps(diff + i, _mm256_div_ps(_mm256_sub_ps(l, r), range));
+        _mm256_storeu_ps(minlr + i, _mm256_div_ps(_mm256_min_ps(l, r), range));
+    }
+#endif
+    for (; i < n; ++i) {
+        float out[ANN_FEAT_COUNT];
+        ann_features_cm(ann_feat_clamp_cmf(front[i]), ann_feat_clamp_cmf(left[i]), ann_feat_clamp_cmf(right[i]), out);
+        front[i] = out[ANN_FEAT_FRONT];
+        left[i] = out[ANN_FEAT_LEFT];
+        right[i] = out[ANN_FEAT_RIGHT];
+        diff[i] = out[ANN_FEAT_DIFF];
+        minlr[i] = out[ANN_FEAT_MINLR];
+    }
+}
+
+// Column-major dataset: feature j of row i is x[j*n + i]
+struct Dataset {
+    size_t n = 0;
+    std::vector<float> x;
+    std::vector<int8_t> y;
+    std::array<FeatureNorm, NUM_FEATURES> norm = default_feature_norm();
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    const float *col(size_t j) const { return x.data() + j * n; }
+    float *col(size_t j) { return x.data() + j * n; }
+    float at(size_t i, size_t j) const { return x[j * n + i]; }
+};
+
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path) {
+        close();
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file_, &sz)) { close(); return false; }
+        size_ = static_cast<size_t>(sz.QuadPart);
+        if (size_ == 0) return true;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) { close(); return false; }
+        data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) { close(); return false; }
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (fstat(fd_, &st) != 0) { close(); return false; }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) return true;
+        void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(p);
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<char *>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool is_open() const {
+#if defined(_WIN32)
+        return file_ != INVALID_HANDLE_VALUE;
+#else
+        return fd_ >= 0;
+#endif
+    }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// ---- CSV parsing ----
+
+// Parse one numeric field ending at ',' or end of line; p is advanced past the separator.
+// from_chars accepts "nan"/"inf": non-finite values are rejected like malformed ones
+template <class T>
+static inline bool parse_field(const char *&p, const char *eol, T &out) {
+    while (p < eol && (*p == ' ' || *p == '\t')) ++p;
+    if (p < eol && *p == '+') ++p;
+    auto res = std::from_chars(p, eol, out);
+    if (res.ec != std::errc()) return false;
+    if constexpr (std::is_floating_point<T>::value) {
+        if (!std::isfinite(out)) return false;
+    }
+    p = res.ptr;
+    while (p < eol && (*p == ' ' || *p == '\t')) ++p;
+    if (p == eol) return true;
+    if (*p != ',') return false;
+    ++p;
+    return true;
+}
+
+// Parse CSV text (header line first) into ds, then apply the input contract to the columns
+static inline void parse_dataset_csv(const char *data, size_t size, Dataset &ds, size_t &skipped, bool verbose = true) {
+    const char *p = data, *end = data + size;
+    // Header
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+    if (!eol) eol = end;
+    if (verbose) std::cout << "CSV header: " << std::string(p, (eol > p && eol[-1] == '\r') ? eol - 1 : eol) << std::endl;
+    p = (eol < end) ? eol + 1 : end;
+
+    // Upper bound on rows so columns are allocated once
+    size_t cap = 0;
+    for (const char *q = p; q < end; ++cap) {
+        const char *nl = static_cast<const char *>(std::memchr(q, '\n', size_t(end - q)));
+        q = nl ? nl + 1 : end;
+    }
+    ds.x.assign(NUM_FEATURES * cap, 0.0f);
+    ds.y.assign(cap, 0);
+
+    const size_t max_reports = 10;
+    size_t lineno = 1, n = 0;
+    skipped = 0;
+    while (p < end) {
+        ++lineno;
+        eol = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+        if (!eol) eol = end;
+        const char *line = p, *lend = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+        p = (eol < end) ? eol + 1 : end;
+        if (lend == line) { ++skipped; continue; }
+
+        float v[NUM_FEATURES];
+        int a = -1;
+        const char *q = line;
+        bool ok = true;
+        for (size_t j = 0; j < NUM_FEATURES && ok; ++j) ok = parse_field(q, lend, v[j]) && q < lend;
+        // Extra columns after the label are ignored
+        if (ok) {
+            while (q < lend && (*q == ' ' || *q == '\t' || *q == '+')) ++q;
+            auto res = std::from_chars(q, lend, a);
+            const char *r = res.ptr;
+            while (r < lend && (*r == ' ' || *r == '\t')) ++r;
+            ok = res.ec == std::errc() && (r == lend || *r == ',') && a >= 0 && a < 4;
+        }
+        if (!ok) {
+            if (verbose && skipped < max_reports)
+                std::cerr << "Skipping line " << lineno << " (parse error): " << std::string(line, lend) << std::endl;
+            ++skipped;
+            continue;
+        }
+        for (size_t j = 0; j < NUM_FEATURES; ++j) ds.x[j * cap + n] = v[j];
+        ds.y[n] = static_cast<int8_t>(a);
+        ++n;
+    }
+    if (verbose && skipped > max_reports) std::cerr << "... " << (skipped - max_reports) << " more malformed/empty lines\n";
+
+    // Compact columns from stride cap to stride n
+    if (n < cap)
+        for (size_t j = 1; j < NUM_FEATURES; ++j) std::memmove(&ds.x[j * n], &ds.x[j * cap], n * sizeof(float));
+    ds.x.resize(NUM_FEATURES * n);
+    ds.y.resize(n);
+    ds.n = n;
+    apply_feature_contract(ds.col(ANN_FEAT_FRONT), ds.col(ANN_FEAT_LEFT), ds.col(ANN_FEAT_RIGHT), ds.col(ANN_FEAT_DIFF),
+                           ds.col(ANN_FEAT_MINLR), n);
+}
+
+// ---- Binary cache ----
+// Layout (little endian):
+//   DatasetBinHeader
+//   float32 column 0 [n] ... float32 column NUM_FEATURES-1 [n]
+//   int8 labels [n]
+
+struct DatasetBinHeader {
+    char magic[4];            // "ANNB"
+    uint32_t version;
+    uint64_t rows;
+    uint32_t features;
+    uint32_t contract;        // ANN_FEAT_CONTRACT the features were computed with
+    uint64_t source_size;     // CSV size the cache was built from (0 = not a cache)
+    int64_t source_mtime;
+    FeatureNorm norm[NUM_FEATURES];
+};
+
+static const uint32_t DATASET_BIN_VERSION = 1;
+
+static inline DatasetBinHeader make_bin_header(uint64_t rows, const std::array<FeatureNorm, NUM_FEATURES> &norm,
+                                               uint64_t source_size = 0, int64_t source_mtime = 0) {
+    DatasetBinHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "ANNB", 4);
+    h.version = DATASET_BIN_VERSION;
+    h.rows = rows;
+    h.features = NUM_FEATURES;
+    h.contract = ANN_FEAT_CONTRACT;
+    h.source_size = source_size;
+    h.source_mtime = source_mtime;
+    for (size_t j = 0; j < NUM_FEATURES; ++j) h.norm[j] = norm[j];
+    return h;
+}
+
+static inline size_t bin_column_offset(uint64_t rows, size_t j) { return sizeof(DatasetBinHeader) + j * rows * sizeof(float); }
+static inline size_t bin_label_offset(uint64_t rows) { return bin_column_offset(rows, NUM_FEATURES); }
+
+static inline bool write_dataset_bin(const std::string &path, const Dataset &ds, uint64_t source_size = 0, int64_t source_mtime = 0) {
+    const std::string tmp = path + ".tmp";
+    FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    DatasetBinHeader h = make_bin_header(ds.n, ds.norm, source_size, source_mtime);
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    if (ds.n) {
+        ok = ok && std::fwrite(ds.x.data(), sizeof(float), ds.x.size(), f) == ds.x.size();
+        ok = ok && std::fwrite(ds.y.data(), 1, ds.y.size(), f) == ds.y.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    std::error_code ec;
+    if (ok) std::filesystem::rename(tmp, path, ec);
+    if (!ok || ec) { std::filesystem::remove(tmp, ec); return false; }
+    return true;
+}
+
+// Load a binary dataset. If expect_size/expect_mtime are non-zero the file must be a cache of that CSV.
+static inline bool read_dataset_bin(const std::string &path, Dataset &ds, uint64_t expect_size = 0, int64_t expect_mtime = 0,
+                                    const std::array<FeatureNorm, NUM_FEATURES> *expect_norm = nullptr) {
+    MappedFile mf;
+    if (!mf.open(path) || mf.size() < sizeof(DatasetBinHeader)) return false;
+    DatasetBinHeader h;
+    std::memcpy(&h, mf.data(), sizeof(h));
+    if (std::memcmp(h.magic, "ANNB", 4) != 0 || h.version != DATASET_BIN_VERSION || h.features != NUM_FEATURES) return false;
+    if (h.contract != ANN_FEAT_CONTRACT) return false;
+    if (mf.size() != bin_label_offset(h.rows) + h.rows) return false;
+    if (expect_size && (h.source_size != expect_size || h.source_mtime != expect_mtime)) return false;
+    if (expect_norm && std::memcmp(h.norm, expect_norm->data(), sizeof(h.norm)) != 0) return false;
+
+    ds.n = static_cast<size_t>(h.rows);
+    for (size_t j = 0; j < NUM_FEATURES; ++j) ds.norm[j] = h.norm[j];
+    ds.x.resize(NUM_FEATURES * ds.n);
+    ds.y.resize(ds.n);
+    if (ds.n) {
+        std::memcpy(ds.x.data(), mf.data() + bin_column_offset(h.rows, 0), ds.x.size() * sizeof(float));
+        std::memcpy(ds.y.data(), mf.data() + bin_label_offset(h.rows), ds.n);
+    }
+    return true;
+}
+
+static inline int64_t file_mtime_ticks(const std::filesystem::path &p) {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(p, ec);
+    return ec ? 0 : static_cast<int64_t>(t.time_since_epoch().count());
+}
+
+static inline std::string dataset_cache_path(const std::string &csv_path) { return csv_path + ".annb"; }
+
+// Load path as a dataset: binary (.annb) directly, CSV through the cache when possible.
+static inline Dataset load_dataset(const std::string &path, bool use_cache = true) {
+    Dataset ds;
+    namespace fs = std::filesystem;
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+
+    if (fs::path(path).extension() == ".annb") {
+        if (!read_dataset_bin(path, ds)) std::cerr << "ERROR: Cannot read binary dataset (corrupt, or written for another input contract): " << path << std::endl;
+        else std::cout << "Loaded " << ds.size() << " samples from binary dataset in " << elapsed() << " s\n";
+        return ds;
+    }
+
+    std::error_code ec;
+    const uint64_t csv_size = fs::file_size(path, ec);
+    if (ec) {
+        std::cerr << "ERROR: Cannot open dataset file: " << path << std::endl;
+        return {};
+    }
+    const int64_t csv_mtime = file_mtime_ticks(path);
+    const std::string cache = dataset_cache_path(path);
+    const auto norm = default_feature_norm();
+
+    if (use_cache && read_dataset_bin(cache, ds, csv_size, csv_mtime, &norm)) {
+        std::cout << "Loaded " << ds.size() << " samples from cache " << cache << " in " << elapsed() << " s\n";
+        return ds;
+    }
+
+    MappedFile mf;
+    if (!mf.open(path)) {
+        std::cerr << "ERROR: Cannot open dataset file: " << path << std::endl;
+        return {};
+    }
+    if (mf.size() == 0) {
+        std::cerr << "ERROR: Dataset appears empty: " << path << std::endl;
+        return {};
+    }
+    size_t skipped = 0;
+    parse_dataset_csv(mf.data(), mf.size(), ds, skipped);
+    std::cout << "Loaded " << ds.size() << " valid samples, skipped " << skipped << " malformed/empty lines in "
+              << elapsed() << " s.\n";
+
+    if (use_cache && !ds.empty()) {
+        if (write_dataset_bin(cache, ds, csv_size, csv_mtime)) std::cout << "Wrote dataset cache: " << cache << "\n";
+        else std::cerr << "WARNING: could not write dataset cache " << cache << "\n";
+    }
+    return ds;
+}
+
+// Append src's rows to dst (both column-major, same normalization)
+static inline void append_dataset(Dataset &dst, const Dataset &src) {
+    if (src.empty()) return;
+    if (dst.empty()) { dst = src; return; }
+    for (size_t j = 0; j < NUM_FEATURES; ++j)
+        if (dst.norm[j].lo != src.norm[j].lo || dst.norm[j].hi != src.norm[j].hi || dst.norm[j].scale != src.norm[j].scale)
+            throw std::runtime_error("append_dataset: feature normalization differs");
+    const size_t n = dst.n + src.n;
+    std::vector<float> x(NUM_FEATURES * n);
+    for (size_t j = 0; j < NUM_FEATURES; ++j) {
+        std::copy(dst.col(j), dst.col(j) + dst.n, x.begin() + j * n);
+        std::copy(src.col(j), src.col(j) + src.n, x.begin() + j * n + dst.n);
+    }
+    dst.x.swap(x);
+    dst.y.insert(dst.y.end(), src.y.begin(), src.y.end());
+    dst.n = n;
+}
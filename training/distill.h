@@ -0,0 +1,281 @@
+// training/distill.h
+// Compression stage after training (train_ann --compress): shrink the teacher network to fit the
+// Uno's flash/SRAM and decision-time budget.
+// - Distillation: each student topology (e.g. 5-16-4, 5-8-4) trains on a mix of the labels and the
+//   teacher's outputs softened at temperature T (TrainOptions::soft_targets in mlp_trainer.h)
+// - Structured pruning: the hidden neurons with the smallest weight norm (incoming + bias +
+//   outgoing) are removed from the widest hidden layer, and the smaller network is fine-tuned with
+//   distillation again; this repeats while validation accuracy stays within the budget
+// - Every candidate is measured on the test split: accuracy, drop vs the teacher, argmax agreement
+//   with the teacher, parameter bytes (float and int8) and MACs per inference
+// - Students are independent tasks on the work-stealing pool
+// - The smallest candidate (float bytes, then MACs) whose validation accuracy is within max_drop
+//   of the teacher's is picked for export; selection never looks at the test split
+
+#pragma once
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mlp_trainer.h"
+#include "quantize.h"
+#include "thread_pool.h"
+
+struct DistillConfig {
+    std::vector<std::vector<size_t>> students = {{32, 16}, {16}, {8}};
+    float temperature = 4.0f;
+    float alpha = 0.7f;        // share of the loss taken by the teacher's soft targets
+    int epochs = 150;          // distillation epochs per student
+    int finetune_epochs = 40;  // after each pruning step
+    int patience = 20;         // early stopping on validation accuracy (0 = off)
+    float prune_step = 0.25f;  // fraction of the widest hidden layer removed per step
+    size_t min_width = 2;
+    float max_drop = 0.01f;    // accuracy budget vs the teacher (absolute, 0.01 = 1 point)
+    float lr = 3e-3f;
+    size_t batch = 32;
+    uint32_t seed = 99;
+};
+
+struct CompressCandidate {
+    std::string name;          // topology, plus the student it was pruned from
+    MlpParams params;
+    double val_acc = 0.0, test_acc = 0.0, agreement = 0.0;
+    size_t float_bytes = 0, int8_bytes = 0, macs = 0;
+    bool within_budget = false;
+};
+
+static inline size_t mlp_macs(const std::vector<size_t> &dims) {
+    size_t n = 0;
+    for (size_t l = 0; l + 1 < dims.size(); ++l) n += dims[l] * dims[l + 1];
+    return n;
+}
+
+static inline std::string dims_topology(const std::vector<size_t> &dims) {
+    std::string s;
+    for (size_t i = 0; i < dims.size(); ++i) s += (i ? "-" : "") + std::to_string(dims[i]);
+    return s;
+}
+
+// Teacher probabilities at temperature T for every dataset row (row-major, NUM_CLASSES per row)
+static inline std::vector<float> teacher_soft_targets(MlpEngine &teacher, const Dataset &ds, float T) {
+    const size_t n = ds.size(), chunk = 4096;
+    std::vector<float> soft(n * NUM_CLASSES);
+    std::vector<float> X(chunk * NUM_FEATURES), logits(chunk * NUM_CLASSES);
+    std::vector<int> pred(chunk);
+    for (size_t s = 0; s < n; s += chunk) {
+        const size_t m = std::min(chunk, n - s);
+        for (size_t k = 0; k < m; ++k)
+            for (size_t j = 0; j < NUM_FEATURES; ++j) X[k * NUM_FEATURES + j] = ds.at(s + k, j);
+        teacher.predict_batch(X.data(), m, pred.data(), logits.data());
+        for (size_t k = 0; k < m; ++k) {
+            const float *z = &logits[k * NUM_CLASSES];
+            const float zmax = *std::max_element(z, z + NUM_CLASSES);
+            float sum = 0.0f;
+            for (size_t c = 0; c < NUM_CLASSES; ++c) sum += std::exp((z[c] - zmax) / T);
+            for (size_t c = 0; c < NUM_CLASSES; ++c) soft[(s + k) * NUM_CLASSES + c] = std::exp((z[c] - zmax) / T) / sum;
+        }
+    }
+    return soft;
+}
+
+// Remove hidden neurons of hidden layer h (output of layer h) down to keep, dropping the ones
+// with the smallest squared norm of incoming weights, bias and outgoing weights
+static inline MlpParams prune_hidden(const MlpParams &p, size_t h, size_t keep) {
+    if (h + 1 >= p.layers()) throw std::runtime_error("prune_hidden: layer " + std::to_string(h) + " is not hidden");
+    const size_t in = p.dims[h], width = p.dims[h + 1], next_out = p.dims[h + 2];
+    keep = std::min(keep, width);
+    std::vector<std::pair<float, size_t>> score(width);
+    for (size_t o = 0; o < width; ++o) {
+        float s = p.b[h][o] * p.b[h][o];
+        for (size_t c = 0; c < in; ++c) s += p.W[h][c * width + o] * p.W[h][c * width + o];
+        for (size_t k = 0; k < next_out; ++k) s += p.W[h + 1][o * next_out + k] * p.W[h + 1][o * next_out + k];
+        score[o] = {s, o};
+    }
+    std::stable_sort(score.begin(), score.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    std::vector<size_t> kept;
+    for (size_t i = 0; i < keep; ++i) kept.push_back(score[i].second);
+    std::sort(kept.begin(), kept.end());
+
+    MlpParams q = p;
+    q.dims[h + 1] = keep;
+    q.W[h].assign(in * keep, 0.0f);
+    q.b[h].assign(keep, 0.0f);
+    for (size_t i = 0; i < keep; ++i) {
+        const size_t o = kept[i];
+        for (size_t c = 0; c < in; ++c) q.W[h][c * keep + i] = p.W[h][c * width + o];
+        q.b[h][i] = p.b[h][o];
+    }
+    q.W[h + 1].assign(keep * next_out, 0.0f);
+    for (size_t i = 0; i < keep; ++i)
+        for (size_t k = 0; k < next_out; ++k) q.W[h + 1][i * next_out + k] = p.W[h + 1][kept[i] * next_out + k];
+    return q;
+}
+
+// Test accuracy plus argmax agreement with the teacher's predictions on the same rows
+static inline void score_candidate(CompressCandidate &c, const Dataset &ds, const std::vector<size_t> &val_rows,
+                                   const std::vector<size_t> &test_rows, const std::vector<int> &teacher_test_pred,
+                                   const float *Xcal, size_t ncal) {
+    MlpEngine eng = to_engine(c.params);
+    c.val_acc = evaluate(eng, ds, val_rows).accuracy();
+    std::vector<float> X(test_rows.size() * NUM_FEATURES);
+    for (size_t k = 0; k < test_rows.size(); ++k)
+        for (size_t j = 0; j < NUM_FEATURES; ++j) X[k * NUM_FEATURES + j] = ds.at(test_rows[k], j);
+    std::vector<int> pred(test_rows.size());
+    if (!test_rows.empty()) eng.predict_batch(X.data(), test_rows.size(), pred.data());
+    size_t correct = 0, agree = 0;
+    for (size_t k = 0; k < test_rows.size(); ++k) {
+        correct += size_t(pred[k]) == size_t(ds.y[test_rows[k]]);
+        agree += pred[k] == teacher_test_pred[k];
+    }
+    c.test_acc = test_rows.empty() ? 0.0 : double(correct) / double(test_rows.size());
+    c.agreement = test_rows.empty() ? 0.0 : double(agree) / double(test_rows.size());
+    c.float_bytes = c.params.count() * sizeof(float);
+    c.int8_bytes = quantize_model(eng, Xcal, ncal).flash_bytes();
+    c.macs = mlp_macs(c.params.dims);
+}
+
+// Distill every student, then prune + fine-tune it while it stays within budget.
+// val_rows must be held out from the teacher's training rows as well, or teacher_val_acc is a training
+// accuracy and the budget check favours the teacher.
+// Returns all candidates (students first, each followed by its pruned descendants).
+static inline std::vector<CompressCandidate> run_compression(const Dataset &ds, MlpEngine teacher,
+                                                             const std::vector<size_t> &fit_rows, const std::vector<size_t> &val_rows,
+                                                             const std::vector<size_t> &test_rows, const DistillConfig &dc,
+                                                             size_t threads, double &teacher_val_acc) {
+    if (val_rows.empty()) throw std::runtime_error("compression needs validation rows");
+    const std::vector<float> soft = teacher_soft_targets(teacher, ds, dc.temperature);
+    teacher_val_acc = evaluate(teacher, ds, val_rows).accuracy();
+
+    std::vector<float> Xt(test_rows.size() * NUM_FEATURES), Xcal(fit_rows.size() * NUM_FEATURES);
+    for (size_t k = 0; k < test_rows.size(); ++k)
+        for (size_t j = 0; j < NUM_FEATURES; ++j) Xt[k * NUM_FEATURES + j] = ds.at(test_rows[k], j);
+    for (size_t k = 0; k < fit_rows.size(); ++k)
+        for (size_t j = 0; j < NUM_FEATURES; ++j) Xcal[k * NUM_FEATURES + j] = ds.at(fit_rows[k], j);
+    std::vector<int> teacher_pred(test_rows.size());
+    if (!test_rows.empty()) teacher.predict_batch(Xt.data(), test_rows.size(), teacher_pred.data());
+
+    TrainOptions opts;
+    opts.val_rows = &val_rows;
+    opts.patience = dc.patience;
+    opts.soft_targets = soft.data();
+    opts.soft_weight = dc.alpha;
+    opts.temperature = dc.temperature;
+
+    std::vector<std::vector<CompressCandidate>> per_student(dc.students.size());
+    std::mutex print_mu;
+    ThreadPool pool(threads);
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(dc.students.size());
+    for (size_t s = 0; s < dc.students.size(); ++s) {
+        jobs.push_back(pool.submit([&, s] {
+            MlpConfig cfg;
+            cfg.hidden = dc.students[s];
+            cfg.lr = dc.lr;
+            cfg.batch = dc.batch;
+            cfg.epochs = dc.epochs;
+            cfg.seed = dc.seed + uint32_t(s);
+            const std::string student = cfg.topology();
+
+            CompressCandidate c;
+            c.name = student;
+            c.params = init_mlp(cfg.dims(), cfg.seed);
+            train_mlp(c.params, ds, fit_rows, cfg, opts);
+            score_candidate(c, ds, val_rows, test_rows, teacher_pred, Xcal.data(), fit_rows.size());
+            c.within_budget = teacher_val_acc - c.val_acc <= dc.max_drop;
+            per_student[s].push_back(c);
+
+            // Prune the widest hidden layer step by step while the budget holds
+            MlpConfig ft = cfg;
+            ft.epochs = dc.finetune_epochs;
+            while (per_student[s].back().within_budget) {
+                const MlpParams &cur = per_student[s].back().params;
+                size_t h = 0;
+                for (size_t l = 1; l + 1 < cur.dims.size() - 1; ++l)
+                    if (cur.dims[l + 1] > cur.dims[h + 1]) h = l;
+                const size_t width = cur.dims[h + 1];
+                const size_t keep = std::max(dc.min_width, size_t(std::floor(float(width) * (1.0f - dc.prune_step))));
+                if (keep >= width) break;
+                CompressCandidate pc;
+                pc.params = prune_hidden(cur, h, keep);
+                pc.name = dims_topology(pc.params.dims) + " (pruned " + student + ")";
+                train_mlp(pc.params, ds, fit_rows, ft, opts);
+                score_candidate(pc, ds, val_rows, test_rows, teacher_pred, Xcal.data(), fit_rows.size());
+                pc.within_budget = teacher_val_acc - pc.val_acc <= dc.max_drop;
+                per_student[s].push_back(pc);
+            }
+
+            std::lock_guard<std::mutex> lk(print_mu);
+            std::cout << "  student " << student << ": " << per_student[s].size() << " candidate(s), smallest within budget "
+                      << [&]() -> std::string {
+                             for (size_t i = per_student[s].size(); i-- > 0;)
+                                 if (per_student[s][i].within_budget) return dims_topology(per_student[s][i].params.dims);
+                             return "none";
+                         }()
+                      << std::endl;
+        }));
+    }
+    pool.wait_idle();
+    for (auto &j : jobs) j.get(); // rethrows a failed student
+
+    std::vector<CompressCandidate> all;
+    for (auto &v : per_student) all.insert(all.end(), v.begin(), v.end());
+    return all;
+}
+
+// Smallest within budget: float bytes, then MACs, then validation accuracy; -1 if none qualifies
+static inline int pick_smallest(const std::vector<CompressCandidate> &cands) {
+    int best = -1;
+    for (size_t i = 0; i < cands.size(); ++i) {
+        const CompressCandidate &c = cands[i];
+        if (!c.within_budget) continue;
+        if (best < 0) { best = int(i); continue; }
+        const CompressCandidate &b = cands[size_t(best)];
+        if (c.float_bytes != b.float_bytes ? c.float_bytes < b.float_bytes
+            : c.macs != b.macs ? c.macs < b.macs : c.val_acc > b.val_acc)
+            best = int(i);
+    }
+    return best;
+}
+
+static inline void print_compression_report(const std::vector<CompressCandidate> &cands, double teacher_test_acc,
+                                            const MlpEngine &teacher, int picked) {
+    std::cout << "\nModel                                       test_acc  drop    agree   val_acc  float_B  int8_B  MACs\n";
+    auto row = [&](const std::string &name, double acc, double agree, double val, size_t fb, size_t ib, size_t macs, bool mark) {
+        std::cout << std::left << std::setw(44) << ((mark ? "* " : "  ") + name) << std::right << std::fixed << std::setprecision(4)
+                  << acc << "  " << std::setw(6) << std::showpos << (acc - teacher_test_acc) << std::noshowpos << "  " << agree
+                  << "  ";
+        if (val >= 0) std::cout << val; else std::cout << "     -";
+        std::cout << "  " << std::setw(7) << fb << "  " << std::setw(6) << ib << "  " << std::setw(5) << macs << "\n";
+    };
+    std::vector<size_t> tdims = {teacher.input_size()};
+    for (const auto &L : teacher.layers()) tdims.push_back(L.out);
+    row(dims_topology(tdims) + " (teacher)", teacher_test_acc, 1.0, -1.0, teacher.param_count() * sizeof(float), 0,
+        mlp_macs(tdims), false);
+    for (size_t i = 0; i < cands.size(); ++i) {
+        const CompressCandidate &c = cands[i];
+        row(c.name + (c.within_budget ? "" : " [over budget]"), c.test_acc, c.agreement, c.val_acc, c.float_bytes, c.int8_bytes,
+            c.macs, int(i) == picked);
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+static inline void write_compression_report(const std::string &path, const std::vector<CompressCandidate> &cands,
+                                            double teacher_test_acc, int picked) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+    out << "model,topology,test_accuracy,drop_vs_teacher,teacher_agreement,val_accuracy,within_budget,float_bytes,int8_bytes,macs,exported\n";
+    for (size_t i = 0; i < cands.size(); ++i) {
+        const CompressCandidate &c = cands[i];
+        out << '"' << c.name << "\"," << dims_topology(c.params.dims) << "," << c.test_acc << "," << c.test_acc - teacher_test_acc
+            << "," << c.agreement << "," << c.val_acc << "," << (c.within_budget ? 1 : 0) << "," << c.float_bytes << ","
+            << c.int8_bytes << "," << c.macs << "," << (int(i) == picked ? 1 : 0) << "\n";
+    }
+}
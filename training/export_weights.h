@@ -0,0 +1,130 @@
+// training/export_weights.h
+// Writes models/arduino_weights.h for the firmware's templated forward pass (firmware/ann_mlp.h):
+// - layer dimensions as constexpr (ANN_IN_DIM, ANN_Lk_IN/OUT, ANN_OUT_DIM)
+// - weights row-major [out][in] and biases as sized PROGMEM arrays
+// - a generated ann_forward() chaining ann_dense<IN,OUT,RELU> calls through two ping-pong buffers
+//   into the output logits, and ann_predict() = argmax of those
+// - ANN_MODEL_HASH: FNV-1a of the header text, so derived artifacts (models/arduino_lattice.h) can
+//   refuse to build against a different model
+// - ANN_MODEL_FEATURES: the input contract (firmware/ann_features.h) the model was trained with;
+//   write_feature_contract() documents the same contract as data/normalize_params.json
+// Any mismatch between the arrays, the layer templates and the firmware's input vector is a compile error.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mlp_engine.h"
+#include "dataset_io.h"
+#include "../firmware/ann_features.h"
+
+// FNV-1a (32-bit) of a generated header's text
+static inline uint32_t header_hash(const std::string &text) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : text) h = (h ^ c) * 16777619u;
+    return h;
+}
+
+// Write text plus "#define <macro> <hash of text>" and the closing #endif of the include guard
+static inline void write_hashed_header(const std::string &path, const std::string &text, const char *macro, const char *guard) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+    out << text << "#define " << macro << " 0x" << std::hex << std::setw(8) << std::setfill('0') << header_hash(text) << "u\n\n#endif // "
+        << guard << "\n";
+}
+
+static inline void write_arduino_header(const std::string &path, const MlpEngine &eng) {
+    const auto &Ls = eng.layers();
+    if (Ls.empty()) throw std::runtime_error("write_arduino_header: empty model");
+    for (size_t l = 0; l + 1 < Ls.size(); ++l)
+        if (!Ls[l].relu) throw std::runtime_error("write_arduino_header: hidden layer " + std::to_string(l) + " has no ReLU");
+
+    std::ostringstream out;
+
+    // Ping-pong buffers: even layers write to a, odd layers to b (the last layer writes logits)
+    size_t cap_a = 1, cap_b = 1;
+    for (size_t l = 0; l + 1 < Ls.size(); ++l)
+        (l % 2 == 0 ? cap_a : cap_b) = std::max(l % 2 == 0 ? cap_a : cap_b, Ls[l].out);
+
+    out << "// Auto-generated weights header from train_ann.cpp\n";
+    out << "// Topology: " << Ls.front().in;
+    for (const auto &L : Ls) out << " -> " << L.out;
+    out << " (" << eng.param_count() << " params, " << eng.param_count() * sizeof(float) << " bytes in flash)\n";
+    out << "#ifndef ANN_WEIGHTS_H\n#define ANN_WEIGHTS_H\n\n";
+    out << "#include \"../firmware/ann_mlp.h\"\n";
+    out << "#include \"../firmware/ann_features.h\"\n\n";
+    out << "#define ANN_MODEL 1\n";
+    out << "#define ANN_MODEL_FEATURES 0x" << std::hex << std::setw(8) << std::setfill('0') << ANN_FEAT_CONTRACT
+        << std::dec << std::setfill(' ') << "u // input contract the model was trained with\n";
+    out << "constexpr uint8_t ANN_NUM_LAYERS = " << Ls.size() << ";\n";
+    out << "constexpr uint16_t ANN_IN_DIM = " << Ls.front().in << ";\n";
+    out << "constexpr uint16_t ANN_OUT_DIM = " << Ls.back().out << ";\n\n";
+
+    out << std::setprecision(9);
+    for (size_t l = 0; l < Ls.size(); ++l) {
+        const auto &L = Ls[l];
+        const float *W = eng.weights(l), *B = eng.bias(l);
+        out << "constexpr uint16_t ANN_L" << l << "_IN = " << L.in << ";\n";
+        out << "constexpr uint16_t ANN_L" << l << "_OUT = " << L.out << ";\n";
+        out << "const float ANN_W" << l << "[ANN_L" << l << "_OUT * ANN_L" << l << "_IN] ANN_PROGMEM = {";
+        for (size_t o = 0; o < L.out; ++o) {
+            out << "\n ";
+            for (size_t c = 0; c < L.in; ++c) out << " " << std::showpoint << W[c * L.out_pad + o] << "f,";
+        }
+        out << "\n};\n";
+        out << "const float ANN_B" << l << "[ANN_L" << l << "_OUT] ANN_PROGMEM = {\n ";
+        for (size_t o = 0; o < L.out; ++o) out << " " << B[o] << "f,";
+        out << "\n};\n\n";
+    }
+
+    out << "// Forward pass: normalized inputs -> output logits\n";
+    out << "static inline void ann_forward(const float (&x)[ANN_IN_DIM], float (&logits)[ANN_OUT_DIM]) {\n";
+    out << "  float a[" << cap_a << "], b[" << cap_b << "];\n";
+    std::string src = "x";
+    for (size_t l = 0; l < Ls.size(); ++l) {
+        const std::string L = "ANN_L" + std::to_string(l);
+        std::string dst;
+        if (l + 1 == Ls.size()) dst = "logits";
+        else dst = std::string("ann_view<") + L + "_OUT>(" + (l % 2 == 0 ? "a" : "b") + ")";
+        out << "  ann_dense<" << L << "_IN, " << L << "_OUT, " << (Ls[l].relu ? "true" : "false") << ">(ANN_W" << l
+            << ", ANN_B" << l << ", " << src << ", " << dst << ");\n";
+        src = dst;
+    }
+    out << "}\n\n";
+    out << "// Normalized inputs -> argmax action\n";
+    out << "static inline uint8_t ann_predict(const float (&x)[ANN_IN_DIM]) {\n";
+    out << "  float logits[ANN_OUT_DIM];\n";
+    out << "  ann_forward(x, logits);\n";
+    out << "  return ann_argmax(logits);\n";
+    out << "}\n\n";
+    write_hashed_header(path, out.str(), "ANN_MODEL_HASH", "ANN_WEIGHTS_H");
+}
+
+// JSON description of the input contract for tools outside this repo (data/normalize_params.json)
+static inline void write_feature_contract(const std::string &path) {
+    static const char *const names[ANN_FEAT_COUNT] = {"front", "left", "right", "diff", "minLR"};
+    static const char *const sources[ANN_FEAT_COUNT] = {"front", "left", "right", "left - right", "min(left, right)"};
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+    const auto norm = default_feature_norm();
+    out << "{\n";
+    out << "  \"contract\": \"0x" << std::hex << std::setw(8) << std::setfill('0') << ANN_FEAT_CONTRACT << std::dec
+        << std::setfill(' ') << "\",\n";
+    out << "  \"version\": " << ANN_FEAT_VERSION << ",\n";
+    out << "  \"range_cm\": " << ANN_FEAT_RANGE_CM << ",\n";
+    out << "  \"no_echo_cm\": " << ANN_FEAT_NO_ECHO << ",\n";
+    out << "  \"clamp\": \"distances are clamped to 0..range_cm before the derived features; no_echo_cm becomes range_cm\",\n";
+    out << "  \"q14_one\": " << ANN_FEAT_Q14_ONE << ",\n";
+    out << "  \"features\": [\n";
+    for (size_t j = 0; j < ANN_FEAT_COUNT; ++j)
+        out << "    {\"name\": \"" << names[j] << "\", \"cm\": \"" << sources[j] << "\", \"lo\": " << norm[j].lo
+            << ", \"hi\": " << norm[j].hi << ", \"scale\": " << norm[j].scale << "}" << (j + 1 < ANN_FEAT_COUNT ? "," : "")
+            << "\n";
+    out << "  ]\n}\n";
+}
@@ -0,0 +1,212 @@
+// training/finetune.h
+// Incremental fine-tuning (train_ann --finetune): continue the saved model on the rows logged since
+// the last run instead of retraining 300 epochs from scratch.
+// - models/ann_optimizer.bin is written next to ann_model_tinydnn.bin by every run: Adam moments and
+//   step count for the saved weights, the number of dataset rows they were trained on and a hash of
+//   those rows. The new rows are the ones appended after that prefix (or a separate --new file);
+//   a rewritten prefix is refused rather than silently treated as new data
+// - Forgetting is bounded by a replay reservoir: a fixed-size uniform sample (Algorithm R) of the
+//   old rows is trained on together with the new ones; two more disjoint old samples validate and
+//   measure forgetting, so the training epochs cost (new rows + replay), not the dataset size.
+//   Loading the dataset, the prefix hash and the reservoir pass are still linear in the dataset
+//   (one streaming pass each, small next to an epoch)
+// - Early stopping on validation accuracy (new + old held-out rows); the result replaces the saved
+//   model only if it beats the starting weights on that validation set
+// - Reports accuracy and confusion-matrix deltas (after - before) on the new test rows and the old
+//   eval rows, and writes them to models/finetune_report.csv
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dataset_io.h"
+#include "mlp_trainer.h"
+
+struct TrainCheckpoint {
+    AdamState opt;            // moments of the saved model; empty (opt.m.dims) after a tiny-dnn run
+    uint64_t rows_seen = 0;   // dataset rows the saved model was trained on
+    uint32_t data_hash = 0;   // dataset_prefix_hash() of those rows
+};
+
+static const uint32_t CHECKPOINT_MAGIC = 0x4F4E4E41; // "ANNO"
+static const uint32_t CHECKPOINT_VERSION = 1;
+
+// FNV-1a over the first n rows (normalized features, then labels): detects a rewritten dataset prefix
+static inline uint32_t dataset_prefix_hash(const Dataset &ds, size_t n) {
+    uint32_t h = 2166136261u;
+    auto mix = [&](const void *p, size_t bytes) {
+        const unsigned char *c = static_cast<const unsigned char *>(p);
+        for (size_t i = 0; i < bytes; ++i) h = (h ^ c[i]) * 16777619u;
+    };
+    n = std::min(n, ds.size());
+    for (size_t j = 0; j < NUM_FEATURES; ++j) mix(ds.col(j), n * sizeof(float));
+    mix(ds.y.data(), n);
+    return h;
+}
+
+static inline bool save_checkpoint(const std::string &path, const TrainCheckpoint &ck) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    auto put = [&](const void *p, size_t bytes) { out.write(static_cast<const char *>(p), std::streamsize(bytes)); };
+    const AdamState &o = ck.opt;
+    const uint32_t ndims = uint32_t(o.m.dims.size());
+    put(&CHECKPOINT_MAGIC, 4);
+    put(&CHECKPOINT_VERSION, 4);
+    put(&ck.rows_seen, 8);
+    put(&ck.data_hash, 4);
+    const float hyper[6] = {o.alpha, o.b1, o.b2, o.eps, o.b1_t, o.b2_t};
+    put(hyper, sizeof(hyper));
+    put(&ndims, 4);
+    for (size_t d : o.m.dims) { const uint32_t d32 = uint32_t(d); put(&d32, 4); }
+    for (const MlpParams *s : {&o.m, &o.v})
+        for (size_t l = 0; l < s->layers(); ++l) {
+            put(s->W[l].data(), s->W[l].size() * sizeof(float));
+            put(s->b[l].data(), s->b[l].size() * sizeof(float));
+        }
+    return bool(out);
+}
+
+// false if the file is missing or not a checkpoint of this version
+static inline bool load_checkpoint(const std::string &path, TrainCheckpoint &ck) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    auto get = [&](void *p, size_t bytes) { return bool(in.read(static_cast<char *>(p), std::streamsize(bytes))); };
+    uint32_t magic = 0, version = 0, ndims = 0;
+    float hyper[6];
+    if (!get(&magic, 4) || !get(&version, 4) || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) return false;
+    TrainCheckpoint c;
+    if (!get(&c.rows_seen, 8) || !get(&c.data_hash, 4) || !get(hyper, sizeof(hyper)) || !get(&ndims, 4) || ndims > 64)
+        return false;
+    c.opt.alpha = hyper[0]; c.opt.b1 = hyper[1]; c.opt.b2 = hyper[2];
+    c.opt.eps = hyper[3]; c.opt.b1_t = hyper[4]; c.opt.b2_t = hyper[5];
+    MlpParams shape;
+    for (uint32_t i = 0; i < ndims; ++i) {
+        uint32_t d = 0;
+        if (!get(&d, 4)) return false;
+        shape.dims.push_back(d);
+    }
+    if (ndims >= 2) {
+        shape.W.resize(ndims - 1);
+        shape.b.resize(ndims - 1);
+        for (size_t l = 0; l + 1 < ndims; ++l) {
+            shape.W[l].resize(shape.dims[l] * shape.dims[l + 1]);
+            shape.b[l].resize(shape.dims[l + 1]);
+        }
+        c.opt.m.resize_like(shape);
+        c.opt.v.resize_like(shape);
+        for (MlpParams *s : {&c.opt.m, &c.opt.v})
+            for (size_t l = 0; l < s->layers(); ++l)
+                if (!get(s->W[l].data(), s->W[l].size() * sizeof(float)) || !get(s->b[l].data(), s->b[l].size() * sizeof(float)))
+                    return false;
+    }
+    ck = std::move(c);
+    return true;
+}
+
+struct FinetuneConfig {
+    size_t replay = 20000;     // old rows trained on alongside the new ones
+    size_t old_eval = 5000;    // old rows held out for validation, and as many again to measure forgetting
+    float test_ratio = 0.2f;   // of the new rows
+    float val_ratio = 0.1f;    // of the new rows
+    int epochs = 50;
+    int patience = 5;          // early stopping on validation accuracy (0 = off)
+    uint32_t seed = 2024;
+};
+
+struct FinetuneRows {
+    std::vector<size_t> fit;       // new training rows + replay reservoir
+    std::vector<size_t> val;       // new + old validation rows
+    std::vector<size_t> new_test;
+    std::vector<size_t> old_eval;  // forgetting check, never trained or selected on
+    size_t fit_new = 0, replay = 0;
+};
+
+// Uniform sample of k indices from [lo, hi) in one pass and O(k) memory (Algorithm R)
+static inline std::vector<size_t> reservoir_sample(size_t lo, size_t hi, size_t k, std::mt19937 &rng) {
+    std::vector<size_t> r;
+    r.reserve(std::min(k, hi - lo));
+    for (size_t i = lo; i < hi; ++i) {
+        const size_t seen = i - lo;
+        if (seen < k) { r.push_back(i); continue; }
+        const size_t j = std::uniform_int_distribution<size_t>(0, seen)(rng);
+        if (j < k) r[j] = i;
+    }
+    return r;
+}
+
+// New rows are [old_rows, n): split into fit/val/test. Old rows [0, old_rows): reservoir of
+// replay + 2 * old_eval, split into old validation, old eval and the replay set.
+static inline FinetuneRows finetune_split(size_t old_rows, size_t n, const FinetuneConfig &fc) {
+    if (old_rows >= n) throw std::runtime_error("finetune_split: no new rows");
+    std::mt19937 rng(fc.seed);
+    FinetuneRows r;
+
+    std::vector<size_t> fresh(n - old_rows);
+    for (size_t i = 0; i < fresh.size(); ++i) fresh[i] = old_rows + i;
+    std::shuffle(fresh.begin(), fresh.end(), rng);
+    const size_t ntest = static_cast<size_t>(fresh.size() * fc.test_ratio);
+    const size_t nval = static_cast<size_t>(fresh.size() * fc.val_ratio);
+    r.new_test.assign(fresh.begin(), fresh.begin() + ntest);
+    r.val.assign(fresh.begin() + ntest, fresh.begin() + ntest + nval);
+    r.fit.assign(fresh.begin() + ntest + nval, fresh.end());
+    r.fit_new = r.fit.size();
+
+    std::vector<size_t> old = reservoir_sample(0, old_rows, fc.replay + 2 * fc.old_eval, rng);
+    std::shuffle(old.begin(), old.end(), rng);
+    const size_t neval = std::min(fc.old_eval, old.size() / 4); // keep at least half for replay when old data is short
+    r.val.insert(r.val.end(), old.begin(), old.begin() + neval);
+    r.old_eval.assign(old.begin() + neval, old.begin() + 2 * neval);
+    r.fit.insert(r.fit.end(), old.begin() + 2 * neval, old.end());
+    r.replay = r.fit.size() - r.fit_new;
+    if (r.fit.empty()) throw std::runtime_error("finetune_split: no training rows");
+    return r;
+}
+
+struct FinetuneDelta {
+    std::string split;
+    EvalResult before, after;
+};
+
+// Accuracy, per-class recall and confusion deltas (after - before)
+static inline void print_finetune_delta(const FinetuneDelta &d) {
+    std::cout << d.split << " (" << d.after.n << " rows): accuracy " << std::fixed << std::setprecision(4)
+              << d.before.accuracy() << " -> " << d.after.accuracy() << " (" << std::showpos
+              << d.after.accuracy() - d.before.accuracy() << std::noshowpos << ")\n";
+    std::cout << "  recall delta:";
+    for (size_t k = 0; k < NUM_CLASSES; ++k)
+        std::cout << " " << k << ":" << std::showpos << d.after.recall(k) - d.before.recall(k) << std::noshowpos;
+    std::cout << std::defaultfloat << std::setprecision(6) << "\n  confusion delta [truth][pred]:\n";
+    for (size_t i = 0; i < NUM_CLASSES; ++i) {
+        std::cout << "    " << i << ":";
+        for (size_t j = 0; j < NUM_CLASSES; ++j)
+            std::cout << std::setw(7) << (long long)d.after.confusion[i][j] - (long long)d.before.confusion[i][j];
+        std::cout << "\n";
+    }
+}
+
+static inline void write_finetune_report(const std::string &path, const std::vector<FinetuneDelta> &deltas) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write " + path);
+    out << "split,metric,before,after,delta\n";
+    for (const auto &d : deltas) {
+        out << d.split << ",accuracy," << d.before.accuracy() << "," << d.after.accuracy() << ","
+            << d.after.accuracy() - d.before.accuracy() << "\n";
+        for (size_t k = 0; k < NUM_CLASSES; ++k)
+            out << d.split << ",recall_" << k << "," << d.before.recall(k) << "," << d.after.recall(k) << ","
+                << d.after.recall(k) - d.before.recall(k) << "\n";
+        for (size_t i = 0; i < NUM_CLASSES; ++i)
+            for (size_t j = 0; j < NUM_CLASSES; ++j)
+                out << d.split << ",confusion_" << i << "_" << j << "," << d.before.confusion[i][j] << ","
+                    << d.after.confusion[i][j] << ","
+                    << (long long)d.after.confusion[i][j] - (long long)d.before.confusion[i][j] << "\n";
+    }
+}
@@ -0,0 +1,213 @@
+// training/firmware_host.cpp
+// Runs firmware/robot_ann.ino on the host HAL (firmware/host) against a scripted distance timeline
+// and reports the cooperative scheduler's timing:
+// - longest single loop() pass and per-task worst case (ann_sched.h bookkeeping)
+// - time spent in each control state, decision latency (front blocked -> action started)
+// - reaction time from a critical reading appearing to the motors being cut
+// Echoes go through the simulated HC-SR04 in the host HAL: the ECHO edges drive the same
+// pin-change handler, ring buffer and angle->distance map (ann_echo.h, ann_scanmap.h) as on the board.
+// Script: one "t_ms front left right" line per change (cm, 999 = no echo, '#' comments); each line
+// holds until the next one. The pan servo angle picks the column (>= 120 left, <= 60 right, else front).
+// Echo log: recorded echo widths, one "width_us" per line (0 = no echo), replayed ping by ping
+// instead of the script; when the log runs out the script takes over again.
+// Telemetry: the binary frames the sketch writes to Serial (ann_telemetry.h) can be saved with
+// --telemetry and read back with training/telemetry_decode --in.
+//
+// Needs a train_ann export in models/ (the sketch includes models/arduino_weights.h).
+// Build: g++ -O2 -std=c++17 -I firmware/host training/firmware_host.cpp -o training/firmware_host
+//        cl /EHsc /O2 /std:c++17 /I firmware\host training\firmware_host.cpp /Fe:training\firmware_host.exe
+// Run:   training/firmware_host [--script timeline.txt] [--echo-log widths.txt] [--duration ms] [--tick-us N] [--trace]
+//                               [--telemetry capture.bin]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../firmware/robot_ann.ino"
+
+static const char *const STATE_NAMES[] = {
+    "DRIVE", "CRITICAL", "INFER", "ACTION", "ACTION_SETTLE", "BACKUP_STOP", "BACKUP", "BACKUP_SETTLE"};
+static const size_t NUM_STATES = sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]);
+
+struct ScriptRow {
+    uint32_t t_ms;
+    unsigned int front, left, right;
+};
+
+// Clear corridor, a wall at 20 cm with the left side open, then something stepping in front of
+// the robot while it drives (critical reading) and clearing again
+static const char *DEFAULT_SCRIPT =
+    "0     200 200 200\n"
+    "1500  20  80  15\n"
+    "4500  200 200 200\n"
+    "6000  8   200 200\n"
+    "6400  200 200 200\n";
+
+static std::vector<ScriptRow> parse_script(std::istream &in) {
+    std::vector<ScriptRow> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        ScriptRow r;
+        if (!(ss >> r.t_ms)) continue;
+        if (!(ss >> r.front >> r.left >> r.right)) throw std::runtime_error("script line needs: t_ms front left right");
+        rows.push_back(r);
+    }
+    if (rows.empty()) throw std::runtime_error("empty script");
+    std::stable_sort(rows.begin(), rows.end(), [](const ScriptRow &a, const ScriptRow &b) { return a.t_ms < b.t_ms; });
+    return rows;
+}
+
+static const ScriptRow &script_at(const std::vector<ScriptRow> &rows, uint32_t t_ms) {
+    size_t i = 0;
+    while (i + 1 < rows.size() && rows[i + 1].t_ms <= t_ms) ++i;
+    return rows[i];
+}
+
+int main(int argc, char **argv) {
+    try {
+        std::string scriptPath, echoLogPath, telemetryPath;
+        uint32_t duration_ms = 8000;
+        uint64_t tick_us = 50; // loop() overhead outside pulseIn/delay
+        bool trace = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+                return argv[++i];
+            };
+            if (a == "--script") scriptPath = next();
+            else if (a == "--echo-log") echoLogPath = next();
+            else if (a == "--duration") duration_ms = uint32_t(std::stoul(next()));
+            else if (a == "--tick-us") tick_us = std::stoull(next());
+            else if (a == "--trace") trace = true;
+            else if (a == "--telemetry") telemetryPath = next();
+            else {
+                std::cerr << "Usage: firmware_host [--script timeline.txt] [--echo-log widths.txt] [--duration ms] [--tick-us N] [--trace]"
+                             " [--telemetry capture.bin]\n";
+                return 1;
+            }
+        }
+
+        std::vector<ScriptRow> script;
+        if (scriptPath.empty()) {
+            std::istringstream in(DEFAULT_SCRIPT);
+            script = parse_script(in);
+        } else {
+            std::ifstream in(scriptPath);
+            if (!in.is_open()) throw std::runtime_error("Cannot open script: " + scriptPath);
+            script = parse_script(in);
+        }
+
+        std::vector<unsigned long> echoLog;
+        size_t echoNext = 0;
+        if (!echoLogPath.empty()) {
+            std::ifstream in(echoLogPath);
+            if (!in.is_open()) throw std::runtime_error("Cannot open echo log: " + echoLogPath);
+            std::string line;
+            while (std::getline(in, line)) {
+                line = line.substr(0, line.find('#'));
+                std::istringstream ss(line);
+                unsigned long w;
+                if (ss >> w) echoLog.push_back(w);
+            }
+        }
+
+        AnnHostHal &hal = ann_host_hal();
+        hal.serial_echo = trace;
+        hal.echo_us = [&](uint64_t now_us) -> unsigned long {
+            if (echoNext < echoLog.size()) return echoLog[echoNext++];
+            const ScriptRow &r = script_at(script, uint32_t(now_us / 1000));
+            const int a = hal.servo_angle;
+            const unsigned int d = a >= 120 ? r.left : (a <= 60 ? r.right : r.front);
+            if (d >= 999) return 0;
+            return (unsigned long)(d * 2.0 / 0.034);
+        };
+        // Motor cut = ENA driven to 0
+        std::vector<uint64_t> stop_events;
+        hal.on_pin = [&](uint8_t pin, int v) {
+            if (pin == ENA && v == 0) stop_events.push_back(hal.now_us);
+        };
+        hal.on_servo = [&](int angle) {
+            if (trace) std::cout << "[" << std::setw(7) << hal.now_us / 1000 << " ms] servo " << angle << "\n";
+        };
+
+        setup();
+
+        double state_ms[NUM_STATES] = {};
+        uint64_t max_pass_us = 0, passes = 0;
+        std::vector<uint64_t> cycle_start, action_start;
+        uint8_t seen_head = echo.head;
+        AnnCtlState prev = ctl.state;
+        while (hal.now_us < uint64_t(duration_ms) * 1000) {
+            const uint64_t t0 = hal.now_us;
+            const AnnCtlState before = ctl.state;
+            loop();
+            const uint64_t pass = hal.now_us - t0;
+            max_pass_us = std::max(max_pass_us, pass);
+            ++passes;
+            ann_host_advance(tick_us);
+            state_ms[before] += double(hal.now_us - t0) / 1000.0;
+            if (trace) {
+                for (; seen_head != echo.head; ++seen_head) {
+                    const AnnEchoSample &e = echo.ring[seen_head & (ANN_ECHO_RING - 1)];
+                    std::cout << "[" << std::setw(7) << e.t_us / 1000 << " ms] echo angle " << int(e.angle) << " width "
+                              << e.width_us << " us -> " << ann_echo_cm(e.width_us) << " cm\n";
+                }
+            }
+            if (ctl.state != prev) {
+                if (ctl.state == ANN_ST_INFER) cycle_start.push_back(hal.now_us);
+                if (prev == ANN_ST_INFER) action_start.push_back(hal.now_us);
+                if (trace)
+                    std::cout << "[" << std::setw(7) << hal.now_us / 1000 << " ms] " << STATE_NAMES[prev] << " -> "
+                              << STATE_NAMES[ctl.state] << "\n";
+                prev = ctl.state;
+            }
+        }
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Simulated " << duration_ms << " ms, " << passes << " loop() passes\n";
+        std::cout << "Longest loop() pass: " << max_pass_us << " us\n";
+        const char *task_names[] = {"sweep", "control", "inference", "servo", "motors", "telemetry"};
+        for (size_t i = 0; i < sizeof(TASKS) / sizeof(TASKS[0]); ++i)
+            std::cout << "  task " << std::left << std::setw(10) << task_names[i] << std::right << " worst " << TASKS[i].max_us << " us\n";
+
+        std::cout << "Time per state (ms):\n";
+        for (size_t s = 0; s < NUM_STATES; ++s)
+            if (state_ms[s] > 0) std::cout << "  " << std::left << std::setw(14) << STATE_NAMES[s] << std::right << std::setw(9) << state_ms[s] << "\n";
+
+        std::cout << "Decisions: " << cycle_start.size() << ", echoes dropped: " << int(echo.dropped) << "\n";
+        for (size_t i = 0; i < cycle_start.size() && i < action_start.size(); ++i)
+            std::cout << "  decision " << i << " at " << cycle_start[i] / 1000 << " ms: action started after "
+                      << (action_start[i] - cycle_start[i]) / 1000.0 << " ms\n";
+
+        // Reaction: script rows whose front reading is critical -> first motor cut after that time
+        for (const auto &r : script) {
+            if ((int)r.front > ANN_CRITICAL_DISTANCE || r.front >= 999) continue;
+            const uint64_t onset = uint64_t(r.t_ms) * 1000;
+            auto it = std::lower_bound(stop_events.begin(), stop_events.end(), onset);
+            if (it == stop_events.end()) std::cout << "Critical obstacle at " << r.t_ms << " ms: motors never cut\n";
+            else std::cout << "Critical obstacle at " << r.t_ms << " ms: motors cut after " << (*it - onset) / 1000.0 << " ms\n";
+        }
+        std::cout << "Telemetry: " << hal.serial_tx.size() << " bytes ("
+                  << double(hal.serial_tx.size()) * 10.0 / double(hal.serial_baud) * 1000.0 << " ms of wire time at "
+                  << hal.serial_baud << " baud)\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+        if (!telemetryPath.empty()) {
+            std::ofstream out(telemetryPath, std::ios::binary);
+            if (!out.is_open()) throw std::runtime_error("Cannot write telemetry: " + telemetryPath);
+            out.write(reinterpret_cast<const char *>(hal.serial_tx.data()), std::streamsize(hal.serial_tx.size()));
+            std::cout << "Saved telemetry to " << telemetryPath << "\n";
+        }
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "Exception: " << ex.what() << std::endl;
+        return 1;
+    }
+}
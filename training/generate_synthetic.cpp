@@ -1,70 +1,266 @@
 // training/generate_synthetic.cpp
 // Generate synthetic dataset for ANNie with clear, rule-based labels
 // Each row: front,left,right,diff,minLR,action
-// Compile: cl /EHsc /std:c++17 training\generate_synthetic.cpp /Fe:training\gen_data.exe
-// Run: training\gen_data.exe
+// - Rows are split into shards; shard s draws from its own counter-based RNG stream
+//   (SplitMix64 keyed by seed+shard, counter = row within shard), so the output only depends on
+//   --seed/--rows/--shards, never on --threads
+// - Blocks of rows are formatted in parallel with std::to_chars into large buffers and streamed
+//   to disk in order (bounded number of blocks in flight)
+// - --format bin writes the binary dataset format from dataset_io.h (float32 feature columns from the input
+//   contract in firmware/ann_features.h, int8 labels)
+//
+// Compile: cl /EHsc /O2 /std:c++17 training\generate_synthetic.cpp /Fe:training\gen_data.exe
+// Run: training\gen_data.exe [--rows N] [--shards S] [--threads T] [--seed X] [--format csv|bin] [--out path]
+//   e.g. training\gen_data.exe --rows 100000000 --shards 64
 
 #include <iostream>
 #include <fstream>
-#include <random>
 #include <filesystem>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <array>
+#include <chrono>
+
+#include "dataset_io.h"
 
 namespace fs = std::filesystem;
 
+// Counter-based RNG: value i of a stream is a pure function of (key, i)
+static inline uint64_t splitmix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+struct CounterRng {
+    uint64_t key;
+    CounterRng(uint64_t seed, uint64_t stream) : key(splitmix64(seed ^ splitmix64(stream + 0x9e3779b97f4a7c15ULL))) {}
+    // uniform float in [0, 1) from the top 24 bits
+    float uniform(uint64_t counter) const {
+        return float(splitmix64(key + counter * 0x9e3779b97f4a7c15ULL) >> 40) * (1.0f / 16777216.0f);
+    }
+};
+
+struct Row {
+    float front, left, right, diff, minLR;
+    int action;
+};
+
+static inline Row make_row(const CounterRng &rng, uint64_t i) {
+    Row r;
+    r.front = rng.uniform(3 * i + 0) * 100.0f;
+    r.left  = rng.uniform(3 * i + 1) * 100.0f;
+    r.right = rng.uniform(3 * i + 2) * 100.0f;
+    r.diff  = r.left - r.right;
+    r.minLR = (r.left < r.right ? r.left : r.right);
+
+    if (r.front > 70.0f) {
+        r.action = 0; // FORWARD
+    } else if (r.front <= 70.0f && (r.left - r.right) > 5.0f) {
+        r.action = 1; // LEFT
+    } else if (r.front <= 70.0f && (r.right - r.left) > 5.0f) {
+        r.action = 2; // RIGHT
+    } else {
+        r.action = 3; // STOP (front blocked & sides nearly equal)
+    }
+    return r;
+}
+
+// Unit of parallel work: rows [first, first+count) of one shard
+struct BlockSpec {
+    uint64_t shard;
+    uint64_t shard_row;  // first row inside the shard (RNG counter)
+    uint64_t global_row; // first row in the output
+    uint64_t count;
+};
+
+struct BlockOut {
+    std::string text;                                  // csv
+    std::array<std::vector<float>, NUM_FEATURES> cols; // bin
+    std::vector<int8_t> labels;
+    std::array<uint64_t, 4> counts{};
+    bool ready = false;
+};
+
+static inline char *put_float(char *p, char *end, float v) {
+    // 6 significant digits, same as the default ostream formatting
+    return std::to_chars(p, end, v, std::chars_format::general, 6).ptr;
+}
+
+static void format_block(const BlockSpec &b, uint64_t seed, bool binary, BlockOut &out) {
+    const CounterRng rng(seed, b.shard);
+    out.counts = {0, 0, 0, 0};
+    if (binary) {
+        for (auto &c : out.cols) c.resize(b.count);
+        out.labels.resize(b.count);
+        for (uint64_t k = 0; k < b.count; ++k) {
+            Row r = make_row(rng, b.shard_row + k);
+            float v[ANN_FEAT_COUNT];
+            ann_features_cm(ann_feat_clamp_cmf(r.front), ann_feat_clamp_cmf(r.left), ann_feat_clamp_cmf(r.right), v);
+            for (size_t j = 0; j < NUM_FEATURES; ++j) out.cols[j][k] = v[j];
+            out.labels[k] = int8_t(r.action);
+            out.counts[r.action]++;
+        }
+        return;
+    }
+    const size_t max_row = 5 * 16 + 4; // 5 floats (<=13 chars each) + separators + label + newline
+    out.text.resize(b.count * max_row);
+    char *p = out.text.data(), *end = p + out.text.size();
+    for (uint64_t k = 0; k < b.count; ++k) {
+        Row r = make_row(rng, b.shard_row + k);
+        p = put_float(p, end, r.front); *p++ = ',';
+        p = put_float(p, end, r.left);  *p++ = ',';
+        p = put_float(p, end, r.right); *p++ = ',';
+        p = put_float(p, end, r.diff);  *p++ = ',';
+        p = put_float(p, end, r.minLR); *p++ = ',';
+        *p++ = char('0' + r.action);
+        *p++ = '\n';
+        out.counts[r.action]++;
+    }
+    out.text.resize(size_t(p - out.text.data()));
+}
+
+static bool parse_u64(const char *s, uint64_t &v) {
+    auto res = std::from_chars(s, s + std::strlen(s), v);
+    return res.ec == std::errc() && *res.ptr == '\0';
+}
+
 int main(int argc, char** argv) {
     try {
         fs::path repoRoot = fs::path(__FILE__).parent_path().parent_path();
-        fs::path dataPath = repoRoot / "data" / "dataset.csv";
-        fs::create_directories(repoRoot / "data");
+        uint64_t N = 12000;  // dataset size
+        uint64_t shards = 16;
+        uint64_t threads = std::max(1u, std::thread::hardware_concurrency());
+        uint64_t seed = 42;
+        bool binary = false;
+        fs::path dataPath;
 
-        std::ofstream out(dataPath);
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto next = [&]() -> const char * {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+                return argv[++i];
+            };
+            bool ok = true;
+            if (a == "--rows") ok = parse_u64(next(), N);
+            else if (a == "--shards") ok = parse_u64(next(), shards);
+            else if (a == "--threads") ok = parse_u64(next(), threads);
+            else if (a == "--seed") ok = parse_u64(next(), seed);
+            else if (a == "--out") dataPath = next();
+            else if (a == "--format") {
+                std::string f = next();
+                if (f == "bin") binary = true;
+                else if (f != "csv") ok = false;
+            } else {
+                std::cerr << "Usage: gen_data [--rows N] [--shards S] [--threads T] [--seed X] [--format csv|bin] [--out path]\n";
+                return 1;
+            }
+            if (!ok) throw std::runtime_error("invalid value for " + a);
+        }
+        if (shards == 0 || threads == 0) throw std::runtime_error("--shards and --threads must be > 0");
+        if (dataPath.empty()) dataPath = repoRoot / "data" / (binary ? "dataset.annb" : "dataset.csv");
+        if (dataPath.has_parent_path()) fs::create_directories(dataPath.parent_path());
+
+        std::ofstream out(dataPath, std::ios::binary);
         if (!out.is_open()) {
             std::cerr << "Failed to open output file: " << dataPath << std::endl;
             return 1;
         }
 
-        const int N = 12000; // dataset size
-        out << "front,left,right,diff,minLR,action\n";
-
-        std::mt19937 rng(42);
-        std::uniform_real_distribution<float> dist(0.0f, 100.0f);
-
-        int countF=0, countL=0, countR=0, countS=0;
-
-        for (int i = 0; i < N; i++) {
-            float front = dist(rng);
-            float left  = dist(rng);
-            float right = dist(rng);
-            float diff  = left - right;
-            float minLR = (left < right ? left : right);
-
-            int action;
-            if (front > 70.0f) {
-                action = 0; // FORWARD
-                countF++;
-            } else if (front <= 70.0f && (left - right) > 5.0f) {
-                action = 1; // LEFT
-                countL++;
-            } else if (front <= 70.0f && (right - left) > 5.0f) {
-                action = 2; // RIGHT
-                countR++;
-            } else {
-                action = 3; // STOP (front blocked & sides nearly equal)
-                countS++;
+        // Split shards into blocks
+        const uint64_t block_rows = 1 << 16;
+        std::vector<BlockSpec> blocks;
+        for (uint64_t s = 0; s < shards; ++s) {
+            const uint64_t lo = N * s / shards, hi = N * (s + 1) / shards;
+            for (uint64_t r = lo; r < hi; r += block_rows)
+                blocks.push_back({s, r - lo, r, std::min(block_rows, hi - r)});
+        }
+
+        if (binary) {
+            DatasetBinHeader h = make_bin_header(N, default_feature_norm());
+            out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        } else {
+            out << "front,left,right,diff,minLR,action\n";
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        const size_t window = size_t(2 * threads);
+        std::vector<BlockOut> slots(window);
+        std::mutex mu;
+        std::condition_variable cv;
+        std::atomic<size_t> next_block{0};
+        size_t written = 0;
+
+        auto worker = [&]() {
+            for (;;) {
+                const size_t b = next_block.fetch_add(1);
+                if (b >= blocks.size()) return;
+                BlockOut *slot;
+                {
+                    std::unique_lock<std::mutex> lk(mu);
+                    cv.wait(lk, [&] { return b < written + window; });
+                    slot = &slots[b % window];
+                }
+                format_block(blocks[b], seed, binary, *slot);
+                {
+                    std::lock_guard<std::mutex> lk(mu);
+                    slot->ready = true;
+                }
+                cv.notify_all();
             }
+        };
+        std::vector<std::thread> pool;
+        for (uint64_t t = 0; t < threads; ++t) pool.emplace_back(worker);
 
-            out << front << "," << left << "," << right << ","
-                << diff << "," << minLR << "," << action << "\n";
+        // Writer: emit blocks in order
+        std::array<uint64_t, 4> counts = {0, 0, 0, 0};
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            BlockOut *slot = &slots[b % window];
+            {
+                std::unique_lock<std::mutex> lk(mu);
+                cv.wait(lk, [&] { return slot->ready; });
+            }
+            if (binary) {
+                for (size_t j = 0; j < NUM_FEATURES; ++j) {
+                    out.seekp(std::streamoff(bin_column_offset(N, j) + blocks[b].global_row * sizeof(float)));
+                    out.write(reinterpret_cast<const char *>(slot->cols[j].data()), std::streamsize(blocks[b].count * sizeof(float)));
+                }
+                out.seekp(std::streamoff(bin_label_offset(N) + blocks[b].global_row));
+                out.write(reinterpret_cast<const char *>(slot->labels.data()), std::streamsize(blocks[b].count));
+            } else {
+                out.write(slot->text.data(), std::streamsize(slot->text.size()));
+            }
+            for (int c = 0; c < 4; ++c) counts[c] += slot->counts[c];
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                slot->ready = false;
+                ++written;
+            }
+            cv.notify_all();
         }
+        for (auto &t : pool) t.join();
 
         out.close();
+        if (!out) {
+            std::cerr << "Failed writing output file: " << dataPath << std::endl;
+            return 1;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 
-        std::cout << "Wrote dataset: " << dataPath << " with " << N << " rows.\n";
+        std::cout << "Wrote dataset: " << dataPath << " with " << N << " rows (" << shards << " shards, "
+                  << threads << " threads, " << secs << " s, " << (secs > 0 ? double(N) / secs : 0.0) << " rows/s).\n";
         std::cout << "Class counts -> "
-                  << "FORWARD=" << countF << ", "
-                  << "LEFT=" << countL << ", "
-                  << "RIGHT=" << countR << ", "
-                  << "STOP=" << countS << std::endl;
+                  << "FORWARD=" << counts[0] << ", "
+                  << "LEFT=" << counts[1] << ", "
+                  << "RIGHT=" << counts[2] << ", "
+                  << "STOP=" << counts[3] << std::endl;
 
         return 0;
     } catch (const std::exception &ex) {
@@ -0,0 +1,239 @@
+// training/mlp_engine.h
+// Dependency-free, header-only inference engine for ANNie's fully-connected/ReLU MLP
+// (5 -> 64 -> 32 -> 16 -> 4 by default, but any FC/ReLU stack works).
+// - Weights are copied once into a contiguous, 32-byte aligned buffer (zero-padded rows)
+// - AVX2 / SSE / scalar kernels are picked at compile time; no allocation per call
+// - Samples are processed in tiles of MLP_TILE so every weight load is shared across the tile
+// - Accumulation order matches tiny-dnn's fully_connected_layer
+//   (out = sum_c W[c*out+o]*in[c], then + bias), so argmax is bit-for-bit identical to net.predict
+//   as long as both are built with the same floating point flags (no -ffast-math) and no FMA contraction:
+//   GCC/Clang fuse a*b+c, intrinsics included, into FMA by default once -mfma / -march=native is on, so
+//   pass -ffp-contract=off there (MSVC only contracts with /fp:contract). train_ann --check-parity checks it.
+//
+// Usage:
+//   MlpEngine eng = MlpEngine::from_tiny_dnn(net);   // or add_layer(...) from raw arrays
+//   int label = eng.predict(x);                      // x: eng.input_size() floats
+//   eng.predict_batch(X, n, labels);                 // X: n rows, row-major
+//
+// An engine owns its scratch buffers: use one engine per thread (copies are cheap).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define MLP_ENGINE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define MLP_ENGINE_SSE 1
+#endif
+
+#ifndef MLP_TILE
+#define MLP_TILE 4 // samples evaluated together per weight pass
+#endif
+
+// Minimal aligned allocator so std::vector storage starts on a SIMD boundary
+template <class T, size_t Align>
+struct AlignedAllocator {
+    typedef T value_type;
+    template <class U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Align> &) {}
+    T *allocate(size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T *p, size_t) { ::operator delete(p, std::align_val_t(Align)); }
+    template <class U> bool operator==(const AlignedAllocator<U, Align> &) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U, Align> &) const { return false; }
+};
+
+typedef std::vector<float, AlignedAllocator<float, 32>> aligned_floats;
+
+class MlpEngine {
+public:
+    static const size_t LANES = 8; // row padding (one AVX register, two SSE registers)
+
+    struct Layer {
+        size_t in, out, out_pad;
+        size_t w_off, b_off; // offsets into params_
+        bool relu;
+    };
+
+    // Append a fully-connected layer. W uses tiny-dnn layout: W[c*out + o]. b may be null.
+    void add_layer(size_t in, size_t out, const float *W, const float *b, bool relu) {
+        if (!layers_.empty() && layers_.back().out != in)
+            throw std::runtime_error("MlpEngine: layer input " + std::to_string(in) +
+                                     " does not match previous output " + std::to_string(layers_.back().out));
+        Layer L;
+        L.in = in;
+        L.out = out;
+        L.out_pad = round_up(out);
+        L.relu = relu;
+        L.w_off = params_.size();
+        params_.resize(params_.size() + in * L.out_pad, 0.0f);
+        for (size_t c = 0; c < in; ++c)
+            std::memcpy(&params_[L.w_off + c * L.out_pad], W + c * out, out * sizeof(float));
+        L.b_off = params_.size();
+        params_.resize(params_.size() + L.out_pad, 0.0f);
+        if (b) std::memcpy(&params_[L.b_off], b, out * sizeof(float));
+        layers_.push_back(L);
+
+        max_width_ = std::max(max_width_, std::max(round_up(in), L.out_pad));
+        scratch_.assign(2 * MLP_TILE * max_width_, 0.0f);
+    }
+
+    // Mark the last added layer as followed by ReLU
+    void set_relu_on_last() {
+        if (layers_.empty()) throw std::runtime_error("MlpEngine: relu before any layer");
+        layers_.back().relu = true;
+    }
+
+    // Build from a tiny-dnn network<sequential> of fully_connected_layer/relu only.
+    // Templated so this header does not depend on tiny-dnn.
+    template <class Net>
+    static MlpEngine from_tiny_dnn(Net &net) {
+        MlpEngine eng;
+        for (size_t i = 0; i < net.depth(); ++i) {
+            auto *l = net[i];
+            const std::string type = l->layer_type();
+            if (type == "fully-connected") {
+                auto w = l->weights();
+                const size_t in = l->in_data_size(), out = l->out_data_size();
+                if (w.empty() || w[0]->size() != in * out)
+                    throw std::runtime_error("MlpEngine: unexpected weight shape in layer " + std::to_string(i));
+                eng.add_layer(in, out, w[0]->data(), w.size() > 1 ? w[1]->data() : nullptr, false);
+            } else if (type == "relu-activation") {
+                eng.set_relu_on_last();
+            } else {
+                throw std::runtime_error("MlpEngine: unsupported layer type '" + type + "'");
+            }
+        }
+        if (eng.layers_.empty()) throw std::runtime_error("MlpEngine: network has no layers");
+        return eng;
+    }
+
+    size_t input_size() const { return layers_.empty() ? 0 : layers_.front().in; }
+    size_t output_size() const { return layers_.empty() ? 0 : layers_.back().out; }
+    const std::vector<Layer> &layers() const { return layers_; }
+
+    // Weight pointer (padded layout W[c*out_pad + o]) and bias pointer for layer li
+    const float *weights(size_t li) const { return &params_[layers_[li].w_off]; }
+    const float *bias(size_t li) const { return &params_[layers_[li].b_off]; }
+
+    // Total trainable parameters (unpadded)
+    size_t param_count() const {
+        size_t n = 0;
+        for (const auto &L : layers_) n += L.in * L.out + L.out;
+        return n;
+    }
+
+    // Single sample -> argmax label. Optional logits receives output_size() floats.
+    int predict(const float *x, float *logits = nullptr) {
+        int label;
+        predict_batch(x, 1, &label, logits);
+        return label;
+    }
+
+    // n samples (row-major, input_size() floats each) -> labels[n]; logits (optional) n*output_size()
+    void predict_batch(const float *X, size_t n, int *labels, float *logits = nullptr) {
+        const size_t nin = input_size(), nout = output_size();
+        const size_t full = n - n % MLP_TILE;
+        size_t i = 0;
+        for (; i < full; i += MLP_TILE)
+            run_tile<MLP_TILE>(X + i * nin, labels + i, logits ? logits + i * nout : nullptr);
+        for (; i < n; ++i)
+            run_tile<1>(X + i * nin, labels + i, logits ? logits + i * nout : nullptr);
+    }
+
+private:
+    static size_t round_up(size_t n) { return (n + LANES - 1) / LANES * LANES; }
+
+    template <int T>
+    void run_tile(const float *X, int *labels, float *logits) {
+        const size_t stride = max_width_;
+        float *a = scratch_.data();
+        float *b = a + MLP_TILE * stride;
+        const size_t nin = input_size();
+        for (int t = 0; t < T; ++t) std::memcpy(a + t * stride, X + t * nin, nin * sizeof(float));
+
+        for (const auto &L : layers_) {
+            layer_tile<T>(L, a, b, stride);
+            std::swap(a, b);
+        }
+
+        const size_t nout = output_size();
+        for (int t = 0; t < T; ++t) {
+            const float *o = a + t * stride;
+            // first maximum wins, same as std::max_element
+            int best = 0;
+            for (size_t k = 1; k < nout; ++k) if (o[k] > o[best]) best = static_cast<int>(k);
+            labels[t] = best;
+            if (logits) std::memcpy(logits + t * nout, o, nout * sizeof(float));
+        }
+    }
+
+    template <int T>
+    void layer_tile(const Layer &L, const float *in, float *out, size_t stride) const {
+        const float *W = &params_[L.w_off];
+        const float *B = &params_[L.b_off];
+#if defined(MLP_ENGINE_AVX2)
+        const __m256 zero = _mm256_setzero_ps();
+        for (size_t o = 0; o < L.out_pad; o += 8) {
+            __m256 acc[T];
+            for (int t = 0; t < T; ++t) acc[t] = zero;
+            for (size_t c = 0; c < L.in; ++c) {
+                const __m256 w = _mm256_load_ps(W + c * L.out_pad + o);
+                for (int t = 0; t < T; ++t)
+                    acc[t] = _mm256_add_ps(acc[t], _mm256_mul_ps(w, _mm256_set1_ps(in[t * stride + c])));
+            }
+            const __m256 bias = _mm256_load_ps(B + o);
+            for (int t = 0; t < T; ++t) {
+                __m256 v = _mm256_add_ps(acc[t], bias);
+                if (L.relu) v = _mm256_max_ps(v, zero);
+                _mm256_storeu_ps(out + t * stride + o, v);
+            }
+        }
+#elif defined(MLP_ENGINE_SSE)
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t o = 0; o < L.out_pad; o += 4) {
+            __m128 acc[T];
+            for (int t = 0; t < T; ++t) acc[t] = zero;
+            for (size_t c = 0; c < L.in; ++c) {
+                const __m128 w = _mm_load_ps(W + c * L.out_pad + o);
+                for (int t = 0; t < T; ++t)
+                    acc[t] = _mm_add_ps(acc[t], _mm_mul_ps(w, _mm_set1_ps(in[t * stride + c])));
+            }
+            const __m128 bias = _mm_load_ps(B + o);
+            for (int t = 0; t < T; ++t) {
+                __m128 v = _mm_add_ps(acc[t], bias);
+                if (L.relu) v = _mm_max_ps(v, zero);
+                _mm_storeu_ps(out + t * stride + o, v);
+            }
+        }
+#else
+        for (int t = 0; t < T; ++t) {
+            const float *x = in + t * stride;
+            float *y = out + t * stride;
+            for (size_t o = 0; o < L.out_pad; ++o) {
+                float s = 0.0f;
+                for (size_t c = 0; c < L.in; ++c) s += W[c * L.out_pad + o] * x[c];
+                s += B[o];
+                y[o] = (L.relu && !(s > 0.0f)) ? 0.0f : s;
+            }
+        }
+#endif
+    }
+
+    aligned_floats params_;
+    aligned_floats scratch_;
+    std::vector<Layer> layers_;
+    size_t max_width_ = 0;
+};
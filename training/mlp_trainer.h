@@ -0,0 +1,475 @@
+// training/mlp_trainer.h
+// Dependency-free trainer for ANNie's fully-connected/ReLU MLP.
+// - Trains directly on a Dataset (dataset_io.h) through row-index lists, so many runs can share
+//   one read-only copy of the data (sweeps, k-fold)
+// - Softmax + cross-entropy loss, Adam with tiny-dnn's defaults (b1=0.9, b2=0.999, eps=1e-8)
+// - Xavier-uniform weights / zero biases, weight layout W[c*out + o] (same as tiny-dnn)
+// - Optional data-parallel mini-batches, per-epoch metrics callback and early stopping
+// - Optional warm start (TrainOptions::optimizer): Adam moments carried over from a previous run (see finetune.h)
+// - Optional distillation targets (TrainOptions::soft_targets): the loss mixes the labels with a
+//   teacher's temperature-softened outputs (see distill.h)
+// - to_engine() hands the result to MlpEngine for batched evaluation
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "dataset_io.h"
+#include "mlp_engine.h"
+
+static const size_t NUM_CLASSES = 4;
+
+struct MlpConfig {
+    std::vector<size_t> hidden = {64, 32, 16};
+    float lr = 1e-3f;
+    size_t batch = 32;
+    int epochs = 300;
+    uint32_t seed = 1234;
+
+    std::vector<size_t> dims() const {
+        std::vector<size_t> d = {NUM_FEATURES};
+        d.insert(d.end(), hidden.begin(), hidden.end());
+        d.push_back(NUM_CLASSES);
+        return d;
+    }
+    std::string topology() const {
+        std::string s = std::to_string(NUM_FEATURES);
+        for (size_t h : hidden) s += "-" + std::to_string(h);
+        return s + "-" + std::to_string(NUM_CLASSES);
+    }
+};
+
+// Parameters (or gradients / optimizer moments) of every layer
+struct MlpParams {
+    std::vector<size_t> dims;         // dims[0] = inputs ... dims.back() = outputs
+    std::vector<std::vector<float>> W; // W[l][c*out + o]
+    std::vector<std::vector<float>> b;
+
+    size_t layers() const { return W.size(); }
+
+    void resize_like(const MlpParams &o) {
+        dims = o.dims;
+        W.resize(o.W.size());
+        b.resize(o.b.size());
+        for (size_t l = 0; l < W.size(); ++l) {
+            W[l].assign(o.W[l].size(), 0.0f);
+            b[l].assign(o.b[l].size(), 0.0f);
+        }
+    }
+    void zero() {
+        for (auto &w : W) std::fill(w.begin(), w.end(), 0.0f);
+        for (auto &v : b) std::fill(v.begin(), v.end(), 0.0f);
+    }
+    size_t count() const {
+        size_t n = 0;
+        for (size_t l = 0; l < W.size(); ++l) n += W[l].size() + b[l].size();
+        return n;
+    }
+};
+
+static inline MlpParams init_mlp(const std::vector<size_t> &dims, uint32_t seed) {
+    MlpParams p;
+    p.dims = dims;
+    std::mt19937 rng(seed);
+    for (size_t l = 0; l + 1 < dims.size(); ++l) {
+        const size_t in = dims[l], out = dims[l + 1];
+        const float r = std::sqrt(6.0f / float(in + out));
+        std::uniform_real_distribution<float> dist(-r, r);
+        p.W.emplace_back(in * out);
+        for (auto &w : p.W.back()) w = dist(rng);
+        p.b.emplace_back(out, 0.0f);
+    }
+    return p;
+}
+
+static inline MlpEngine to_engine(const MlpParams &p) {
+    MlpEngine eng;
+    for (size_t l = 0; l < p.layers(); ++l)
+        eng.add_layer(p.dims[l], p.dims[l + 1], p.W[l].data(), p.b[l].data(), l + 1 < p.layers());
+    return eng;
+}
+
+struct AdamState {
+    float alpha = 1e-3f, b1 = 0.9f, b2 = 0.999f, eps = 1e-8f;
+    float b1_t = 1.0f, b2_t = 1.0f; // b1^t, b2^t
+    MlpParams m, v;
+
+    void init(const MlpParams &p, float lr) {
+        alpha = lr;
+        b1_t = b2_t = 1.0f;
+        m.resize_like(p);
+        v.resize_like(p);
+    }
+
+    void step(MlpParams &p, const MlpParams &g) {
+        b1_t *= b1;
+        b2_t *= b2;
+        auto update = [&](std::vector<float> &w, const std::vector<float> &dw, std::vector<float> &mt, std::vector<float> &vt) {
+            for (size_t i = 0; i < w.size(); ++i) {
+                mt[i] = b1 * mt[i] + (1.0f - b1) * dw[i];
+                vt[i] = b2 * vt[i] + (1.0f - b2) * dw[i] * dw[i];
+                w[i] -= alpha * (mt[i] / (1.0f - b1_t)) / std::sqrt(vt[i] / (1.0f - b2_t) + eps);
+            }
+        };
+        for (size_t l = 0; l < p.layers(); ++l) {
+            update(p.W[l], g.W[l], m.W[l], v.W[l]);
+            update(p.b[l], g.b[l], m.b[l], v.b[l]);
+        }
+    }
+};
+
+// Per-thread forward/backward scratch
+struct MlpWorkspace {
+    std::vector<std::vector<float>> act;   // act[0] = input, act[l+1] = output of layer l
+    std::vector<std::vector<float>> delta; // dL/d(pre-activation) per layer
+
+    void init(const std::vector<size_t> &dims) {
+        act.resize(dims.size());
+        delta.resize(dims.size());
+        for (size_t i = 0; i < dims.size(); ++i) {
+            act[i].assign(dims[i], 0.0f);
+            delta[i].assign(dims[i], 0.0f);
+        }
+    }
+};
+
+// Accumulate gradients of one sample into g; returns its loss.
+// With soft (teacher probabilities at temperature T) the loss is
+//   (1 - alpha) * CE(label) + alpha * T^2 * KL(soft || softmax(z / T))
+// whose gradient w.r.t. the logits is (1 - alpha) * (p - onehot) + alpha * T * (p_T - soft).
+static inline float backprop_sample(const MlpParams &p, const Dataset &ds, size_t row, MlpWorkspace &ws, MlpParams &g, bool &correct,
+                                    const float *soft = nullptr, float alpha = 0.0f, float T = 1.0f) {
+    const size_t L = p.layers();
+    for (size_t j = 0; j < NUM_FEATURES; ++j) ws.act[0][j] = ds.at(row, j);
+
+    // Forward
+    for (size_t l = 0; l < L; ++l) {
+        const size_t in = p.dims[l], out = p.dims[l + 1];
+        const float *W = p.W[l].data();
+        const float *x = ws.act[l].data();
+        float *y = ws.act[l + 1].data();
+        for (size_t o = 0; o < out; ++o) y[o] = 0.0f;
+        for (size_t c = 0; c < in; ++c) {
+            const float xc = x[c];
+            const float *w = W + c * out;
+            for (size_t o = 0; o < out; ++o) y[o] += w[o] * xc;
+        }
+        for (size_t o = 0; o < out; ++o) {
+            y[o] += p.b[l][o];
+            if (l + 1 < L && y[o] < 0.0f) y[o] = 0.0f;
+        }
+    }
+
+    // Softmax cross-entropy
+    const std::vector<float> &z = ws.act[L];
+    const size_t K = z.size();
+    const size_t label = static_cast<size_t>(ds.y[row]);
+    float zmax = z[0];
+    size_t best = 0;
+    for (size_t k = 1; k < K; ++k) if (z[k] > zmax) { zmax = z[k]; best = k; }
+    correct = (best == label);
+    float sum = 0.0f;
+    for (size_t k = 0; k < K; ++k) sum += std::exp(z[k] - zmax);
+    for (size_t k = 0; k < K; ++k) ws.delta[L][k] = std::exp(z[k] - zmax) / sum - (k == label ? 1.0f : 0.0f);
+    float loss = -(z[label] - zmax - std::log(sum));
+    if (soft) {
+        float sumT = 0.0f;
+        for (size_t k = 0; k < K; ++k) sumT += std::exp((z[k] - zmax) / T);
+        float kl = 0.0f;
+        for (size_t k = 0; k < K; ++k) {
+            const float pT = std::exp((z[k] - zmax) / T) / sumT;
+            ws.delta[L][k] = (1.0f - alpha) * ws.delta[L][k] + alpha * T * (pT - soft[k]);
+            if (soft[k] > 0.0f) kl += soft[k] * (std::log(soft[k]) - std::log(std::max(pT, 1e-30f)));
+        }
+        loss = (1.0f - alpha) * loss + alpha * T * T * kl;
+    }
+
+    // Backward
+    for (size_t l = L; l-- > 0;) {
+        const size_t in = p.dims[l], out = p.dims[l + 1];
+        const float *W = p.W[l].data();
+        const float *x = ws.act[l].data();
+        const float *d = ws.delta[l + 1].data();
+        float *gW = g.W[l].data();
+        float *gb = g.b[l].data();
+        for (size_t o = 0; o < out; ++o) gb[o] += d[o];
+        for (size_t c = 0; c < in; ++c) {
+            const float xc = x[c];
+            float *gw = gW + c * out;
+            const float *w = W + c * out;
+            float back = 0.0f;
+            for (size_t o = 0; o < out; ++o) {
+                gw[o] += xc * d[o];
+                back += w[o] * d[o];
+            }
+            // ReLU derivative of the layer below (inputs have none)
+            if (l > 0) ws.delta[l][c] = (xc > 0.0f) ? back : 0.0f;
+        }
+    }
+    return loss;
+}
+
+struct EvalResult {
+    size_t n = 0, correct = 0;
+    size_t confusion[NUM_CLASSES][NUM_CLASSES] = {}; // [truth][pred]
+
+    double accuracy() const { return n ? double(correct) / double(n) : 0.0; }
+    double recall(size_t k) const {
+        size_t row = 0;
+        for (size_t j = 0; j < NUM_CLASSES; ++j) row += confusion[k][j];
+        return row ? double(confusion[k][k]) / double(row) : 0.0;
+    }
+    void merge(const EvalResult &o) {
+        n += o.n;
+        correct += o.correct;
+        for (size_t i = 0; i < NUM_CLASSES; ++i)
+            for (size_t j = 0; j < NUM_CLASSES; ++j) confusion[i][j] += o.confusion[i][j];
+    }
+};
+
+// Batched evaluation of rows through the SIMD engine
+static inline EvalResult evaluate(MlpEngine &eng, const Dataset &ds, const std::vector<size_t> &rows) {
+    EvalResult r;
+    const size_t chunk = 4096;
+    std::vector<float> X(chunk * NUM_FEATURES);
+    std::vector<int> pred(chunk);
+    for (size_t s = 0; s < rows.size(); s += chunk) {
+        const size_t m = std::min(chunk, rows.size() - s);
+        for (size_t k = 0; k < m; ++k)
+            for (size_t j = 0; j < NUM_FEATURES; ++j) X[k * NUM_FEATURES + j] = ds.at(rows[s + k], j);
+        eng.predict_batch(X.data(), m, pred.data());
+        for (size_t k = 0; k < m; ++k) {
+            const size_t truth = static_cast<size_t>(ds.y[rows[s + k]]);
+            r.confusion[truth][pred[k]]++;
+            if (size_t(pred[k]) == truth) ++r.correct;
+        }
+        r.n += m;
+    }
+    return r;
+}
+
+struct EpochStats {
+    int epoch;               // 1-based
+    double loss;             // mean training loss (cross-entropy, plus the distillation term when used)
+    double train_acc;        // accuracy on the training rows seen this epoch
+    double val_acc;          // -1 without a validation split
+    double seconds;
+    double samples_per_sec;
+};
+
+struct TrainOptions {
+    size_t threads = 1;                            // workers sharing each mini-batch
+    const std::vector<size_t> *val_rows = nullptr; // early stopping / per-epoch validation
+    int patience = 0;                              // stop after this many epochs without improvement (0 = off)
+    double min_delta = 1e-4;                       // improvement needed to reset patience
+    const float *soft_targets = nullptr;           // distillation: NUM_CLASSES teacher probabilities per dataset row
+    float soft_weight = 0.0f;                      // alpha: share of the loss taken by the soft targets
+    float temperature = 1.0f;                      // T the soft targets were computed at
+    AdamState *optimizer = nullptr;                // warm start: continue from these moments (re-initialized if the
+                                                   // dims differ); receives the state that goes with the returned p
+    std::function<void(const EpochStats &)> on_epoch;
+};
+
+struct TrainResult {
+    int epochs_run = 0;
+    int best_epoch = 0;
+    double best_val_acc = -1.0;
+    bool stopped_early = false;
+};
+
+// Reusable barrier for the data-parallel workers (C++17 has no std::barrier)
+class Barrier {
+public:
+    explicit Barrier(size_t n) : n_(n) {}
+    void wait() {
+        std::unique_lock<std::mutex> lk(mu_);
+        const size_t gen = gen_;
+        if (++count_ == n_) {
+            count_ = 0;
+            ++gen_;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lk, [&] { return gen != gen_; });
+        }
+    }
+    // A participant that will never arrive (a worker that failed to start)
+    void leave() {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (--n_ == count_ && count_ > 0) {
+            count_ = 0;
+            ++gen_;
+            cv_.notify_all();
+        }
+    }
+
+private:
+    std::mutex mu_;
+    std::condition_variable cv_;
+    size_t n_, count_ = 0, gen_ = 0;
+};
+
+// Mini-batch training of p on rows (shuffled every epoch).
+// With opts.threads > 1 each mini-batch is sharded across persistent workers, each with its own
+// gradient buffer; the shards are reduced and a single Adam step is applied.
+// With a validation split p ends at the best-validation epoch; with patience > 0 as well, training
+// stops once validation accuracy has not improved for that many epochs.
+static inline TrainResult train_mlp(MlpParams &p, const Dataset &ds, const std::vector<size_t> &rows, const MlpConfig &cfg,
+                                    const TrainOptions &opts = TrainOptions()) {
+    if (rows.empty()) throw std::runtime_error("train_mlp: no training rows");
+    const size_t T = std::max<size_t>(1, opts.threads);
+    AdamState local_opt;
+    AdamState &opt = opts.optimizer ? *opts.optimizer : local_opt;
+    if (opt.m.dims != p.dims) opt.init(p, cfg.lr);
+    else opt.alpha = cfg.lr;
+
+    std::vector<MlpParams> grads(T);
+    std::vector<MlpWorkspace> ws(T);
+    std::vector<double> loss_acc(T, 0.0);
+    std::vector<size_t> correct_acc(T, 0);
+    for (size_t t = 0; t < T; ++t) {
+        grads[t].resize_like(p);
+        ws[t].init(p.dims);
+    }
+
+    std::vector<size_t> order = rows;
+    std::mt19937 rng(cfg.seed);
+    const size_t batch = std::max<size_t>(1, cfg.batch);
+
+    // Shared state for the current mini-batch
+    size_t batch_begin = 0, batch_size = 0;
+    bool quit = false;
+    Barrier start(T), done(T);
+
+    auto run_shard = [&](size_t t) {
+        MlpParams &g = grads[t];
+        g.zero();
+        const size_t lo = batch_begin + batch_size * t / T, hi = batch_begin + batch_size * (t + 1) / T;
+        for (size_t k = lo; k < hi; ++k) {
+            bool ok;
+            const float *soft = opts.soft_targets ? opts.soft_targets + order[k] * NUM_CLASSES : nullptr;
+            loss_acc[t] += backprop_sample(p, ds, order[k], ws[t], g, ok, soft, opts.soft_weight, opts.temperature);
+            correct_acc[t] += ok;
+        }
+    };
+    // Stops and joins the workers on every exit path: an exception from on_epoch, evaluate or the
+    // optimizer must not destroy joinable threads
+    struct Workers {
+        std::vector<std::thread> threads;
+        Barrier &start, &done;
+        bool &quit;
+        size_t expected;
+        bool in_batch = false; // released by start, not yet through done
+        ~Workers() {
+            for (size_t k = threads.size(); k < expected; ++k) {
+                start.leave();
+                done.leave();
+            }
+            if (in_batch) done.wait();
+            quit = true;
+            if (!threads.empty()) start.wait();
+            for (auto &w : threads) w.join();
+        }
+    } workers{{}, start, done, quit, T - 1};
+    for (size_t t = 1; t < T; ++t) {
+        workers.threads.emplace_back([&, t] {
+            for (;;) {
+                start.wait();
+                if (quit) return;
+                run_shard(t);
+                done.wait();
+            }
+        });
+    }
+
+    TrainResult res;
+    MlpParams best = p;
+    AdamState best_opt;
+    int since_best = 0;
+    std::unique_ptr<MlpEngine> val_eng;
+
+    for (int e = 0; e < cfg.epochs; ++e) {
+        const auto t0 = std::chrono::steady_clock::now();
+        std::fill(loss_acc.begin(), loss_acc.end(), 0.0);
+        std::fill(correct_acc.begin(), correct_acc.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (size_t s = 0; s < order.size(); s += batch) {
+            batch_begin = s;
+            batch_size = std::min(batch, order.size() - s);
+            if (T > 1) {
+                start.wait();
+                workers.in_batch = true;
+            }
+            run_shard(0);
+            if (T > 1) {
+                done.wait();
+                workers.in_batch = false;
+            }
+
+            // Reduce shard gradients into grads[0], average over the batch
+            MlpParams &g = grads[0];
+            const float inv = 1.0f / float(batch_size);
+            for (size_t l = 0; l < g.layers(); ++l) {
+                for (size_t t = 1; t < T; ++t) {
+                    for (size_t i = 0; i < g.W[l].size(); ++i) g.W[l][i] += grads[t].W[l][i];
+                    for (size_t i = 0; i < g.b[l].size(); ++i) g.b[l][i] += grads[t].b[l][i];
+                }
+                for (auto &v : g.W[l]) v *= inv;
+                for (auto &v : g.b[l]) v *= inv;
+            }
+            opt.step(p, g);
+        }
+
+        EpochStats st;
+        st.epoch = e + 1;
+        st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        st.samples_per_sec = st.seconds > 0.0 ? double(order.size()) / st.seconds : 0.0;
+        double loss = 0.0;
+        size_t correct = 0;
+        for (size_t t = 0; t < T; ++t) {
+            loss += loss_acc[t];
+            correct += correct_acc[t];
+        }
+        st.loss = loss / double(order.size());
+        st.train_acc = double(correct) / double(order.size());
+        st.val_acc = -1.0;
+        res.epochs_run = e + 1;
+
+        if (opts.val_rows && !opts.val_rows->empty()) {
+            val_eng.reset(new MlpEngine(to_engine(p)));
+            st.val_acc = evaluate(*val_eng, ds, *opts.val_rows).accuracy();
+            if (st.val_acc > res.best_val_acc + opts.min_delta) {
+                res.best_val_acc = st.val_acc;
+                res.best_epoch = e + 1;
+                best = p;
+                if (opts.optimizer) best_opt = opt;
+                since_best = 0;
+            } else {
+                ++since_best;
+            }
+        }
+        if (opts.on_epoch) opts.on_epoch(st);
+        if (opts.patience > 0 && since_best >= opts.patience) {
+            res.stopped_early = true;
+            break;
+        }
+    }
+
+    if (res.best_epoch > 0) {
+        p = best;
+        if (opts.optimizer) opt = best_opt;
+    }
+    return res;
+}
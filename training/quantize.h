@@ -0,0 +1,244 @@
+// training/quantize.h
+// Post-training int8 quantization of an MlpEngine model for the Uno firmware.
+// - Per-layer symmetric weight scales (max|W| / 127)
+// - Per-layer activation scales calibrated on real samples (max activation / 127)
+// - Int32 biases, fixed-point requantization (mult, shift) chosen so acc*mult fits int32
+// - Inputs arrive as Q14 features (firmware/ann_features.h) and are requantized the same way, so the
+//   firmware's int8 path has no float at all
+// - Inference uses firmware/ann_q8.h directly, so host parity == on-device behaviour
+// - write_q8_header() emits models/arduino_weights_q8.h (PROGMEM tables + ann_q8_forward() / ann_q8_predict(),
+//   ANN_Q8_MODEL_HASH as in export_weights.h)
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mlp_engine.h"
+#include "export_weights.h"
+#include "../firmware/ann_features.h"
+#include "../firmware/ann_q8.h"
+
+struct QuantLayer {
+    size_t in, out;
+    bool relu;
+    std::vector<int8_t> W;  // row-major [out][in]
+    std::vector<int32_t> B;
+    float w_scale;
+    int32_t mult = 0;       // hidden layers only
+    uint8_t shift = 0;
+};
+
+struct QuantModel {
+    float in_scale;         // x_q = round(x / in_scale)
+    int32_t in_mult = 0;    // x_q = (x_q14 * in_mult + round) >> in_shift
+    uint8_t in_shift = 0;
+    std::vector<QuantLayer> layers;
+    std::vector<float> act_scale; // act_scale[l] = scale of layer l's input
+
+    size_t input_size() const { return layers.front().in; }
+    size_t output_size() const { return layers.back().out; }
+
+    size_t flash_bytes() const {
+        size_t n = 0;
+        for (const auto &L : layers) n += L.W.size() + 4 * L.B.size();
+        return n;
+    }
+    size_t max_width() const {
+        size_t w = input_size();
+        for (const auto &L : layers) w = std::max(w, L.out);
+        return w;
+    }
+
+    // Integer-only prediction through the shared firmware kernels, from the Q14 features the firmware
+    // computes (exact for integer-cm inputs). buf must hold 2*max_width() int8.
+    int predict(const float *x, std::vector<int8_t> &buf, std::vector<int32_t> &logits) const {
+        const size_t mw = max_width();
+        if (buf.size() < 2 * mw) buf.resize(2 * mw);
+        if (logits.size() < output_size()) logits.resize(output_size());
+        int8_t *a = buf.data(), *b = buf.data() + mw;
+        for (size_t c = 0; c < input_size(); ++c) {
+            const long q14 = std::lround(double(x[c]) * ANN_FEAT_Q14_ONE);
+            a[c] = ann_q8_quantize_q14(int16_t(std::clamp(q14, -32768L, 32767L)), in_mult, in_shift);
+        }
+        for (size_t l = 0; l + 1 < layers.size(); ++l) {
+            const QuantLayer &L = layers[l];
+            ann_q8_dense_relu(L.W.data(), L.B.data(), uint16_t(L.in), uint16_t(L.out), L.mult, L.shift, a, b);
+            std::swap(a, b);
+        }
+        const QuantLayer &O = layers.back();
+        ann_q8_dense_out(O.W.data(), O.B.data(), uint16_t(O.in), uint16_t(O.out), a, logits.data());
+        return ann_q8_argmax(logits.data(), uint8_t(O.out));
+    }
+};
+
+// Fixed-point (mult, shift) ~ ratio with the largest shift that keeps bound*mult + round inside int32;
+// mult == 0 if none does
+static inline void fixed_point_multiplier(double ratio, int64_t bound, int32_t &mult, uint8_t &shift) {
+    mult = 0;
+    shift = 0;
+    for (int s = 30; s >= 0; --s) {
+        const double m = std::round(ratio * double(int64_t(1) << s));
+        if (m < 1.0) break;
+        if (m * double(bound) + double(int64_t(1) << s) < 2147483647.0) {
+            mult = int32_t(m);
+            shift = uint8_t(s);
+            break;
+        }
+    }
+}
+
+// Float forward pass that records max activation after every layer (calibration only)
+static inline std::vector<float> calibrate_activation_max(const MlpEngine &eng, const float *X, size_t n, float &in_max) {
+    const auto &Ls = eng.layers();
+    std::vector<float> amax(Ls.size(), 0.0f);
+    std::vector<float> a, b;
+    in_max = 0.0f;
+    const size_t nin = eng.input_size();
+    for (size_t i = 0; i < n; ++i) {
+        a.assign(X + i * nin, X + (i + 1) * nin);
+        for (float v : a) in_max = std::max(in_max, std::fabs(v));
+        for (size_t l = 0; l < Ls.size(); ++l) {
+            const auto &L = Ls[l];
+            const float *W = eng.weights(l), *B = eng.bias(l);
+            b.assign(L.out, 0.0f);
+            for (size_t o = 0; o < L.out; ++o) {
+                float s = 0.0f;
+                for (size_t c = 0; c < L.in; ++c) s += W[c * L.out_pad + o] * a[c];
+                s += B[o];
+                if (L.relu) s = std::max(0.0f, s);
+                b[o] = s;
+                amax[l] = std::max(amax[l], std::fabs(s));
+            }
+            a.swap(b);
+        }
+    }
+    return amax;
+}
+
+// Quantize eng using up to max_calib rows of X (row-major, eng.input_size() floats each).
+// Every layer except the last must be followed by ReLU (ANNie's topology).
+static inline QuantModel quantize_model(const MlpEngine &eng, const float *X, size_t n, size_t max_calib = 20000) {
+    const auto &Ls = eng.layers();
+    for (size_t l = 0; l + 1 < Ls.size(); ++l)
+        if (!Ls[l].relu) throw std::runtime_error("quantize_model: hidden layer " + std::to_string(l) + " has no ReLU");
+    if (n == 0) throw std::runtime_error("quantize_model: empty calibration set");
+
+    // Spread calibration rows over the whole set
+    const size_t ncal = std::min(n, max_calib);
+    const size_t step = n / ncal;
+    std::vector<float> cal;
+    cal.reserve(ncal * eng.input_size());
+    for (size_t i = 0; i < ncal; ++i)
+        cal.insert(cal.end(), X + i * step * eng.input_size(), X + (i * step + 1) * eng.input_size());
+
+    float in_max = 0.0f;
+    std::vector<float> amax = calibrate_activation_max(eng, cal.data(), ncal, in_max);
+
+    QuantModel qm;
+    qm.in_scale = std::max(in_max, 1e-6f) / 127.0f;
+    qm.act_scale.push_back(qm.in_scale);
+    // Q14 -> input scale, for any int16 Q14 value
+    fixed_point_multiplier(1.0 / (double(qm.in_scale) * ANN_FEAT_Q14_ONE), 32768, qm.in_mult, qm.in_shift);
+    if (qm.in_mult == 0) throw std::runtime_error("quantize_model: cannot fit input requantization in int32");
+    for (size_t l = 0; l + 1 < Ls.size(); ++l) qm.act_scale.push_back(std::max(amax[l], 1e-6f) / 127.0f);
+
+    for (size_t l = 0; l < Ls.size(); ++l) {
+        const auto &L = Ls[l];
+        const float *W = eng.weights(l), *B = eng.bias(l);
+        QuantLayer q;
+        q.in = L.in;
+        q.out = L.out;
+        q.relu = L.relu;
+
+        float wmax = 0.0f;
+        for (size_t c = 0; c < L.in; ++c)
+            for (size_t o = 0; o < L.out; ++o) wmax = std::max(wmax, std::fabs(W[c * L.out_pad + o]));
+        q.w_scale = std::max(wmax, 1e-8f) / 127.0f;
+
+        const double acc_scale = double(qm.act_scale[l]) * q.w_scale;
+        q.W.resize(L.out * L.in);
+        q.B.resize(L.out);
+        int64_t acc_bound = 0; // largest |acc| any input can produce
+        for (size_t o = 0; o < L.out; ++o) {
+            int64_t row = 0;
+            for (size_t c = 0; c < L.in; ++c) {
+                long v = std::lround(W[c * L.out_pad + o] / q.w_scale);
+                q.W[o * L.in + c] = int8_t(std::clamp(v, -127L, 127L));
+                row += std::abs(int(q.W[o * L.in + c])) * 127;
+            }
+            q.B[o] = int32_t(std::llround(B[o] / acc_scale));
+            acc_bound = std::max<int64_t>(acc_bound, row + std::abs(int64_t(q.B[o])));
+        }
+
+        if (l + 1 < Ls.size()) {
+            fixed_point_multiplier(acc_scale / qm.act_scale[l + 1], acc_bound, q.mult, q.shift);
+            if (q.mult == 0) throw std::runtime_error("quantize_model: cannot fit requantization of layer " + std::to_string(l) + " in int32");
+        }
+        qm.layers.push_back(std::move(q));
+    }
+    return qm;
+}
+
+// Emit an Arduino header with PROGMEM tables and an integer-only ann_q8_forward() (raw logits) and ann_q8_predict()
+static inline void write_q8_header(const std::string &path, const QuantModel &qm) {
+    std::ostringstream out;
+
+    out << "// Auto-generated int8 weights header from train_ann.cpp (post-training quantization)\n";
+    out << "// Kernel: firmware/ann_q8.h. Flash bytes: " << qm.flash_bytes() << "\n";
+    out << "#ifndef ANN_WEIGHTS_Q8_H\n#define ANN_WEIGHTS_Q8_H\n\n";
+    out << "#include \"../firmware/ann_q8.h\"\n\n";
+    out << "#define ANN_Q8_MODEL 1\n";
+    out << "#define Q8_IN_DIM " << qm.input_size() << "\n";
+    out << "#define Q8_OUT_DIM " << qm.output_size() << "\n";
+    out << "#define Q8_MAX_WIDTH " << qm.max_width() << "\n";
+    out << std::setprecision(9);
+    out << "// Input: x_q = round(x_q14 * Q8_IN_MULT / 2^Q8_IN_SHIFT) (ann_q8_quantize_q14), i.e. x * " << (1.0f / qm.in_scale) << "\n";
+    out << "#define Q8_IN_MULT " << qm.in_mult << "L\n#define Q8_IN_SHIFT " << int(qm.in_shift) << "\n\n";
+
+    for (size_t l = 0; l < qm.layers.size(); ++l) {
+        const QuantLayer &L = qm.layers[l];
+        out << "// Layer " << l << ": " << L.in << " -> " << L.out << (L.relu ? " ReLU" : "")
+            << ", w_scale=" << L.w_scale << ", in_scale=" << qm.act_scale[l] << "\n";
+        out << "const int8_t Q8_W" << l << "[] ANN_PROGMEM = {";
+        for (size_t i = 0; i < L.W.size(); ++i) out << (i % L.in == 0 ? "\n  " : " ") << int(L.W[i]) << ",";
+        out << "\n};\n";
+        out << "const int32_t Q8_B" << l << "[] ANN_PROGMEM = {";
+        for (size_t i = 0; i < L.B.size(); ++i) out << (i % 8 == 0 ? "\n  " : " ") << L.B[i] << "L,";
+        out << "\n};\n";
+        if (l + 1 < qm.layers.size())
+            out << "#define Q8_M" << l << " " << L.mult << "L\n#define Q8_S" << l << " " << int(L.shift) << "\n";
+        out << "\n";
+    }
+
+    out << "// Integer-only forward pass; x holds Q8_IN_DIM quantized inputs, logits gets the raw output accumulators\n";
+    out << "static void ann_q8_forward(const int8_t *x, int32_t *logits) {\n";
+    out << "  int8_t a[Q8_MAX_WIDTH], b[Q8_MAX_WIDTH];\n";
+    const char *src = "x";
+    bool to_a = true;
+    for (size_t l = 0; l + 1 < qm.layers.size(); ++l) {
+        const QuantLayer &L = qm.layers[l];
+        const char *dst = to_a ? "a" : "b";
+        out << "  ann_q8_dense_relu(Q8_W" << l << ", Q8_B" << l << ", " << L.in << ", " << L.out
+            << ", Q8_M" << l << ", Q8_S" << l << ", " << src << ", " << dst << ");\n";
+        src = dst;
+        to_a = !to_a;
+    }
+    const size_t last = qm.layers.size() - 1;
+    out << "  ann_q8_dense_out(Q8_W" << last << ", Q8_B" << last << ", " << qm.layers[last].in << ", "
+        << qm.layers[last].out << ", " << src << ", logits);\n";
+    out << "}\n\n";
+    out << "static inline uint8_t ann_q8_predict(const int8_t *x) {\n";
+    out << "  int32_t logits[Q8_OUT_DIM];\n";
+    out << "  ann_q8_forward(x, logits);\n";
+    out << "  return ann_q8_argmax(logits, Q8_OUT_DIM);\n";
+    out << "}\n\n";
+    write_hashed_header(path, out.str(), "ANN_Q8_MODEL_HASH", "ANN_WEIGHTS_Q8_H");
+}
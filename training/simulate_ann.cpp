@@ -1,58 +1,174 @@
 // simulate_ann.cpp
-// Purpose: Load trained tiny-dnn model and simulate ANNie decisions on sample inputs
-// Build: cl /EHsc /std:c++17 training\simulate_ann.cpp /I vendor\tiny-dnn /Fe:training\simulate_ann.exe
+// Purpose: Load trained tiny-dnn model and simulate ANNie decisions
+// - default: classify a few hand-written sensor scenarios
+// - --world: closed-loop episodes in generated 2D worlds (world_sim.h) running robot_ann.ino's
+//   loop() against the model, to score a model before flashing it
+// Build: cl /EHsc /O2 /std:c++17 training\simulate_ann.cpp /I vendor\tiny-dnn /Fe:training\simulate_ann.exe
+//   (add /arch:AVX2 to enable the AVX2 inference kernel in mlp_engine.h)
 // run: training\simulate_ann.exe
+//      training\simulate_ann.exe --world [--episodes N] [--threads N] [--seed X] [--map room|corridor|clutter|mix|file.txt]
+//                                [--max-time S] [--policy model|rule] [--controller sweep|scan] [--out models/sim_episodes.csv]
 
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include "tiny_dnn/tiny_dnn.h"
+#include "mlp_engine.h"
+#include "world_sim.h"
 
 using namespace tiny_dnn;
 
-int main() {
-    // Load trained model
-    network<sequential> net;
-    try {
-        net.load("models/ann_model_tinydnn.bin");
-    } catch (const std::exception &e) {
-        std::cerr << "Failed to load model: " << e.what() << "\n";
-        return 1;
-    }
-    std::cout << "Loaded trained model from models/ann_model_tinydnn.bin\n";
-
-    // Define test scenarios
-    std::vector<vec_t> demo_inputs = {
-        {0.9f, 0.5f, 0.5f}, // clear forward
-        {0.1f, 0.8f, 0.2f}, // blocked front, open left
-        {0.2f, 0.2f, 0.9f}, // blocked front, open right
-        {0.1f, 0.1f, 0.1f}, // blocked all sides
-        {0.5f, 0.9f, 0.9f}, // mid forward, open sides
+static int run_demo(MlpEngine &engine) {
+    // Define test scenarios (front,left,right in cm as the sensors report them, 999 = no echo)
+    std::vector<std::array<unsigned int,3>> demo_inputs = {
+        {90, 50, 50},   // clear forward
+        {10, 80, 20},   // blocked front, open left
+        {20, 20, 90},   // blocked front, open right
+        {10, 10, 10},   // blocked all sides
+        {50, 90, 90},   // mid forward, open sides
+        {999, 30, 40},  // nothing ahead within range
     };
 
     std::vector<std::string> labels = {"FORWARD", "LEFT", "RIGHT", "STOP"};
 
+    // Expand to the model's 5 inputs through the shared contract (firmware/ann_features.h)
+    std::vector<float> X;
+    for (const auto &d : demo_inputs) {
+        float in[ANN_FEAT_COUNT];
+        ann_features(d[0], d[1], d[2], in);
+        X.insert(X.end(), in, in + ANN_FEAT_COUNT);
+    }
+
+    // One batched pass for all scenarios
+    std::vector<int> preds(demo_inputs.size());
+    engine.predict_batch(X.data(), demo_inputs.size(), preds.data());
+
     // Print predictions
     for (size_t i = 0; i < demo_inputs.size(); i++) {
-        auto res = net.predict(demo_inputs[i]);
-        int pred = std::distance(res.begin(), std::max_element(res.begin(), res.end()));
-        std::cout << "Case " << i 
-                  << " input(" << demo_inputs[i][0] << "," << demo_inputs[i][1] << "," << demo_inputs[i][2] 
-                  << ") -> " << labels[pred] << "\n";
+        std::cout << "Case " << i
+                  << " input(" << demo_inputs[i][0] << "," << demo_inputs[i][1] << "," << demo_inputs[i][2]
+                  << ") -> " << labels[preds[i]] << "\n";
     }
 
     // Export results to CSV
     std::ofstream fout("results.csv");
     fout << "front,left,right,predicted\n";
     for (size_t i = 0; i < demo_inputs.size(); i++) {
-        auto res = net.predict(demo_inputs[i]);
-        int pred = std::distance(res.begin(), std::max_element(res.begin(), res.end()));
-        fout << demo_inputs[i][0] << "," << demo_inputs[i][1] << "," << demo_inputs[i][2] << "," << labels[pred] << "\n";
+        fout << demo_inputs[i][0] << "," << demo_inputs[i][1] << "," << demo_inputs[i][2] << "," << labels[preds[i]] << "\n";
     }
     fout.close();
     std::cout << "Saved results to results.csv\n";
+    return 0;
+}
+
+// Labelling rule of generate_synthetic.cpp on normalized inputs (baseline policy)
+static int rule_policy(const float *in) {
+    if (in[0] > 0.7f) return 0;
+    if (in[3] > 0.05f) return 1;
+    if (in[3] < -0.05f) return 2;
+    return 3;
+}
 
+int main(int argc, char **argv) {
+    bool world = false, use_rule = false;
+    size_t episodes = 1000, threads = 0;
+    std::string outPath = "models/sim_episodes.csv";
+    SimParams sp;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+                return argv[++i];
+            };
+            if (a == "--world") world = true;
+            else if (a == "--episodes") episodes = std::stoul(next());
+            else if (a == "--threads") threads = std::stoul(next());
+            else if (a == "--seed") sp.seed = std::stoull(next());
+            else if (a == "--max-time") sp.max_time_s = std::stod(next());
+            else if (a == "--out") outPath = next();
+            else if (a == "--controller") {
+                const std::string c = next();
+                if (c != "sweep" && c != "scan") throw std::runtime_error("--controller must be sweep or scan");
+                sp.controller = (c == "scan") ? CTRL_SCAN : CTRL_SWEEP;
+            }
+            else if (a == "--policy") {
+                const std::string p = next();
+                if (p != "model" && p != "rule") throw std::runtime_error("--policy must be model or rule");
+                use_rule = (p == "rule");
+            } else if (a == "--map") {
+                const std::string m = next();
+                if (m == "room") sp.map = MAP_ROOM;
+                else if (m == "corridor") sp.map = MAP_CORRIDOR;
+                else if (m == "clutter") sp.map = MAP_CLUTTER;
+                else if (m == "mix") sp.map = MAP_MIX;
+                else { sp.map = MAP_FILE; sp.map_file = m; }
+            } else {
+                std::cerr << "Usage: simulate_ann [--world [--episodes N] [--threads N] [--seed X] [--map room|corridor|clutter|mix|file]"
+                             " [--max-time S] [--policy model|rule] [--controller sweep|scan] [--out path]]\n";
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Bad arguments: " << e.what() << "\n";
+        return 1;
+    }
+
+    MlpEngine engine;
+    if (!use_rule) {
+        // Load trained model
+        network<sequential> net;
+        try {
+            net.load("models/ann_model_tinydnn.bin");
+        } catch (const std::exception &e) {
+            std::cerr << "Failed to load model: " << e.what() << "\n";
+            return 1;
+        }
+        std::cout << "Loaded trained model from models/ann_model_tinydnn.bin\n";
+
+        try {
+            engine = MlpEngine::from_tiny_dnn(net);
+        } catch (const std::exception &e) {
+            std::cerr << "Unsupported model: " << e.what() << "\n";
+            return 1;
+        }
+        if (engine.input_size() != 5) {
+            std::cerr << "Model expects " << engine.input_size() << " inputs, simulator provides 5\n";
+            return 1;
+        }
+    }
+
+    if (!world) {
+        if (use_rule) {
+            std::cerr << "--policy rule needs --world\n";
+            return 1;
+        }
+        return run_demo(engine);
+    }
+
+    // Each episode gets its own engine copy (predict() uses per-engine scratch buffers)
+    auto make_policy = [&]() -> SimPolicy {
+        if (use_rule) return rule_policy;
+        auto eng = std::make_shared<MlpEngine>(engine);
+        return [eng](const float *in) { return eng->predict(in); };
+    };
+
+    try {
+        std::cout << "Simulating " << episodes << " episodes (" << (use_rule ? "rule" : "model") << " policy, "
+                  << (sp.controller == CTRL_SCAN ? "stop-and-scan" : "sweep") << " controller)...\n";
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<EpisodeResult> res = run_episodes(sp, make_policy, episodes, threads);
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        print_sim_summary(summarize(res), wall);
+        write_episodes_csv(outPath, res);
+        std::cout << "Saved per-episode results to " << outPath << "\n";
+    } catch (const std::exception &e) {
+        std::cerr << "Simulation failed: " << e.what() << "\n";
+        return 1;
+    }
     return 0;
 }
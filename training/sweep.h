@@ -0,0 +1,267 @@
+// training/sweep.h
+// Hyperparameter sweep + k-fold cross-validation for train_ann (--sweep spec.txt)
+// - Spec: one "key = values" per line, '#' comments
+//     mode    = grid | random     (random draws `samples` configs)
+//     hidden  = 64,32,16 | 32,16 | 16   (topologies separated by '|')
+//     lr      = 1e-3, 3e-3        (random mode also accepts a log-uniform range: 1e-4 .. 1e-2)
+//     batch   = 32, 64
+//     epochs  = 50, 100
+//     folds   = 5
+//     samples = 20
+//     seed    = 1234
+// - Every (config, fold) pair is one task on the work-stealing pool; all tasks read the same
+//   Dataset and fold permutation, nothing is copied per fold
+// - Leaderboard: mean CV accuracy, per-class recall (summed confusion), wall time, parameter count
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mlp_trainer.h"
+#include "thread_pool.h"
+
+struct SweepSpec {
+    bool random = false;
+    size_t samples = 20;
+    size_t folds = 5;
+    uint32_t seed = 1234;
+    std::vector<std::vector<size_t>> hidden = {{64, 32, 16}};
+    std::vector<float> lr = {1e-3f};
+    float lr_lo = 0.0f, lr_hi = 0.0f; // log-uniform range (random mode)
+    std::vector<size_t> batch = {32};
+    std::vector<int> epochs = {300};
+};
+
+static inline std::string spec_trim(const std::string &s) {
+    const size_t a = s.find_first_not_of(" \t\r");
+    if (a == std::string::npos) return "";
+    return s.substr(a, s.find_last_not_of(" \t\r") - a + 1);
+}
+
+static inline std::vector<std::string> spec_split(const std::string &s, char sep) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, sep)) {
+        tok = spec_trim(tok);
+        if (!tok.empty()) out.push_back(tok);
+    }
+    return out;
+}
+
+static inline SweepSpec load_sweep_spec(const std::string &path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Cannot open sweep spec: " + path);
+    SweepSpec spec;
+    std::string line;
+    size_t lineno = 0;
+    while (std::getline(in, line)) {
+        ++lineno;
+        line = spec_trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) throw std::runtime_error("sweep spec line " + std::to_string(lineno) + ": expected key = values");
+        const std::string key = spec_trim(line.substr(0, eq)), val = spec_trim(line.substr(eq + 1));
+        try {
+            if (key == "mode") {
+                if (val != "grid" && val != "random") throw std::runtime_error("mode must be grid or random");
+                spec.random = (val == "random");
+            } else if (key == "hidden") {
+                spec.hidden.clear();
+                for (const auto &topo : spec_split(val, '|')) {
+                    std::vector<size_t> h;
+                    for (const auto &w : spec_split(topo, ',')) h.push_back(std::stoul(w));
+                    spec.hidden.push_back(h);
+                }
+            } else if (key == "lr") {
+                spec.lr.clear();
+                const size_t dots = val.find("..");
+                if (dots != std::string::npos) {
+                    spec.lr_lo = std::stof(val.substr(0, dots));
+                    spec.lr_hi = std::stof(val.substr(dots + 2));
+                } else {
+                    for (const auto &v : spec_split(val, ',')) spec.lr.push_back(std::stof(v));
+                }
+            } else if (key == "batch") {
+                spec.batch.clear();
+                for (const auto &v : spec_split(val, ',')) spec.batch.push_back(std::stoul(v));
+            } else if (key == "epochs") {
+                spec.epochs.clear();
+                for (const auto &v : spec_split(val, ',')) spec.epochs.push_back(std::stoi(v));
+            } else if (key == "folds") {
+                spec.folds = std::stoul(val);
+            } else if (key == "samples") {
+                spec.samples = std::stoul(val);
+            } else if (key == "seed") {
+                spec.seed = static_cast<uint32_t>(std::stoul(val));
+            } else {
+                throw std::runtime_error("unknown key '" + key + "'");
+            }
+        } catch (const std::exception &ex) {
+            throw std::runtime_error("sweep spec line " + std::to_string(lineno) + ": " + ex.what());
+        }
+    }
+    if (spec.folds < 2) throw std::runtime_error("sweep spec: folds must be >= 2");
+    if (spec.hidden.empty() || spec.batch.empty() || spec.epochs.empty()) throw std::runtime_error("sweep spec: empty value list");
+    if (spec.lr.empty() && !(spec.random && spec.lr_lo > 0.0f && spec.lr_hi >= spec.lr_lo))
+        throw std::runtime_error("sweep spec: lr range needs mode = random and 0 < lo <= hi");
+    return spec;
+}
+
+static inline std::vector<MlpConfig> expand_sweep(const SweepSpec &spec) {
+    std::vector<MlpConfig> out;
+    if (!spec.random) {
+        for (const auto &h : spec.hidden)
+            for (float lr : spec.lr)
+                for (size_t b : spec.batch)
+                    for (int e : spec.epochs) {
+                        MlpConfig c;
+                        c.hidden = h;
+                        c.lr = lr;
+                        c.batch = b;
+                        c.epochs = e;
+                        c.seed = spec.seed;
+                        out.push_back(c);
+                    }
+        return out;
+    }
+    std::mt19937 rng(spec.seed);
+    auto pick = [&](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(rng); };
+    for (size_t i = 0; i < spec.samples; ++i) {
+        MlpConfig c;
+        c.hidden = spec.hidden[pick(spec.hidden.size())];
+        if (spec.lr.empty()) {
+            std::uniform_real_distribution<float> u(std::log(spec.lr_lo), std::log(spec.lr_hi));
+            c.lr = std::exp(u(rng));
+        } else {
+            c.lr = spec.lr[pick(spec.lr.size())];
+        }
+        c.batch = spec.batch[pick(spec.batch.size())];
+        c.epochs = spec.epochs[pick(spec.epochs.size())];
+        c.seed = spec.seed;
+        out.push_back(c);
+    }
+    return out;
+}
+
+struct SweepResult {
+    MlpConfig cfg;
+    EvalResult eval;            // summed over folds
+    double fold_acc_sum = 0.0, fold_acc_sq = 0.0;
+    size_t folds = 0;
+    double train_seconds = 0.0; // summed over folds
+    size_t params = 0;
+
+    double mean_acc() const { return folds ? fold_acc_sum / double(folds) : 0.0; }
+    double std_acc() const {
+        if (folds < 2) return 0.0;
+        const double m = mean_acc();
+        return std::sqrt(std::max(0.0, fold_acc_sq / double(folds) - m * m));
+    }
+};
+
+// Train every config of spec with k-fold CV on ds; returns results sorted best first
+static inline std::vector<SweepResult> run_sweep(const Dataset &ds, const SweepSpec &spec, size_t threads) {
+    const std::vector<MlpConfig> configs = expand_sweep(spec);
+    const size_t k = spec.folds;
+    if (ds.size() < k) throw std::runtime_error("sweep: fewer rows than folds");
+
+    // One shared permutation; fold f validates on perm[f*n/k, (f+1)*n/k)
+    std::vector<size_t> perm(ds.size());
+    for (size_t i = 0; i < perm.size(); ++i) perm[i] = i;
+    std::mt19937 rng(spec.seed);
+    std::shuffle(perm.begin(), perm.end(), rng);
+
+    std::vector<SweepResult> results(configs.size());
+    std::vector<std::mutex> locks(configs.size());
+    for (size_t c = 0; c < configs.size(); ++c) {
+        results[c].cfg = configs[c];
+        results[c].params = init_mlp(configs[c].dims(), 0).count();
+    }
+
+    ThreadPool pool(threads);
+    std::cout << "Sweep: " << configs.size() << " configs x " << k << " folds on " << pool.size() << " threads\n";
+    std::mutex print_mu;
+    size_t done = 0;
+    const auto t_start = std::chrono::steady_clock::now();
+
+    std::vector<std::future<void>> folds;
+    folds.reserve(configs.size() * k);
+    for (size_t c = 0; c < configs.size(); ++c) {
+        for (size_t f = 0; f < k; ++f) {
+            folds.push_back(pool.submit([&, c, f] {
+                const size_t lo = perm.size() * f / k, hi = perm.size() * (f + 1) / k;
+                std::vector<size_t> train_rows, val_rows(perm.begin() + lo, perm.begin() + hi);
+                train_rows.reserve(perm.size() - (hi - lo));
+                train_rows.insert(train_rows.end(), perm.begin(), perm.begin() + lo);
+                train_rows.insert(train_rows.end(), perm.begin() + hi, perm.end());
+
+                const MlpConfig &cfg = configs[c];
+                auto t0 = std::chrono::steady_clock::now();
+                MlpParams p = init_mlp(cfg.dims(), cfg.seed + uint32_t(f));
+                train_mlp(p, ds, train_rows, cfg);
+                const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                MlpEngine eng = to_engine(p);
+                EvalResult ev = evaluate(eng, ds, val_rows);
+
+                {
+                    std::lock_guard<std::mutex> lk(locks[c]);
+                    SweepResult &r = results[c];
+                    r.eval.merge(ev);
+                    r.fold_acc_sum += ev.accuracy();
+                    r.fold_acc_sq += ev.accuracy() * ev.accuracy();
+                    r.train_seconds += secs;
+                    r.folds++;
+                }
+                std::lock_guard<std::mutex> lk(print_mu);
+                ++done;
+                std::cout << "  [" << done << "/" << configs.size() * k << "] " << cfg.topology() << " lr=" << cfg.lr
+                          << " batch=" << cfg.batch << " epochs=" << cfg.epochs << " fold " << f
+                          << " acc=" << std::fixed << std::setprecision(4) << ev.accuracy() << " (" << std::setprecision(1)
+                          << secs << " s)" << std::defaultfloat << std::setprecision(6) << std::endl;
+            }));
+        }
+    }
+    pool.wait_idle();
+    for (auto &f : folds) f.get(); // a failed fold fails the sweep instead of leaving a config with fewer folds
+    std::cout << "Sweep finished in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count() << " s\n";
+
+    std::stable_sort(results.begin(), results.end(),
+                     [](const SweepResult &a, const SweepResult &b) { return a.mean_acc() > b.mean_acc(); });
+    return results;
+}
+
+static inline void write_leaderboard(const std::string &path, const std::vector<SweepResult> &results) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+    out << "rank,topology,lr,batch,epochs,folds,cv_accuracy,cv_std,recall_fwd,recall_left,recall_right,recall_stop,train_seconds,params\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SweepResult &r = results[i];
+        out << i + 1 << "," << r.cfg.topology() << "," << r.cfg.lr << "," << r.cfg.batch << "," << r.cfg.epochs << ","
+            << r.folds << "," << r.mean_acc() << "," << r.std_acc();
+        for (size_t k = 0; k < NUM_CLASSES; ++k) out << "," << r.eval.recall(k);
+        out << "," << r.train_seconds << "," << r.params << "\n";
+    }
+}
+
+static inline void print_leaderboard(const std::vector<SweepResult> &results, size_t top = 10) {
+    std::cout << "\nRank  Topology          lr        batch  epochs  cv_acc   +-std   rFWD   rLEFT  rRIGHT rSTOP  train_s  params\n";
+    for (size_t i = 0; i < std::min(top, results.size()); ++i) {
+        const SweepResult &r = results[i];
+        std::cout << std::left << std::setw(6) << i + 1 << std::setw(18) << r.cfg.topology() << std::setw(10) << r.cfg.lr
+                  << std::setw(7) << r.cfg.batch << std::setw(8) << r.cfg.epochs << std::right << std::fixed
+                  << std::setprecision(4) << r.mean_acc() << "  " << r.std_acc();
+        for (size_t k = 0; k < NUM_CLASSES; ++k) std::cout << " " << std::setprecision(3) << r.eval.recall(k);
+        std::cout << "  " << std::setprecision(1) << std::setw(7) << r.train_seconds << "  " << r.params << std::defaultfloat << std::setprecision(6) << "\n";
+    }
+}
@@ -0,0 +1,378 @@
+// training/telemetry_decode.cpp
+// Host side of the firmware's binary telemetry (firmware/ann_telemetry.h):
+// - Reads frames from a serial device (the robot over USB), a pty stand-in, or a capture file
+//   (firmware_host --telemetry), resynchronizing on noise and counting bad frames and sequence gaps
+// - Writes one columnar table per record type under --out: decisions/, events/, echoes/, each a set of
+//   raw little-endian arrays (one file per column, e.g. decisions/wait_ms.u16) plus schema.txt
+//   listing "name type" and the row count (numpy.fromfile / pandas can load them directly)
+// - Replays every decision through the trained model: recomputes the inputs from the logged
+//   distances through the shared input contract (firmware/ann_features.h; the Q14 inputs must match
+//   exactly) and reports where the model and the robot disagree (action, inputs, logits)
+// - Prints per-phase latency profiles of the decision cycle (drive, wait for sides, inference,
+//   longest loop() pass)
+// - --echo-log writes the echo widths (ANN_TELEMETRY=2 builds) in the format firmware_host --echo-log replays
+//
+// Build: cl /EHsc /O2 /std:c++17 training\telemetry_decode.cpp /I vendor\tiny-dnn /Fe:training\telemetry_decode.exe
+//        g++ -O2 -std=c++17 training/telemetry_decode.cpp -I vendor/tiny-dnn -o training/telemetry_decode   (Linux)
+// Run:   training\telemetry_decode.exe --port COM3 [--baud 115200] [--duration S]
+//        training/telemetry_decode --port /dev/ttyUSB0 | /dev/pts/N
+//        training/telemetry_decode --in capture.bin
+//        common: [--out models/telemetry] [--model models/ann_model_tinydnn.bin | --no-replay] [--echo-log widths.txt]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <stdexcept>
+#include <filesystem>
+
+#ifdef _WIN32
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <termios.h>
+  #include <unistd.h>
+#endif
+
+#include "tiny_dnn/tiny_dnn.h"
+#include "mlp_engine.h"
+#include "../firmware/ann_telemetry.h"
+#include "../firmware/ann_features.h"
+
+using namespace tiny_dnn;
+namespace fs = std::filesystem;
+
+static volatile std::sig_atomic_t g_stop = 0;
+static void on_sigint(int) { g_stop = 1; }
+
+static const char *const ACTIONS[] = {"FORWARD", "LEFT", "RIGHT", "STOP"};
+
+// Serial device / pty (raw mode, 100 ms read timeout so Ctrl-C and --duration are noticed) or a plain file
+class ByteSource {
+public:
+    ByteSource(const std::string &path, bool is_port, long baud) {
+#ifdef _WIN32
+        const std::string dev = (is_port && path.rfind("\\\\.\\", 0) != 0) ? "\\\\.\\" + path : path;
+        h_ = CreateFileA(dev.c_str(), GENERIC_READ, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (h_ == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open " + path);
+        if (is_port) {
+            DCB dcb = {};
+            dcb.DCBlength = sizeof(dcb);
+            if (!GetCommState(h_, &dcb)) throw std::runtime_error("Not a serial port: " + path);
+            dcb.BaudRate = DWORD(baud); dcb.ByteSize = 8; dcb.Parity = NOPARITY; dcb.StopBits = ONESTOPBIT;
+            dcb.fBinary = TRUE; dcb.fOutxCtsFlow = FALSE; dcb.fDtrControl = DTR_CONTROL_ENABLE;
+            if (!SetCommState(h_, &dcb)) throw std::runtime_error("Cannot configure " + path);
+            COMMTIMEOUTS to = {};
+            to.ReadIntervalTimeout = MAXDWORD; to.ReadTotalTimeoutMultiplier = MAXDWORD; to.ReadTotalTimeoutConstant = 100;
+            SetCommTimeouts(h_, &to);
+        }
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY | O_NOCTTY);
+        if (fd_ < 0) throw std::runtime_error("Cannot open " + path);
+        if (is_port && isatty(fd_)) {
+            termios tio = {};
+            if (tcgetattr(fd_, &tio) != 0) throw std::runtime_error("Cannot configure " + path);
+            cfmakeraw(&tio);
+            tio.c_cflag |= CLOCAL | CREAD;
+            tio.c_cc[VMIN] = 0;
+            tio.c_cc[VTIME] = 1;
+            speed_t sp = B115200;
+            switch (baud) {
+                case 9600: sp = B9600; break;
+                case 19200: sp = B19200; break;
+                case 38400: sp = B38400; break;
+                case 57600: sp = B57600; break;
+                case 115200: sp = B115200; break;
+                case 230400: sp = B230400; break;
+                default: throw std::runtime_error("Unsupported baud rate " + std::to_string(baud));
+            }
+            cfsetispeed(&tio, sp);
+            cfsetospeed(&tio, sp);
+            if (tcsetattr(fd_, TCSANOW, &tio) != 0) throw std::runtime_error("Cannot configure " + path);
+        }
+#endif
+        stream_ = is_port;
+    }
+    ~ByteSource() {
+#ifdef _WIN32
+        if (h_ != INVALID_HANDLE_VALUE) CloseHandle(h_);
+#else
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    ByteSource(const ByteSource &) = delete;
+    ByteSource &operator=(const ByteSource &) = delete;
+
+    // Bytes read; 0 = timeout on a port, end of input on a file (-1 = error)
+    long read(uint8_t *buf, size_t n) {
+#ifdef _WIN32
+        DWORD got = 0;
+        if (!ReadFile(h_, buf, DWORD(n), &got, nullptr)) return -1;
+        return long(got);
+#else
+        const ssize_t got = ::read(fd_, buf, n);
+        return got < 0 ? -1 : long(got);
+#endif
+    }
+    bool stream() const { return stream_; }
+
+private:
+#ifdef _WIN32
+    HANDLE h_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+    bool stream_ = false;
+};
+
+// One table = one directory of raw column files + schema.txt
+class ColumnTable {
+public:
+    ColumnTable(const fs::path &dir, std::vector<std::pair<std::string, std::string>> cols) : dir_(dir) {
+        fs::create_directories(dir_);
+        for (auto &c : cols) {
+            Column col;
+            col.name = c.first;
+            col.type = c.second;
+            col.out.open(dir_ / (c.first + "." + c.second), std::ios::binary | std::ios::trunc);
+            if (!col.out.is_open()) throw std::runtime_error("Cannot write " + (dir_ / col.name).string());
+            cols_.push_back(std::move(col));
+        }
+    }
+    template <class T>
+    void put(size_t col, T v) { cols_[col].out.write(reinterpret_cast<const char *>(&v), sizeof(T)); }
+    void end_row() { ++rows_; }
+    uint64_t rows() const { return rows_; }
+    void finish() {
+        std::ofstream s(dir_ / "schema.txt");
+        s << "# little-endian raw arrays, one file per column (<name>.<type>)\nrows " << rows_ << "\n";
+        for (auto &c : cols_) { s << c.name << " " << c.type << "\n"; c.out.close(); }
+    }
+
+private:
+    struct Column { std::string name, type; std::ofstream out; };
+    fs::path dir_;
+    std::vector<Column> cols_;
+    uint64_t rows_ = 0;
+};
+
+
+struct SeqTracker {
+    bool first = true;
+    uint8_t expect = 0;
+    uint64_t lost = 0;
+    void see(uint8_t seq) {
+        if (!first) lost += uint8_t(seq - expect);
+        first = false;
+        expect = uint8_t(seq + 1);
+    }
+};
+
+static void print_profile(const char *name, const char *unit, std::vector<double> v) {
+    if (v.empty()) return;
+    std::sort(v.begin(), v.end());
+    auto pct = [&](double p) { return v[std::min(v.size() - 1, size_t(p * double(v.size() - 1) + 0.5))]; };
+    double sum = 0;
+    for (double x : v) sum += x;
+    std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+              << " mean " << std::setw(8) << sum / double(v.size()) << "  p50 " << std::setw(8) << pct(0.5)
+              << "  p95 " << std::setw(8) << pct(0.95) << "  max " << std::setw(8) << v.back() << " " << unit << "\n";
+}
+
+int main(int argc, char **argv) {
+    std::string port, inPath, outDir = "models/telemetry", modelPath = "models/ann_model_tinydnn.bin", echoLogPath;
+    long baud = 115200;
+    double duration_s = 0;
+    bool replay = true;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+                return argv[++i];
+            };
+            if (a == "--port") port = next();
+            else if (a == "--in") inPath = next();
+            else if (a == "--baud") baud = std::stol(next());
+            else if (a == "--duration") duration_s = std::stod(next());
+            else if (a == "--out") outDir = next();
+            else if (a == "--model") modelPath = next();
+            else if (a == "--no-replay") replay = false;
+            else if (a == "--echo-log") echoLogPath = next();
+            else throw std::runtime_error("unknown option " + a);
+        }
+        if (port.empty() == inPath.empty()) throw std::runtime_error("need exactly one of --port or --in");
+    } catch (const std::exception &e) {
+        std::cerr << "Bad arguments: " << e.what() << "\n";
+        std::cerr << "Usage: telemetry_decode (--port DEV [--baud N] [--duration S] | --in capture.bin) [--out dir]"
+                     " [--model path | --no-replay] [--echo-log widths.txt]\n";
+        return 1;
+    }
+
+    std::unique_ptr<MlpEngine> engine;
+    if (replay) {
+        network<sequential> net;
+        try {
+            net.load(modelPath);
+            engine = std::make_unique<MlpEngine>(MlpEngine::from_tiny_dnn(net));
+        } catch (const std::exception &e) {
+            std::cerr << "Failed to load model " << modelPath << ": " << e.what() << " (use --no-replay to skip)\n";
+            return 1;
+        }
+        if (engine->input_size() != 5 || engine->output_size() != 4) {
+            std::cerr << "Model must be 5 -> 4, got " << engine->input_size() << " -> " << engine->output_size() << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        ByteSource src(port.empty() ? inPath : port, !port.empty(), baud);
+        ColumnTable decisions(fs::path(outDir) / "decisions", {
+            {"t_ms", "u32"}, {"seq", "u8"}, {"flags", "u8"}, {"action_raw", "u8"}, {"action", "u8"},
+            {"left_cm", "u16"}, {"right_cm", "u16"}, {"front_cm", "u16"},
+            {"in0", "f32"}, {"in1", "f32"}, {"in2", "f32"}, {"in3", "f32"}, {"in4", "f32"},
+            {"logit0", "f32"}, {"logit1", "f32"}, {"logit2", "f32"}, {"logit3", "f32"},
+            {"drive_ms", "u16"}, {"wait_ms", "u16"}, {"infer_us", "u16"}, {"pass_max_us", "u16"},
+            {"host_action", "u8"}});
+        ColumnTable events(fs::path(outDir) / "events", {{"t_ms", "u32"}, {"seq", "u8"}, {"kind", "u8"}, {"angle", "u8"}, {"cm", "u16"}});
+        ColumnTable echoes(fs::path(outDir) / "echoes", {{"t_ms", "u32"}, {"seq", "u8"}, {"angle", "u8"}, {"width_us", "u16"}});
+        std::ofstream echoLog;
+        if (!echoLogPath.empty()) {
+            echoLog.open(echoLogPath);
+            if (!echoLog.is_open()) throw std::runtime_error("Cannot write " + echoLogPath);
+            echoLog << "# echo widths in us (0 = no echo), from telemetry_decode\n";
+        }
+
+        std::signal(SIGINT, on_sigint);
+        const auto t_start = std::chrono::steady_clock::now();
+        AnnTlmParser parser;
+        ann_tlm_parser_init(parser);
+        SeqTracker seq;
+        uint64_t bytes = 0, boots = 0, criticals = 0, overrides = 0, vetoes = 0, q8_frames = 0, lattice_frames = 0;
+        uint64_t disagree = 0, input_mismatch = 0;
+        double max_logit_diff = 0;
+        std::vector<double> p_drive, p_wait, p_infer, p_pass;
+        std::vector<std::string> disagree_lines;
+        if (src.stream()) std::cout << "Reading " << port << " at " << baud << " baud (Ctrl-C to stop)...\n";
+
+        uint8_t buf[4096];
+        while (!g_stop) {
+            if (duration_s > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count() >= duration_s) break;
+            const long got = src.read(buf, sizeof(buf));
+            if (got < 0) throw std::runtime_error("read error");
+            if (got == 0) {
+                if (src.stream()) continue;
+                break;
+            }
+            bytes += uint64_t(got);
+            for (long k = 0; k < got; ++k) {
+                if (!ann_tlm_feed(parser, buf[k])) continue;
+                const uint8_t *pl = ann_tlm_payload(parser);
+                if (parser.type == ANN_TLM_EVENT) {
+                    AnnTlmEvent e;
+                    ann_tlm_decode(pl, e);
+                    if (e.kind == ANN_EV_BOOT) { seq.first = true; ++boots; }
+                    if (e.kind == ANN_EV_CRITICAL) ++criticals;
+                    seq.see(e.seq);
+                    events.put(0, e.t_ms); events.put(1, e.seq); events.put(2, e.kind); events.put(3, e.angle); events.put(4, e.cm);
+                    events.end_row();
+                } else if (parser.type == ANN_TLM_ECHO) {
+                    AnnTlmEcho e;
+                    ann_tlm_decode(pl, e);
+                    seq.see(e.seq);
+                    echoes.put(0, e.t_ms); echoes.put(1, e.seq); echoes.put(2, e.angle); echoes.put(3, e.width_us);
+                    echoes.end_row();
+                    if (echoLog.is_open()) echoLog << e.width_us << "\n";
+                } else if (parser.type == ANN_TLM_DECISION) {
+                    AnnTlmDecision d;
+                    ann_tlm_decode(pl, d);
+                    seq.see(d.seq);
+                    if (d.flags & ANN_TLM_F_FWD_OVERRIDE) ++overrides;
+                    if (d.flags & ANN_TLM_F_SIDE_VETO) ++vetoes;
+                    if (d.flags & ANN_TLM_F_Q8) ++q8_frames;
+                    if (d.flags & ANN_TLM_F_LATTICE) ++lattice_frames;
+                    p_drive.push_back(d.drive_ms);
+                    p_wait.push_back(d.wait_ms);
+                    p_infer.push_back(d.infer_us);
+                    p_pass.push_back(d.pass_max_us);
+
+                    uint8_t host_action = 255;
+                    if (engine) {
+                        // dist_cm is left, right, front; the model takes front, left, right, diff, minLR
+                        float in[ANN_FEAT_COUNT];
+                        int16_t in_q14[ANN_FEAT_COUNT];
+                        ann_features(d.dist_cm[2], d.dist_cm[0], d.dist_cm[1], in);
+                        ann_features_q14(d.dist_cm[2], d.dist_cm[0], d.dist_cm[1], in_q14);
+                        bool in_ok = true;
+                        for (int j = 0; j < 5; ++j) in_ok &= in_q14[j] == d.in_q14[j];
+                        if (!in_ok) ++input_mismatch;
+                        float logits[4];
+                        host_action = uint8_t(engine->predict(in, logits));
+                        if (!(d.flags & (ANN_TLM_F_Q8 | ANN_TLM_F_LATTICE)))
+                            for (int j = 0; j < 4; ++j) max_logit_diff = std::max(max_logit_diff, double(std::abs(logits[j] - d.logits[j])));
+                        if (host_action != d.action_raw || !in_ok) {
+                            ++disagree;
+                            if (disagree_lines.size() < 20) {
+                                std::ostringstream ss;
+                                ss << "  t=" << d.t_ms << " ms  L/R/F " << d.dist_cm[0] << "/" << d.dist_cm[1] << "/" << d.dist_cm[2]
+                                   << " cm  robot " << (d.action_raw < 4 ? ACTIONS[d.action_raw] : "?") << "  host " << ACTIONS[host_action]
+                                   << (in_ok ? "" : "  (inputs differ from the firmware's)");
+                                disagree_lines.push_back(ss.str());
+                            }
+                        }
+                    }
+
+                    decisions.put(0, d.t_ms); decisions.put(1, d.seq); decisions.put(2, d.flags);
+                    decisions.put(3, d.action_raw); decisions.put(4, d.action);
+                    for (int j = 0; j < 3; ++j) decisions.put(size_t(5 + j), d.dist_cm[j]);
+                    for (int j = 0; j < 5; ++j) decisions.put(size_t(8 + j), float(d.in_q14[j]) / 16384.0f);
+                    for (int j = 0; j < 4; ++j) decisions.put(size_t(13 + j), d.logits[j]);
+                    decisions.put(17, d.drive_ms); decisions.put(18, d.wait_ms);
+                    decisions.put(19, d.infer_us); decisions.put(20, d.pass_max_us);
+                    decisions.put(21, host_action);
+                    decisions.end_row();
+                }
+            }
+        }
+        decisions.finish();
+        events.finish();
+        echoes.finish();
+
+        std::cout << "Read " << bytes << " bytes: " << decisions.rows() << " decisions, " << events.rows() << " events ("
+                  << boots << " boots, " << criticals << " critical stops), " << echoes.rows() << " echoes\n";
+        std::cout << "Bad frames: " << parser.bad << ", frames lost (sequence gaps): " << seq.lost << "\n";
+        std::cout << "Overrides: " << overrides << " FORWARD refused, " << vetoes << " turns vetoed\n";
+        if (!p_drive.empty()) {
+            std::cout << "Decision cycle phases:\n";
+            print_profile("drive (until blocked)", "ms", p_drive);
+            print_profile("wait for sides", "ms", p_wait);
+            print_profile("inference", "us", p_infer);
+            print_profile("longest loop() pass", "us", p_pass);
+            std::cout << std::defaultfloat << std::setprecision(6);
+        }
+        if (engine) {
+            std::cout << "Replay through " << modelPath << ": " << disagree << " of " << decisions.rows()
+                      << " decisions disagree (" << input_mismatch << " with different inputs)";
+            if (q8_frames) std::cout << "; " << q8_frames << " came from the int8 model, so some disagreement is quantization";
+            if (lattice_frames) std::cout << "; " << lattice_frames << " came from the decision lattice (no logits)";
+            if (q8_frames + lattice_frames < decisions.rows()) std::cout << "; max |logit diff| (float frames) " << max_logit_diff;
+            std::cout << "\n";
+            for (const auto &l : disagree_lines) std::cout << l << "\n";
+            if (disagree > disagree_lines.size()) std::cout << "  ...\n";
+        }
+        std::cout << "Saved columnar log to " << outDir << " (decisions/, events/, echoes/)\n";
+        if (echoLog.is_open()) std::cout << "Saved echo widths to " << echoLogPath << "\n";
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+// training/thread_pool.h
+// Small work-stealing thread pool for the host tools.
+// - One deque per worker: the owner pops newest tasks from the back, idle workers steal the
+//   oldest from the front of other queues
+// - Tasks submitted from outside the pool are spread round-robin over the queues
+// - submit() returns a std::future; wait_idle() blocks until every queued task has finished
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i) queues_.emplace_back(new Queue);
+        for (size_t i = 0; i < threads; ++i) workers_.emplace_back([this, i] { run(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    template <class F>
+    auto submit(F f) -> std::future<decltype(f())> {
+        typedef decltype(f()) R;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+        std::future<R> fut = task->get_future();
+        const size_t q = (current_worker() >= 0 && owner() == this)
+                             ? size_t(current_worker())
+                             : next_queue_.fetch_add(1) % queues_.size();
+        {
+            // Counted before it can be popped (pending_ never underflows), generation bumped after it is visible
+            std::lock_guard<std::mutex> lk(mu_);
+            ++pending_;
+            {
+                std::lock_guard<std::mutex> qlk(queues_[q]->mu);
+                queues_[q]->tasks.emplace_back([task] { (*task)(); });
+            }
+            ++submitted_;
+        }
+        cv_.notify_one();
+        return fut;
+    }
+
+    void wait_idle() {
+        std::unique_lock<std::mutex> lk(mu_);
+        idle_cv_.wait(lk, [this] { return pending_ == 0; });
+    }
+
+private:
+    struct Queue {
+        std::mutex mu;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static int &current_worker() {
+        static thread_local int id = -1;
+        return id;
+    }
+    static ThreadPool *&owner() {
+        static thread_local ThreadPool *p = nullptr;
+        return p;
+    }
+
+    bool try_pop(size_t self, std::function<void()> &out) {
+        {
+            Queue &q = *queues_[self];
+            std::lock_guard<std::mutex> lk(q.mu);
+            if (!q.tasks.empty()) {
+                out = std::move(q.tasks.back());
+                q.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); ++k) {
+            Queue &q = *queues_[(self + k) % queues_.size()];
+            std::lock_guard<std::mutex> lk(q.mu);
+            if (!q.tasks.empty()) {
+                out = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        current_worker() = int(self);
+        owner() = this;
+        for (;;) {
+            // Generation taken before scanning: a task pushed after a failed scan has bumped it, so the wait
+            // below cannot miss its notify
+            size_t seen;
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                seen = submitted_;
+            }
+            std::function<void()> task;
+            if (try_pop(self, task)) {
+                task();
+                std::lock_guard<std::mutex> lk(mu_);
+                if (--pending_ == 0) {
+                    idle_cv_.notify_all();
+                    if (stop_) cv_.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lk(mu_);
+            // pending_ counts queued + running tasks: while stopping, wait for running ones (they may submit more)
+            cv_.wait(lk, [&] { return submitted_ != seen || (stop_ && pending_ == 0); });
+            if (stop_ && pending_ == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+    std::mutex mu_;
+    std::condition_variable cv_, idle_cv_;
+    size_t pending_ = 0;
+    size_t submitted_ = 0; // submission generation, guarded by mu_
+    bool stop_ = false;
+};
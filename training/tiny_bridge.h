@@ -0,0 +1,66 @@
+// training/tiny_bridge.h
+// Conversions between ANNie's own data/model structures and tiny-dnn
+// (shared by train_ann and the benchmarks)
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tiny_dnn/tiny_dnn.h"
+#include "dataset_io.h"
+#include "mlp_trainer.h"
+
+using namespace tiny_dnn;
+
+// Append fully_connected/relu layers for dims (inputs ... outputs); no ReLU after the last layer
+static inline void build_tiny_net(network<sequential> &net, const std::vector<size_t> &dims) {
+    for (size_t l = 0; l + 1 < dims.size(); ++l) {
+        net << fully_connected_layer(dims[l], dims[l + 1]);
+        if (l + 2 < dims.size()) net << relu();
+    }
+}
+
+// Convert selected rows to tiny-dnn tensors
+static inline void to_tiny(const Dataset &ds, const std::vector<size_t> &rows, std::vector<vec_t> &X, std::vector<label_t> &Y) {
+    X.assign(rows.size(), vec_t(NUM_FEATURES));
+    Y.resize(rows.size());
+    for (size_t j = 0; j < NUM_FEATURES; ++j) {
+        const float *col = ds.col(j);
+        for (size_t k = 0; k < rows.size(); ++k) X[k][j] = col[rows[k]];
+    }
+    for (size_t k = 0; k < rows.size(); ++k) Y[k] = static_cast<label_t>(ds.y[rows[k]]);
+}
+
+// Copy natively trained parameters into the tiny-dnn network (same W[c*out + o] layout)
+static inline void copy_to_tiny(network<sequential> &net, const MlpParams &p) {
+    net.init_weight();
+    size_t l = 0;
+    for (size_t i = 0; i < net.depth(); ++i) {
+        if (net[i]->layer_type() != "fully-connected") continue;
+        auto w = net[i]->weights();
+        w[0]->assign(p.W[l].begin(), p.W[l].end());
+        w[1]->assign(p.b[l].begin(), p.b[l].end());
+        ++l;
+    }
+}
+
+// Read a tiny-dnn fully_connected/relu network back into native parameters
+static inline MlpParams params_from_tiny(network<sequential> &net) {
+    MlpParams p;
+    for (size_t i = 0; i < net.depth(); ++i) {
+        if (net[i]->layer_type() != "fully-connected") continue;
+        auto w = net[i]->weights();
+        const size_t in = net[i]->in_data_size(), out = net[i]->out_data_size();
+        if (w.size() < 2 || w[0]->size() != in * out || w[1]->size() != out)
+            throw std::runtime_error("params_from_tiny: layer " + std::to_string(i) + " is not a biased fully-connected layer");
+        if (p.dims.empty()) p.dims.push_back(in);
+        else if (p.dims.back() != in) throw std::runtime_error("params_from_tiny: layer sizes do not chain");
+        p.dims.push_back(out);
+        p.W.emplace_back(w[0]->begin(), w[0]->end());
+        p.b.emplace_back(w[1]->begin(), w[1]->end());
+    }
+    if (p.W.empty()) throw std::runtime_error("params_from_tiny: network has no fully-connected layers");
+    return p;
+}
@@ -1,17 +1,35 @@
 // training/train_ann.cpp
 // Minimal, robust trainer for ANNie (5 inputs: front,left,right,diff,minLR)
 // - Expects CSV: data/dataset.csv with header: front,left,right,diff,minLR,action
-// - Trains a 5->32->16->4 MLP using tiny-dnn
+//   (memory-mapped; a binary cache data/dataset.csv.annb is written and reused while the CSV is unchanged)
+// - Trains a 5->64->32->16->4 MLP using tiny-dnn
 // - Saves: models/ann_model_tinydnn.bin, models/predictions.csv, models/confusion.csv
+// - Exports firmware weights: models/arduino_weights.h (PROGMEM, constexpr dims, input contract id)
+//   and data/normalize_params.json (the input contract of firmware/ann_features.h)
+// - Quantizes to int8: models/arduino_weights_q8.h, models/quant_parity.csv
+// - --compress: distills/prunes smaller students (distill.h), writes models/compression_report.csv and
+//   replaces the saved model, its checkpoint and both firmware headers with the smallest student within
+//   --max-drop of this model (the model itself is kept as models/ann_model_teacher.bin)
+// - Saves models/ann_optimizer.bin (Adam state + rows trained on) for --finetune: continues the saved
+//   model on the rows appended since (or --new file) mixed with a replay sample of old rows (finetune.h)
 //
 // Compile (Developer Command Prompt):
 // cl /EHsc /std:c++17 training\train_ann.cpp /I vendor\tiny-dnn /Fe:training\train_ann.exe
+//   (add /arch:AVX2 to enable the AVX2 inference kernel in mlp_engine.h; with g++ and -mfma / -march=native
+//   add -ffp-contract=off, --check-parity (engine vs tiny-dnn argmax on the test split) fails otherwise)
 // Run:
-// training\train_ann.exe
+// training\train_ann.exe [--data path] [--threads N] [--check-parity]
+// Native data-parallel trainer with per-epoch metrics and early stopping:
+// training\train_ann.exe --trainer native --threads 8 --patience 20
+// Hyperparameter sweep with k-fold CV (see sweep.h for the spec format):
+// training\train_ann.exe --sweep training\sweep_example.txt
+// Distill + prune for the MCU (students separated by '|', hidden sizes by ','):
+// training\train_ann.exe --compress --students "32,16|16|8" --max-drop 0.01
+// Incremental fine-tuning after appending logged rows to the dataset (or with --new logged.csv):
+// training\train_ann.exe --finetune --replay 20000 --patience 5
 
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
 #include <random>
@@ -19,6 +37,7 @@
 #include <iomanip>
 #include <array>
 #include <stdexcept>
+#include <chrono>
 
 #if __has_include(<filesystem>)
   #include <filesystem>
@@ -28,133 +47,43 @@
 #endif
 
 #include "tiny_dnn/tiny_dnn.h"
+#include "dataset_io.h"
+#include "mlp_engine.h"
+#include "quantize.h"
+#include "export_weights.h"
+#include "sweep.h"
+#include "tiny_bridge.h"
+#include "distill.h"
+#include "finetune.h"
 
 using namespace tiny_dnn;
 using namespace tiny_dnn::activation;
 using std::string;
 using std::vector;
 
-struct Sample {
-    std::array<float,5> x; // front,left,right,diff,minLR  (normalized)
-    int y;                 // 0..3
-};
-
-static const float INPUT_RANGE_CM = 100.0f;
-
-// Safe parse helpers
-static inline bool str_to_float(const string &s, float &out) {
-    try {
-        size_t idx = 0;
-        out = std::stof(s, &idx);
-        return idx == s.size();
-    } catch (...) { return false; }
-}
-static inline bool str_to_int(const string &s, int &out) {
-    try {
-        size_t idx = 0;
-        out = std::stoi(s, &idx);
-        return idx == s.size();
-    } catch (...) { return false; }
-}
-
-// Load CSV with robust diagnostics
-vector<Sample> load_dataset(const string &csv_path) {
-    std::ifstream in(csv_path);
-    if (!in.is_open()) {
-        std::cerr << "ERROR: Cannot open dataset file: " << csv_path << std::endl;
-        return {};
-    }
-    vector<Sample> out;
-    string line;
-    // Read header
-    if (!std::getline(in, line)) {
-        std::cerr << "ERROR: Dataset appears empty: " << csv_path << std::endl;
-        return {};
-    }
-    std::cout << "CSV header: " << line << std::endl;
-
-    size_t lineno = 1;
-    size_t skipped = 0;
-    while (std::getline(in, line)) {
-        ++lineno;
-        if (line.empty()) { ++skipped; continue; }
-        std::stringstream ss(line);
-        vector<string> cols;
-        string tok;
-        while (std::getline(ss, tok, ',')) cols.push_back(tok);
-
-        if (cols.size() < 6) {
-            std::cerr << "Skipping line " << lineno << " (expected 6 cols, got " << cols.size() << "): " << line << std::endl;
-            ++skipped;
-            continue;
-        }
-
-        float f,l,r,d,m;
-        int a;
-        bool ok = true;
-        ok &= str_to_float(cols[0], f);
-        ok &= str_to_float(cols[1], l);
-        ok &= str_to_float(cols[2], r);
-        ok &= str_to_float(cols[3], d);
-        ok &= str_to_float(cols[4], m);
-        ok &= str_to_int(cols[5], a);
-
-        if (!ok) {
-            std::cerr << "Skipping line " << lineno << " (parse error): " << line << std::endl;
-            ++skipped;
-            continue;
-        }
-
-        // Normalize / clamp
-        float nf = std::clamp(f, 0.0f, INPUT_RANGE_CM) / INPUT_RANGE_CM;          // 0..1
-        float nl = std::clamp(l, 0.0f, INPUT_RANGE_CM) / INPUT_RANGE_CM;          // 0..1
-        float nr = std::clamp(r, 0.0f, INPUT_RANGE_CM) / INPUT_RANGE_CM;          // 0..1
-        float nd = std::clamp(d, -INPUT_RANGE_CM, INPUT_RANGE_CM) / INPUT_RANGE_CM; // -1..1
-        float nm = std::clamp(m, 0.0f, INPUT_RANGE_CM) / INPUT_RANGE_CM;          // 0..1
-
-        Sample s;
-        s.x = { nf, nl, nr, nd, nm };
-        s.y = a;
-        out.push_back(s);
-    }
-
-    std::cout << "Loaded " << out.size() << " valid samples, skipped " << skipped << " malformed/empty lines.\n";
-    if (out.size() > 0) {
-        std::cout << "Sample (first 5):\n";
-        for (size_t i = 0; i < std::min<size_t>(5, out.size()); ++i) {
-            auto &ss = out[i];
-            std::cout << i << ": [";
-            for (size_t j = 0; j < ss.x.size(); ++j) {
-                std::cout << std::fixed << std::setprecision(3) << ss.x[j] << (j+1<ss.x.size()? ", ":"");
-            }
-            std::cout << "] -> " << ss.y << "\n";
+// Print the first rows of a loaded dataset for sanity checking
+void print_head(const Dataset &ds, size_t rows = 5) {
+    if (ds.empty()) return;
+    std::cout << "Sample (first " << std::min(rows, ds.size()) << "):\n";
+    for (size_t i = 0; i < std::min(rows, ds.size()); ++i) {
+        std::cout << i << ": [";
+        for (size_t j = 0; j < NUM_FEATURES; ++j) {
+            std::cout << std::fixed << std::setprecision(3) << ds.at(i, j) << (j + 1 < NUM_FEATURES ? ", " : "");
         }
+        std::cout << "] -> " << int(ds.y[i]) << "\n";
     }
-    return out;
 }
 
-// Shuffle & split
-void shuffle_split(const vector<Sample> &all, vector<Sample> &train, vector<Sample> &test, float test_ratio=0.2f, int seed=42) {
-    vector<Sample> copy = all;
+// Shuffle & split row indices (same permutation as shuffling the rows themselves)
+void shuffle_split(size_t n, vector<size_t> &train, vector<size_t> &test, float test_ratio=0.2f, int seed=42) {
+    vector<size_t> idx(n);
+    for (size_t i = 0; i < n; ++i) idx[i] = i;
     std::mt19937 rng(seed);
-    std::shuffle(copy.begin(), copy.end(), rng);
-    size_t ntest = static_cast<size_t>(copy.size() * test_ratio);
-    if (ntest > copy.size()) ntest = copy.size();
-    test.assign(copy.begin(), copy.begin() + ntest);
-    train.assign(copy.begin() + ntest, copy.end());
-}
-
-// Convert to tiny-dnn tensors
-void to_tiny(const vector<Sample> &data, std::vector<vec_t> &X, std::vector<label_t> &Y) {
-    X.clear(); Y.clear();
-    X.reserve(data.size()); Y.reserve(data.size());
-    for (const auto &s : data) {
-        vec_t v;
-        v.reserve(5);
-        for (float val : s.x) v.push_back(val);
-        X.push_back(v);
-        Y.push_back(static_cast<label_t>(s.y));
-    }
+    std::shuffle(idx.begin(), idx.end(), rng);
+    size_t ntest = static_cast<size_t>(idx.size() * test_ratio);
+    if (ntest > idx.size()) ntest = idx.size();
+    test.assign(idx.begin(), idx.begin() + ntest);
+    train.assign(idx.begin() + ntest, idx.end());
 }
 
 int main(int argc, char** argv) {
@@ -165,8 +94,81 @@ int main(int argc, char** argv) {
         fs::path modelsDir = repoRoot / "models";
         fs::create_directories(modelsDir);
 
+        // Options
+        string sweepSpec;
+        size_t threads = 0; // 0 = all cores
+        bool nativeTrainer = false;
+        MlpConfig cfg;      // 5 -> 64 -> 32 -> 16 -> 4, lr 1e-3, batch 32, 300 epochs
+        int patience = 0;   // native trainer early stopping (0 = off)
+        bool epochsSet = false, patienceSet = false;
+        float valRatio = 0.1f;
+        bool compress = false;
+        bool checkParity = false;  // engine vs net.predict on every test row (slow: tiny-dnn per sample)
+        DistillConfig dcfg;
+        bool finetune = false;
+        string newDataPath;
+        FinetuneConfig fcfg;
+        for (int i = 1; i < argc; ++i) {
+            string a = argv[i];
+            bool has = i + 1 < argc;
+            if (a == "--sweep" && has) sweepSpec = argv[++i];
+            else if (a == "--threads" && has) threads = std::stoul(argv[++i]);
+            else if (a == "--data" && has) dataPath = argv[++i];
+            else if (a == "--trainer" && has) {
+                string t = argv[++i];
+                if (t != "native" && t != "tinydnn") { std::cerr << "--trainer must be native or tinydnn\n"; return 1; }
+                nativeTrainer = (t == "native");
+            }
+            else if (a == "--epochs" && has) { cfg.epochs = std::stoi(argv[++i]); epochsSet = true; }
+            else if (a == "--batch" && has) cfg.batch = std::stoul(argv[++i]);
+            else if (a == "--lr" && has) cfg.lr = std::stof(argv[++i]);
+            else if (a == "--patience" && has) { patience = std::stoi(argv[++i]); patienceSet = true; }
+            else if (a == "--val-ratio" && has) {
+                valRatio = std::stof(argv[++i]);
+                if (!(valRatio >= 0.0f && valRatio < 1.0f)) { std::cerr << "--val-ratio must be in [0, 1)\n"; return 1; }
+            }
+            else if (a == "--hidden" && has) {
+                cfg.hidden.clear();
+                for (const auto &h : spec_split(argv[++i], ',')) cfg.hidden.push_back(std::stoul(h));
+            }
+            else if (a == "--compress") compress = true;
+            else if (a == "--check-parity") checkParity = true;
+            else if (a == "--students" && has) {
+                dcfg.students.clear();
+                for (const auto &st : spec_split(argv[++i], '|')) {
+                    std::vector<size_t> hidden;
+                    for (const auto &h : spec_split(st, ',')) hidden.push_back(std::stoul(h));
+                    dcfg.students.push_back(hidden);
+                }
+            }
+            else if (a == "--max-drop" && has) dcfg.max_drop = std::stof(argv[++i]);
+            else if (a == "--distill-t" && has) dcfg.temperature = std::stof(argv[++i]);
+            else if (a == "--distill-alpha" && has) dcfg.alpha = std::stof(argv[++i]);
+            else if (a == "--finetune") finetune = true;
+            else if (a == "--new" && has) newDataPath = argv[++i];
+            else if (a == "--replay" && has) fcfg.replay = std::stoul(argv[++i]);
+            else {
+                std::cerr << "Usage: train_ann [--data dataset.csv|.annb] [--sweep spec.txt] [--threads N]\n"
+                             "                 [--trainer tinydnn|native] [--hidden 64,32,16] [--epochs N] [--batch N]\n"
+                             "                 [--lr X] [--patience N] [--val-ratio X] [--check-parity]\n"
+                             "                 [--compress [--students 32,16|16|8] [--max-drop X] [--distill-t T] [--distill-alpha A]]\n"
+                             "                 [--finetune [--new logged.csv] [--replay N]]   (--epochs/--patience default 50/5)\n";
+                return 1;
+            }
+        }
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        auto printEpoch = [&](const EpochStats &st) {
+            std::cout << "Epoch " << std::setw(4) << st.epoch << "/" << cfg.epochs << std::fixed
+                      << "  loss=" << std::setprecision(4) << st.loss
+                      << "  acc=" << st.train_acc
+                      << "  val_acc=" << st.val_acc
+                      << "  " << std::setprecision(2) << st.seconds << " s"
+                      << "  " << std::setprecision(0) << st.samples_per_sec << " samples/s"
+                      << std::defaultfloat << std::setprecision(6) << std::endl;
+        };
+
         std::cout << "Loading dataset from: " << dataPath.string() << std::endl;
-        auto all = load_dataset(dataPath.string());
+        Dataset all = load_dataset(dataPath.string());
         if (all.empty()) {
             std::cerr << "Dataset empty or not found. Make sure " << dataPath.string() << " exists and has header/front,left,right,diff,minLR,action\n";
             return 1;
@@ -174,39 +176,190 @@ int main(int argc, char** argv) {
 
         // Print class distribution
         std::array<int,4> counts = {0,0,0,0};
-        for (auto &s : all) if (s.y >=0 && s.y < 4) counts[s.y]++;
+        print_head(all);
+        for (int8_t y : all.y) if (y >= 0 && y < 4) counts[y]++;
         std::cout << "Class counts: 0(FWD)=" << counts[0] << " 1(LEFT)=" << counts[1] << " 2(RIGHT)=" << counts[2] << " 3(STOP)=" << counts[3] << "\n";
 
+        // Sweep mode: k-fold CV over a grid/random spec, then exit
+        if (!sweepSpec.empty()) {
+            SweepSpec spec = load_sweep_spec(sweepSpec);
+            auto results = run_sweep(all, spec, threads);
+            print_leaderboard(results);
+            std::string boardPath = (modelsDir / "sweep_leaderboard.csv").string();
+            write_leaderboard(boardPath, results);
+            std::cout << "Saved leaderboard to: " << boardPath << "\n";
+            return 0;
+        }
+
+        const std::string modelBinPath = (modelsDir / "ann_model_tinydnn.bin").string();
+        const std::string checkpointPath = (modelsDir / "ann_optimizer.bin").string();
+        const std::string headerPath = (modelsDir / "arduino_weights.h").string();
+        const std::string q8HeaderPath = (modelsDir / "arduino_weights_q8.h").string();
+        TrainCheckpoint checkpoint;
+
+        // Fine-tune mode: continue the saved model on the rows logged since it was trained, then exit
+        if (finetune) {
+            const auto t0 = std::chrono::steady_clock::now();
+            const bool haveCheckpoint = load_checkpoint(checkpointPath, checkpoint);
+            size_t oldRows = all.size();
+            if (newDataPath.empty()) {
+                if (!haveCheckpoint)
+                    throw std::runtime_error(checkpointPath + " not found: run a full training first, or pass --new");
+                if (checkpoint.rows_seen > all.size() || dataset_prefix_hash(all, checkpoint.rows_seen) != checkpoint.data_hash)
+                    throw std::runtime_error("the first " + std::to_string(checkpoint.rows_seen) +
+                                             " rows differ from the ones the model was trained on (dataset rewritten?); "
+                                             "run a full training, or pass the new rows with --new");
+                oldRows = checkpoint.rows_seen;
+            } else {
+                std::cout << "Loading new rows from: " << newDataPath << std::endl;
+                Dataset fresh = load_dataset(newDataPath);
+                if (fresh.empty()) throw std::runtime_error("no rows in " + newDataPath);
+                append_dataset(all, fresh);
+            }
+            if (oldRows == all.size()) {
+                std::cout << "No new rows since the saved model (" << oldRows << " rows); nothing to fine-tune\n";
+                return 0;
+            }
+
+            network<sequential> base;
+            base.load(modelBinPath);
+            MlpParams params = params_from_tiny(base);
+            if (params.dims.front() != NUM_FEATURES || params.dims.back() != NUM_CLASSES)
+                throw std::runtime_error(modelBinPath + " is not a " + std::to_string(NUM_FEATURES) + "-input, " +
+                                         std::to_string(NUM_CLASSES) + "-class model");
+            if (!haveCheckpoint || checkpoint.opt.m.dims != params.dims)
+                std::cout << "No optimizer state for " << dims_topology(params.dims) << "; Adam starts fresh\n";
+
+            if (!epochsSet) cfg.epochs = fcfg.epochs;
+            fcfg.patience = patienceSet ? patience : fcfg.patience;
+            FinetuneRows rows = finetune_split(oldRows, all.size(), fcfg);
+            std::cout << "Fine-tuning " << dims_topology(params.dims) << " on " << all.size() - oldRows << " new rows ("
+                      << rows.fit_new << " fit + " << rows.replay << " replayed old, val=" << rows.val.size()
+                      << ", new test=" << rows.new_test.size() << ", old eval=" << rows.old_eval.size()
+                      << "), epochs=" << cfg.epochs << ", patience=" << fcfg.patience << ", lr=" << cfg.lr << "\n";
+
+            MlpEngine before = to_engine(params);
+            const double valBefore = evaluate(before, all, rows.val).accuracy();
+            TrainOptions opts;
+            opts.threads = threads;
+            opts.val_rows = &rows.val;
+            opts.patience = fcfg.patience;
+            opts.on_epoch = printEpoch;
+            opts.optimizer = &checkpoint.opt;
+            MlpParams tuned = params;
+            TrainResult tr = train_mlp(tuned, all, rows.fit, cfg, opts);
+            MlpEngine after = to_engine(tuned);
+
+            std::vector<FinetuneDelta> deltas = {
+                {"new_test", evaluate(before, all, rows.new_test), evaluate(after, all, rows.new_test)},
+                {"old_eval", evaluate(before, all, rows.old_eval), evaluate(after, all, rows.old_eval)}};
+            std::cout << "Validation accuracy " << valBefore << " -> " << tr.best_val_acc << " (best epoch "
+                      << tr.best_epoch << " of " << tr.epochs_run << ")\n";
+            for (const auto &d : deltas) print_finetune_delta(d);
+            std::string reportPath = (modelsDir / "finetune_report.csv").string();
+            write_finetune_report(reportPath, deltas);
+            std::cout << "Saved fine-tune report to: " << reportPath << "\n";
+
+            if (tr.best_val_acc <= valBefore) {
+                std::cout << "No validation improvement; kept the saved model ("
+                          << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() << " s)\n";
+                return 0;
+            }
+            network<sequential> tunedNet;
+            build_tiny_net(tunedNet, tuned.dims);
+            copy_to_tiny(tunedNet, tuned);
+            tunedNet.save(modelBinPath);
+            write_arduino_header(headerPath, after);
+            std::vector<float> Xcal(rows.fit.size() * NUM_FEATURES);
+            for (size_t k = 0; k < rows.fit.size(); ++k)
+                for (size_t j = 0; j < NUM_FEATURES; ++j) Xcal[k * NUM_FEATURES + j] = all.at(rows.fit[k], j);
+            write_q8_header(q8HeaderPath, quantize_model(after, Xcal.data(), rows.fit.size()));
+            // Rows from --new are not in the dataset file, so its trained-on prefix stays where it was
+            if (newDataPath.empty()) {
+                checkpoint.rows_seen = all.size();
+                checkpoint.data_hash = dataset_prefix_hash(all, all.size());
+            }
+            if (!save_checkpoint(checkpointPath, checkpoint))
+                std::cerr << "WARNING: could not write " << checkpointPath << "\n";
+            std::cout << "Saved " << modelBinPath << ", " << headerPath << ", " << q8HeaderPath << " and " << checkpointPath
+                      << " in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() << " s\n";
+            return 0;
+        }
+
         // Split
-        vector<Sample> train_samples, test_samples;
-        shuffle_split(all, train_samples, test_samples, 0.2f, 1234);
-        std::cout << "Train: " << train_samples.size() << "  Test: " << test_samples.size() << std::endl;
+        vector<size_t> train_rows, test_rows;
+        shuffle_split(all.size(), train_rows, test_rows, 0.2f, 1234);
+        std::cout << "Train: " << train_rows.size() << "  Test: " << test_rows.size() << std::endl;
+
+        // Validation rows: the tail of the (shuffled) training rows, held out before either trainer runs.
+        // The native trainer stops early on them and --compress measures the teacher and the students on
+        // them, so they must not be rows the teacher was fitted on.
+        vector<size_t> fit_rows = train_rows, val_rows;
+        size_t nval = static_cast<size_t>(fit_rows.size() * valRatio);
+        if (compress) nval = std::max<size_t>(1, nval);
+        if (nativeTrainer || compress) {
+            if (nval >= fit_rows.size())
+                throw std::runtime_error("--val-ratio " + std::to_string(valRatio) + " leaves no rows to train on (" +
+                                         std::to_string(fit_rows.size()) + " training rows)");
+            val_rows.assign(fit_rows.end() - nval, fit_rows.end());
+            fit_rows.resize(fit_rows.size() - nval);
+        }
 
         // Convert to tiny-dnn
         std::vector<vec_t> X_train, X_test;
         std::vector<label_t> y_train, y_test;
-        to_tiny(train_samples, X_train, y_train);
-        to_tiny(test_samples, X_test, y_test);
+        to_tiny(all, train_rows, X_train, y_train);
+        to_tiny(all, test_rows, X_test, y_test);
 
-        // Build network: 5 -> 32 -> 16 -> 4
+        // Build network: 5 -> hidden... -> 4 (default 5 -> 64 -> 32 -> 16 -> 4)
+        const std::vector<size_t> dims = cfg.dims();
         network<sequential> net;
-        net << fully_connected_layer(5, 64) << relu()
-            << fully_connected_layer(64, 32) << relu()
-            << fully_connected_layer(32, 16) << relu()
-            << fully_connected_layer(16, 4);
-
-        // Optimizer
-        adam optimizer;
-        optimizer.alpha = float_t(1e-3);
-
-        const int epochs = 300;
-        const int batch_size = 32;
-
-        std::cout << "Starting training (epochs=" << epochs << ", batch=" << batch_size << ")...\n";
-        progress_display disp(static_cast<unsigned long>(X_train.size()));
-        timer t;
-        // tiny-dnn offers callbacks for progress_display; use simple train call
-        net.train<cross_entropy_multiclass>(optimizer, X_train, y_train, batch_size, epochs);
+        build_tiny_net(net, dims);
+
+        if (nativeTrainer) {
+            // Data-parallel native trainer, early stopping on val_rows
+            TrainOptions opts;
+            opts.threads = threads;
+            opts.val_rows = &val_rows;
+            opts.patience = patience;
+            opts.on_epoch = printEpoch;
+            opts.optimizer = &checkpoint.opt;
+
+            std::cout << "Starting native training (" << cfg.topology() << ", epochs=" << cfg.epochs << ", batch=" << cfg.batch
+                      << ", lr=" << cfg.lr << ", threads=" << threads << ", patience=" << patience
+                      << ", val=" << val_rows.size() << ")...\n";
+            MlpParams params = init_mlp(dims, cfg.seed);
+            TrainResult tr = train_mlp(params, all, fit_rows, cfg, opts);
+            if (tr.stopped_early)
+                std::cout << "Early stop after " << tr.epochs_run << " epochs (best val_acc=" << tr.best_val_acc
+                          << " at epoch " << tr.best_epoch << ")\n";
+            copy_to_tiny(net, params);
+        } else {
+            // Optimizer
+            adam optimizer;
+            optimizer.alpha = float_t(cfg.lr);
+
+            const int epochs = cfg.epochs;
+            const int batch_size = static_cast<int>(cfg.batch);
+
+            // Fitted on fit_rows only (val_rows are held out for --compress; all training rows otherwise)
+            std::vector<vec_t> X_fit;
+            std::vector<label_t> y_fit;
+            to_tiny(all, fit_rows, X_fit, y_fit);
+
+            std::cout << "Starting training (epochs=" << epochs << ", batch=" << batch_size << ", rows=" << X_fit.size() << ")...\n";
+            timer t;
+            int epoch = 0;
+            net.train<cross_entropy_multiclass>(optimizer, X_fit, y_fit, batch_size, epochs,
+                [&]() {},
+                [&]() {
+                    double secs = t.elapsed();
+                    std::cout << "Epoch " << std::setw(4) << ++epoch << "/" << epochs << std::fixed << std::setprecision(2)
+                              << "  " << secs << " s  " << std::setprecision(0) << (secs > 0 ? X_fit.size() / secs : 0.0)
+                              << " samples/s" << std::defaultfloat << std::setprecision(6) << std::endl;
+                    t.restart();
+                });
+        }
         std::cout << "Training complete.\n";
 
         // Evaluate
@@ -215,9 +368,31 @@ int main(int argc, char** argv) {
         std::vector<std::vector<int>> confusion(nClasses, std::vector<int>(nClasses,0));
         std::ofstream predout((modelsDir / "predictions.csv").string());
         predout << "f,l,r,diff,minLR,label,pred\n";
+        // Batched inference through the SIMD engine (argmax identical to net.predict, see --check-parity)
+        MlpEngine engine = MlpEngine::from_tiny_dnn(net);
+        std::vector<float> Xflat;
+        Xflat.reserve(X_test.size() * engine.input_size());
+        for (const auto &x : X_test) Xflat.insert(Xflat.end(), x.begin(), x.end());
+        std::vector<int> preds(X_test.size());
+        engine.predict_batch(Xflat.data(), X_test.size(), preds.data());
+        // Parity with tiny-dnn (opt-in, after a compiler or flag change): every tool below trusts the
+        // engine's predictions (and its export)
+        if (checkParity) {
+            size_t parityMismatch = 0;
+            for (size_t i = 0; i < X_test.size(); ++i) {
+                vec_t r = net.predict(X_test[i]);
+                if (int(std::max_element(r.begin(), r.end()) - r.begin()) != preds[i]) {
+                    if (parityMismatch < 5) std::cerr << "engine/tiny-dnn argmax mismatch on test row " << test_rows[i] << "\n";
+                    ++parityMismatch;
+                }
+            }
+            std::cout << "Engine/tiny-dnn argmax parity: " << X_test.size() - parityMismatch << "/" << X_test.size() << "\n";
+            if (parityMismatch)
+                throw std::runtime_error(std::to_string(parityMismatch) + " test rows predicted differently by MlpEngine and "
+                                         "tiny-dnn (FMA contraction or -ffast-math? see mlp_engine.h); nothing saved");
+        }
         for (size_t i = 0; i < X_test.size(); ++i) {
-            vec_t res = net.predict(X_test[i]);
-            int pred = static_cast<int>(std::distance(res.begin(), std::max_element(res.begin(), res.end())));
+            int pred = preds[i];
             int truth = static_cast<int>(y_test[i]);
             if (pred == truth) ++correct;
             if (truth >=0 && truth < nClasses) confusion[truth][pred]++;
@@ -242,10 +417,94 @@ int main(int argc, char** argv) {
         cfout.close();
         std::cout << "Saved predictions.csv and confusion.csv to " << modelsDir.string() << "\n";
 
-        // Save model binary
-        std::string modelBinPath = (modelsDir / "ann_model_tinydnn.bin").string();
+        // Save model binary, plus what --finetune needs to continue from it (no Adam moments after a tiny-dnn run)
         net.save(modelBinPath);
         std::cout << "Saved tiny-dnn model to: " << modelBinPath << "\n";
+        checkpoint.rows_seen = all.size();
+        checkpoint.data_hash = dataset_prefix_hash(all, all.size());
+        if (save_checkpoint(checkpointPath, checkpoint)) std::cout << "Saved optimizer checkpoint to: " << checkpointPath << "\n";
+        else std::cerr << "WARNING: could not write " << checkpointPath << "\n";
+
+        // Firmware header: constexpr dims + PROGMEM weights for firmware/ann_mlp.h
+        write_arduino_header(headerPath, engine);
+        std::cout << "Saved firmware weights header to: " << headerPath << "\n";
+        const std::string contractPath = (repoRoot / "data" / "normalize_params.json").string();
+        write_feature_contract(contractPath);
+        std::cout << "Saved input contract to: " << contractPath << "\n";
+
+        // Post-training int8 quantization for the firmware (calibrated on the training split)
+        std::vector<float> Xcal;
+        Xcal.reserve(X_train.size() * engine.input_size());
+        for (const auto &x : X_train) Xcal.insert(Xcal.end(), x.begin(), x.end());
+        QuantModel qmodel = quantize_model(engine, Xcal.data(), X_train.size());
+
+        // Parity: quantized vs float argmax over the test split
+        std::vector<int8_t> qbuf;
+        std::vector<int32_t> qlogits;
+        size_t agree = 0, qcorrect = 0;
+        for (size_t i = 0; i < X_test.size(); ++i) {
+            int qp = qmodel.predict(&Xflat[i * engine.input_size()], qbuf, qlogits);
+            if (qp == preds[i]) ++agree;
+            if (qp == static_cast<int>(y_test[i])) ++qcorrect;
+        }
+        const size_t float_bytes = engine.param_count() * sizeof(float);
+        float qacc = (X_test.empty() ? 0.0f : float(qcorrect) / float(X_test.size()));
+        float agreement = (X_test.empty() ? 0.0f : float(agree) / float(X_test.size()));
+        std::cout << "Quantized (int8) accuracy: " << qacc << "  float/int8 argmax agreement: " << agreement
+                  << " (" << agree << "/" << X_test.size() << ")\n";
+        std::cout << "Model bytes: float=" << float_bytes << " int8=" << qmodel.flash_bytes() << "\n";
+
+        std::ofstream qrep((modelsDir / "quant_parity.csv").string());
+        qrep << "metric,value\n";
+        qrep << "test_samples," << X_test.size() << "\n";
+        qrep << "float_accuracy," << acc << "\n";
+        qrep << "int8_accuracy," << qacc << "\n";
+        qrep << "argmax_agreement," << agreement << "\n";
+        qrep << "float_bytes," << float_bytes << "\n";
+        qrep << "int8_bytes," << qmodel.flash_bytes() << "\n";
+        qrep.close();
+
+        write_q8_header(q8HeaderPath, qmodel);
+        std::cout << "Saved quantized firmware header to: " << q8HeaderPath << "\n";
+
+        if (compress) {
+            // The fit/validation split the teacher was trained with; the test split only scores candidates
+            std::cout << "Compressing: " << dcfg.students.size() << " student(s), T=" << dcfg.temperature << ", alpha=" << dcfg.alpha
+                      << ", max drop=" << dcfg.max_drop << ", threads=" << threads << "...\n";
+            double teacher_val_acc = 0.0;
+            std::vector<CompressCandidate> cands =
+                run_compression(all, engine, fit_rows, val_rows, test_rows, dcfg, threads, teacher_val_acc);
+            const int picked = pick_smallest(cands);
+            print_compression_report(cands, acc, engine, picked);
+            std::string reportPath = (modelsDir / "compression_report.csv").string();
+            write_compression_report(reportPath, cands, acc, picked);
+            std::cout << "Saved compression report to: " << reportPath << "\n";
+
+            if (picked < 0) {
+                std::cout << "No student within " << dcfg.max_drop << " of the teacher (val_acc=" << teacher_val_acc
+                          << "); firmware headers keep the teacher\n";
+            } else {
+                const CompressCandidate &best = cands[size_t(picked)];
+                std::cout << "Exporting " << best.name << ": test_acc=" << best.test_acc << " (teacher " << acc << "), "
+                          << best.float_bytes << " float bytes, " << best.macs << " MACs\n";
+                MlpEngine student = to_engine(best.params);
+                write_arduino_header(headerPath, student);
+                write_q8_header(q8HeaderPath, quantize_model(student, Xcal.data(), X_train.size()));
+                // The student becomes the saved model, so --finetune and the telemetry replay run what the headers run;
+                // the teacher is kept next to it. Its Adam moments don't fit the student: the checkpoint keeps none.
+                const std::string teacherBinPath = (modelsDir / "ann_model_teacher.bin").string();
+                net.save(teacherBinPath);
+                network<sequential> snet;
+                build_tiny_net(snet, best.params.dims);
+                copy_to_tiny(snet, best.params);
+                snet.save(modelBinPath);
+                checkpoint.opt = AdamState();
+                if (!save_checkpoint(checkpointPath, checkpoint))
+                    std::cerr << "WARNING: could not write " << checkpointPath << "\n";
+                std::cout << "Overwrote " << headerPath << ", " << q8HeaderPath << ", " << modelBinPath << " and " << checkpointPath
+                          << " with the student; saved the teacher to " << teacherBinPath << "\n";
+            }
+        }
 
         std::cout << "Done.\n";
         return 0;
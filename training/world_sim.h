@@ -0,0 +1,670 @@
+// training/world_sim.h
+// Headless closed-loop simulator for the robot_ann.ino control loop.
+// - World: 2D occupancy grid (cm), generated rooms / corridors / clutter or an ASCII map file
+//   ('#' wall, 'S' start, 'G' goal, anything else free)
+// - Sensor: HC-SR04 on the pan servo; each ping casts a fan of rays over the beam width, adds
+//   Gaussian noise and random dropouts, and is turned into an echo time with the same 30 ms
+//   pulseIn timeout and integer conversion as readUltrasonicOnce (no echo -> 999)
+// - Robot: differential drive (L298N PWM -> wheel speed with deadband and first-order lag),
+//   disc footprint for collisions
+// - Controllers:
+//     CTRL_SWEEP: the current robot_ann.ino, run as 1 ms scheduler passes: its control state machine
+//       itself (firmware/ann_control.h: continuous servo sweep, ann_scanmap.h angle->distance map,
+//       decision through the inference task) and its echo capture (ann_echo.h, fed the edges the
+//       HC-SR04 would produce), in the sketch's task order
+//     CTRL_SCAN: the original blocking loop() (stop, back up, pan LEFT/RIGHT/CENTER, decide) line
+//       by line; delay() and pulseIn advance the physics, so every blocking wait costs simulated time
+// - Episodes are independent tasks on the work-stealing pool; episode i only depends on
+//   (seed, i), so results don't change with the thread count
+//
+// Usage:
+//   SimParams sp;
+//   std::vector<EpisodeResult> res = run_episodes(sp, make_policy, episodes, threads);
+//   SimSummary s = summarize(res);
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "thread_pool.h"
+#include "../firmware/ann_echo.h"
+#include "../firmware/ann_control.h"
+#include "../firmware/ann_features.h"
+
+static const double SIM_PI = 3.14159265358979323846;
+
+// Constants of the original blocking loop() (CTRL_SCAN); CTRL_SWEEP takes its own from ann_control.h
+struct FirmwareParams {
+    int safe_distance = ANN_SAFE_DISTANCE;         // cm
+    int critical_distance = ANN_CRITICAL_DISTANCE; // cm
+    int servo_center = ANN_SERVO_CENTER;
+    int servo_left = ANN_SERVO_LEFT;
+    int servo_right = ANN_SERVO_RIGHT;
+    int avg_samples = 3;        // readUltrasonicAvg() default
+    unsigned long pulse_timeout_us = ANN_ECHO_TIMEOUT_US;
+};
+
+enum Controller { CTRL_SWEEP = 0, CTRL_SCAN = 1 };
+
+struct SonarModel {
+    float max_range_cm = 400.0f;   // no echo beyond this (module times out)
+    float beam_half_deg = 15.0f;   // half-angle of the sensitive cone
+    int beam_rays = 7;             // rays cast across the cone, nearest hit wins
+    float noise_cm = 0.5f;         // Gaussian sigma = noise_cm + noise_frac * d
+    float noise_frac = 0.01f;
+    float dropout = 0.02f;         // probability a ping gets no echo
+    float mount_offset_cm = 6.0f;  // sensor ahead of the wheel axis
+};
+
+struct DriveModel {
+    float radius_cm = 9.0f;        // collision footprint
+    float wheel_base_cm = 13.0f;
+    float max_speed_cm_s = 60.0f;  // wheel speed at PWM 255
+    int pwm_deadband = 40;         // PWM below this doesn't move the wheel
+    float motor_tau_s = 0.06f;     // first-order wheel speed lag
+};
+
+enum MapKind { MAP_ROOM = 0, MAP_CORRIDOR = 1, MAP_CLUTTER = 2, MAP_MIX = 3, MAP_FILE = 4 };
+
+struct SimParams {
+    Controller controller = CTRL_SWEEP;
+    FirmwareParams fw;
+    SonarModel sonar;
+    DriveModel drive;
+    MapKind map = MAP_MIX;
+    std::string map_file;          // MAP_FILE
+    float cell_cm = 2.0f;
+    float goal_radius_cm = 20.0f;
+    double max_time_s = 120.0;     // episode time limit (simulated)
+    unsigned physics_step_ms = 5;
+    uint64_t seed = 7;
+};
+
+// --- occupancy grid ---
+
+struct OccupancyMap {
+    int w = 0, h = 0;
+    float cell = 2.0f; // cm per cell
+    std::vector<uint8_t> occ;
+    float start_x = 0, start_y = 0, goal_x = 0, goal_y = 0;
+    bool has_start = false, has_goal = false;
+
+    OccupancyMap() {}
+    OccupancyMap(float width_cm, float height_cm, float cell_cm)
+        : w(int(std::ceil(width_cm / cell_cm))), h(int(std::ceil(height_cm / cell_cm))), cell(cell_cm), occ(size_t(w) * h, 0) {}
+
+    float width_cm() const { return w * cell; }
+    float height_cm() const { return h * cell; }
+
+    // Outside the map counts as occupied
+    bool occupied_cell(int cx, int cy) const {
+        if (cx < 0 || cy < 0 || cx >= w || cy >= h) return true;
+        return occ[size_t(cy) * w + cx] != 0;
+    }
+    bool occupied(float x, float y) const {
+        return occupied_cell(int(std::floor(x / cell)), int(std::floor(y / cell)));
+    }
+
+    void fill_rect(float x0, float y0, float x1, float y1, uint8_t v = 1) {
+        const int cx0 = std::max(0, int(std::floor(std::min(x0, x1) / cell))), cx1 = std::min(w - 1, int(std::floor(std::max(x0, x1) / cell)));
+        const int cy0 = std::max(0, int(std::floor(std::min(y0, y1) / cell))), cy1 = std::min(h - 1, int(std::floor(std::max(y0, y1) / cell)));
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx) occ[size_t(cy) * w + cx] = v;
+    }
+    void fill_circle(float x, float y, float r, uint8_t v = 1) {
+        const int cx0 = std::max(0, int((x - r) / cell)), cx1 = std::min(w - 1, int((x + r) / cell));
+        const int cy0 = std::max(0, int((y - r) / cell)), cy1 = std::min(h - 1, int((y + r) / cell));
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const float dx = (cx + 0.5f) * cell - x, dy = (cy + 0.5f) * cell - y;
+                if (dx * dx + dy * dy <= r * r) occ[size_t(cy) * w + cx] = v;
+            }
+    }
+    void border(float thickness) {
+        fill_rect(0, 0, width_cm(), thickness);
+        fill_rect(0, height_cm() - thickness, width_cm(), height_cm());
+        fill_rect(0, 0, thickness, height_cm());
+        fill_rect(width_cm() - thickness, 0, width_cm(), height_cm());
+    }
+
+    // True if a disc of radius r at (x, y) touches no occupied cell
+    bool disc_free(float x, float y, float r) const {
+        const int cx0 = int(std::floor((x - r) / cell)), cx1 = int(std::floor((x + r) / cell));
+        const int cy0 = int(std::floor((y - r) / cell)), cy1 = int(std::floor((y + r) / cell));
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                if (!occupied_cell(cx, cy)) continue;
+                // closest point of the cell to the disc centre
+                const float px = std::clamp(x, cx * cell, (cx + 1) * cell), py = std::clamp(y, cy * cell, (cy + 1) * cell);
+                if ((px - x) * (px - x) + (py - y) * (py - y) < r * r) return false;
+            }
+        return true;
+    }
+
+    // Distance along a ray to the first occupied cell (grid DDA), capped at max_cm
+    float cast_ray(float x, float y, float ang, float max_cm) const {
+        const float dx = std::cos(ang), dy = std::sin(ang);
+        int cx = int(std::floor(x / cell)), cy = int(std::floor(y / cell));
+        if (occupied_cell(cx, cy)) return 0.0f;
+        const int sx = dx > 0 ? 1 : -1, sy = dy > 0 ? 1 : -1;
+        const float inf = 1e30f;
+        const float tdx = dx != 0 ? std::fabs(cell / dx) : inf, tdy = dy != 0 ? std::fabs(cell / dy) : inf;
+        float tx = dx != 0 ? ((dx > 0 ? (cx + 1) * cell - x : x - cx * cell) / std::fabs(dx)) : inf;
+        float ty = dy != 0 ? ((dy > 0 ? (cy + 1) * cell - y : y - cy * cell) / std::fabs(dy)) : inf;
+        for (;;) {
+            float t;
+            if (tx < ty) { t = tx; tx += tdx; cx += sx; }
+            else         { t = ty; ty += tdy; cy += sy; }
+            if (t >= max_cm) return max_cm;
+            if (occupied_cell(cx, cy)) return t;
+        }
+    }
+};
+
+// ASCII map: one character per cell
+static inline OccupancyMap load_ascii_map(const std::string &path, float cell_cm) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Cannot open map: " + path);
+    std::vector<std::string> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        rows.push_back(line);
+    }
+    size_t width = 0;
+    for (const auto &r : rows) width = std::max(width, r.size());
+    if (rows.empty() || width == 0) throw std::runtime_error("Empty map: " + path);
+    OccupancyMap m(width * cell_cm, rows.size() * cell_cm, cell_cm);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        const int cy = int(rows.size() - 1 - r); // first line is the top of the map
+        for (size_t c = 0; c < rows[r].size(); ++c) {
+            const char ch = rows[r][c];
+            const float x = (c + 0.5f) * cell_cm, y = (cy + 0.5f) * cell_cm;
+            if (ch == '#') m.occ[size_t(cy) * m.w + c] = 1;
+            else if (ch == 'S') { m.start_x = x; m.start_y = y; m.has_start = true; }
+            else if (ch == 'G') { m.goal_x = x; m.goal_y = y; m.has_goal = true; }
+        }
+    }
+    return m;
+}
+
+// --- map generators ---
+
+typedef std::mt19937_64 SimRng;
+
+static inline float sim_uniform(SimRng &rng, float lo, float hi) {
+    return std::uniform_real_distribution<float>(lo, hi)(rng);
+}
+
+// Random free point with the given clearance; false if none was found
+static inline bool sample_free(const OccupancyMap &m, SimRng &rng, float clearance, float &x, float &y) {
+    for (int tries = 0; tries < 2000; ++tries) {
+        x = sim_uniform(rng, 0.0f, m.width_cm());
+        y = sim_uniform(rng, 0.0f, m.height_cm());
+        if (m.disc_free(x, y, clearance)) return true;
+    }
+    return false;
+}
+
+static inline OccupancyMap make_room(SimRng &rng, float cell, int clutter) {
+    OccupancyMap m(sim_uniform(rng, 250.0f, 500.0f), sim_uniform(rng, 250.0f, 500.0f), cell);
+    m.border(4.0f);
+    const int boxes = clutter ? std::uniform_int_distribution<int>(2, 5)(rng) : std::uniform_int_distribution<int>(3, 8)(rng);
+    for (int i = 0; i < boxes; ++i) {
+        const float x = sim_uniform(rng, 0.0f, m.width_cm()), y = sim_uniform(rng, 0.0f, m.height_cm());
+        m.fill_rect(x, y, x + sim_uniform(rng, 15.0f, 60.0f), y + sim_uniform(rng, 15.0f, 60.0f));
+    }
+    const int posts = clutter ? std::uniform_int_distribution<int>(15, 30)(rng) : std::uniform_int_distribution<int>(0, 4)(rng);
+    for (int i = 0; i < posts; ++i)
+        m.fill_circle(sim_uniform(rng, 0.0f, m.width_cm()), sim_uniform(rng, 0.0f, m.height_cm()),
+                      clutter ? sim_uniform(rng, 2.0f, 8.0f) : sim_uniform(rng, 8.0f, 25.0f));
+    return m;
+}
+
+// Zig-zag corridor of straight segments; start at one end, goal at the other
+static inline OccupancyMap make_corridor(SimRng &rng, float cell) {
+    const float size = 600.0f, width = sim_uniform(rng, 55.0f, 100.0f);
+    OccupancyMap m(size, size, cell);
+    m.fill_rect(0, 0, size, size);
+    float x = 40.0f, y = 40.0f;
+    m.start_x = x; m.start_y = y; m.has_start = true;
+    const int segments = std::uniform_int_distribution<int>(3, 6)(rng);
+    for (int s = 0; s < segments; ++s) {
+        float nx = x, ny = y;
+        if (s % 2 == 0) nx = std::min(size - 40.0f, x + sim_uniform(rng, 100.0f, 250.0f));
+        else            ny = std::min(size - 40.0f, y + sim_uniform(rng, 100.0f, 250.0f));
+        m.fill_rect(std::min(x, nx) - width / 2, std::min(y, ny) - width / 2, std::max(x, nx) + width / 2, std::max(y, ny) + width / 2, 0);
+        x = nx; y = ny;
+    }
+    m.goal_x = x; m.goal_y = y; m.has_goal = true;
+    m.border(4.0f);
+    return m;
+}
+
+// World for episode `index`: generated maps cycle through the kinds in MAP_MIX
+static inline OccupancyMap make_world(const SimParams &sp, SimRng &rng, size_t index, const OccupancyMap *file_map) {
+    if (sp.map == MAP_FILE) return *file_map;
+    const MapKind kind = sp.map == MAP_MIX ? MapKind(index % 3) : sp.map;
+    if (kind == MAP_CORRIDOR) return make_corridor(rng, sp.cell_cm);
+    return make_room(rng, sp.cell_cm, kind == MAP_CLUTTER);
+}
+
+// --- episode ---
+
+enum SimPhase { PHASE_DRIVE = 0, PHASE_CRITICAL = 1, PHASE_SCAN = 2, PHASE_ACTION = 3, PHASE_COUNT = 4 };
+
+// 5 normalized inputs (front,left,right,diff,minLR) -> action 0..3
+typedef std::function<int(const float *in)> SimPolicy;
+
+struct EpisodeResult {
+    size_t index = 0;
+    int map_kind = 0;
+    bool collided = false, reached_goal = false;
+    double sim_time_s = 0.0, time_to_goal_s = 0.0;
+    double phase_s[PHASE_COUNT] = {0, 0, 0, 0};
+    size_t loops = 0, decisions = 0, overrides = 0, critical_stops = 0, pings = 0, timeouts = 0;
+    size_t actions[4] = {0, 0, 0, 0};
+    double distance_cm = 0.0;
+};
+
+// Virtual Arduino: the sketch's API on top of the world, every wait advances the physics
+class SimRobot {
+public:
+    SimRobot(const SimParams &sp, const OccupancyMap &map, SimRng &rng, SimPolicy policy, EpisodeResult &res)
+        : sp_(sp), map_(map), rng_(rng), policy_(std::move(policy)), res_(res) {
+        ann_ctl_init(ctl_, 0);  // setup(): servo centred, map empty
+        ann_echo_init(echo_);
+    }
+
+    void place(float x, float y, float heading, float gx, float gy) {
+        x_ = x; y_ = y; th_ = heading; gx_ = gx; gy_ = gy;
+    }
+    bool done() const { return done_; }
+
+    void step() {
+        if (sp_.controller == CTRL_SWEEP) loop_sweep();
+        else loop();
+    }
+
+    // Original blocking loop() of robot_ann.ino (stop, back up, pan the servo, decide)
+    void loop() {
+        const FirmwareParams &fw = sp_.fw;
+        res_.loops++;
+        phase_ = PHASE_DRIVE;
+        unsigned int front = readUltrasonicAvg();
+        if ((int)front <= fw.critical_distance) {
+            phase_ = PHASE_CRITICAL;
+            res_.critical_stops++;
+            motorsStop();
+            delay(200);
+            return;
+        }
+        if ((int)front > fw.safe_distance) {
+            motorsForward(200);
+            delay(80);
+            return;
+        }
+
+        // Decision cycle: backup, scan, run ANN
+        phase_ = PHASE_SCAN;
+        motorsStop(); delay(80);
+        motorsBackward(180); delay(320); motorsStop(); delay(120);
+
+        servo_ = fw.servo_left; delay(300);
+        unsigned int leftDist = readUltrasonicAvg();
+        delay(60);
+
+        servo_ = fw.servo_right; delay(300);
+        unsigned int rightDist = readUltrasonicAvg();
+        delay(60);
+
+        servo_ = fw.servo_center; delay(300);
+        unsigned int frontFresh = readUltrasonicAvg();
+
+        float in[ANN_FEAT_COUNT];
+        ann_features(frontFresh, leftDist, rightDist, in);
+        if (done_) return;
+        int action = policy_(in);
+        res_.decisions++;
+
+        // safety override
+        if (action == 0 && (int)frontFresh <= fw.safe_distance) {
+            res_.overrides++;
+            action = 3;
+        }
+        if (action >= 0 && action < 4) res_.actions[action]++;
+
+        phase_ = PHASE_ACTION;
+        switch (action) {
+            case 0: motorsForward(200); break;
+            case 1: motorsTurnLeft(200); break;
+            case 2: motorsTurnRight(200); break;
+            case 3: motorsStop(); break;
+        }
+        delay(450);
+        motorsStop();
+        delay(120);
+    }
+
+    // One scheduler pass (1 ms) of the current robot_ann.ino: its tasks in the sketch's order
+    void loop_sweep() {
+        res_.loops++;
+        const uint32_t now = uint32_t(clock_us_ / 1000);
+
+        // ECHO pin-change interrupts due since the last pass
+        if (echo_edges_ == 2 && clock_us_ >= echo_rise_us_) { ann_echo_edge(echo_, true, uint32_t(echo_rise_us_)); echo_edges_ = 1; }
+        if (echo_edges_ == 1 && clock_us_ >= echo_fall_us_) { ann_echo_edge(echo_, false, uint32_t(echo_fall_us_)); echo_edges_ = 0; }
+
+        // sweep task
+        ann_echo_poll(echo_, uint32_t(clock_us_));
+        AnnEchoSample e;
+        while (ann_echo_pop(echo_, e))
+            if (ann_ctl_echo(ctl_, e.angle, ann_echo_cm(e.width_us), now)) res_.critical_stops++;
+        if (ann_ctl_sweep(ctl_, now, ann_echo_busy(echo_))) fire_ping();
+
+        // control task
+        const uint8_t ev = ann_ctl_step(ctl_, now);
+        if (ev & ANN_CTL_EV_CRITICAL) res_.critical_stops++;
+        if (ev & ANN_CTL_EV_DECISION) {
+            res_.decisions++;
+            if (ctl_.flags & (ANN_TLM_F_FWD_OVERRIDE | ANN_TLM_F_SIDE_VETO)) res_.overrides++;
+            if (ctl_.last_action < 4) res_.actions[ctl_.last_action]++;
+        }
+
+        // inference task
+        unsigned int front, left, right;
+        if (ann_ctl_take_request(ctl_, front, left, right)) {
+            float in[ANN_FEAT_COUNT];
+            ann_features(front, left, right, in);
+            const int action = policy_(in);
+            ann_ctl_infer_done(ctl_, uint8_t(action >= 0 && action < 4 ? action : 3));
+        }
+
+        // servo task
+        if (ann_ctl_servo(ctl_, now)) servo_ = ctl_.servo_applied;
+
+        // motors task
+        switch (ctl_.motor) {
+            case ANN_M_STOP: motorsStop(); break;
+            case ANN_M_FORWARD: motorsForward(ctl_.pwm); break;
+            case ANN_M_BACKWARD: motorsBackward(ctl_.pwm); break;
+            case ANN_M_LEFT: motorsTurnLeft(ctl_.pwm); break;
+            case ANN_M_RIGHT: motorsTurnRight(ctl_.pwm); break;
+        }
+
+        phase_ = sweep_phase();
+        advance_us(1000);
+    }
+
+private:
+    // firePing(): trigger now, and the edges the module answers with (as the host HAL's sonar)
+    void fire_ping() {
+        const unsigned long w = echo_width_us();
+        ann_echo_trigger(echo_, uint32_t(clock_us_), uint8_t(ctl_.servo_applied));
+        echo_rise_us_ = clock_us_ + ANN_ECHO_RISE_US;
+        echo_fall_us_ = echo_rise_us_ + (w ? w : ANN_ECHO_NONE_US);
+        echo_edges_ = 2;
+    }
+
+    // Time attribution by control state; stopped and waiting for the map counts as scanning
+    SimPhase sweep_phase() const {
+        switch (ctl_.state) {
+            case ANN_ST_DRIVE: return ctl_.motor == ANN_M_FORWARD ? PHASE_DRIVE : PHASE_SCAN;
+            case ANN_ST_CRITICAL: return PHASE_CRITICAL;
+            case ANN_ST_ACTION:
+            case ANN_ST_ACTION_SETTLE: return PHASE_ACTION;
+            default: return PHASE_SCAN;
+        }
+    }
+
+    // --- motors (left wheel = IN1/IN2, right wheel = IN3/IN4) ---
+    void motorsStop() { cmd_l_ = cmd_r_ = 0; }
+    void motorsForward(int s) { cmd_l_ = s; cmd_r_ = s; }
+    void motorsBackward(int s) { cmd_l_ = -s; cmd_r_ = -s; }
+    void motorsTurnLeft(int s) { cmd_l_ = -s; cmd_r_ = s; }
+    void motorsTurnRight(int s) { cmd_l_ = s; cmd_r_ = -s; }
+
+    float wheel_target(int pwm) const {
+        const DriveModel &d = sp_.drive;
+        const int mag = std::abs(pwm);
+        if (mag <= d.pwm_deadband) return 0.0f;
+        const float v = d.max_speed_cm_s * float(mag - d.pwm_deadband) / float(255 - d.pwm_deadband);
+        return pwm < 0 ? -v : v;
+    }
+
+    // Advance the world by us microseconds
+    void advance_us(uint64_t us) {
+        if (done_) return;
+        res_.phase_s[phase_] += us * 1e-6;
+        clock_us_ += us;
+        pending_us_ += us;
+        const uint64_t step_us = uint64_t(sp_.physics_step_ms) * 1000;
+        while (!done_ && pending_us_ >= step_us) {
+            pending_us_ -= step_us;
+            physics(step_us * 1e-6f);
+        }
+    }
+    void delay(unsigned long ms) { advance_us(uint64_t(ms) * 1000); }
+
+    void physics(float dt) {
+        const DriveModel &d = sp_.drive;
+        const float k = std::min(1.0f, dt / d.motor_tau_s);
+        vl_ += (wheel_target(cmd_l_) - vl_) * k;
+        vr_ += (wheel_target(cmd_r_) - vr_) * k;
+        const float v = 0.5f * (vl_ + vr_), w = (vr_ - vl_) / d.wheel_base_cm;
+        const float nx = x_ + v * std::cos(th_) * dt, ny = y_ + v * std::sin(th_) * dt;
+        th_ += w * dt;
+        res_.distance_cm += std::fabs(v) * dt;
+        x_ = nx; y_ = ny;
+        now_us_ += uint64_t(dt * 1e6f + 0.5f);
+        res_.sim_time_s = now_us_ * 1e-6;
+        if (!map_.disc_free(x_, y_, d.radius_cm)) {
+            res_.collided = true;
+            done_ = true;
+            return;
+        }
+        if (!res_.reached_goal && (x_ - gx_) * (x_ - gx_) + (y_ - gy_) * (y_ - gy_) <= sp_.goal_radius_cm * sp_.goal_radius_cm) {
+            res_.reached_goal = true;
+            res_.time_to_goal_s = res_.sim_time_s;
+            done_ = true;
+            return;
+        }
+        if (res_.sim_time_s >= sp_.max_time_s) done_ = true;
+    }
+
+    // Echo pulse width for a ping fired now at the current servo angle (0 = no echo)
+    unsigned long echo_width_us() {
+        const SonarModel &s = sp_.sonar;
+        res_.pings++;
+        const float ang = th_ + float((servo_ - 90) * SIM_PI / 180.0);
+        const float ox = x_ + s.mount_offset_cm * std::cos(th_), oy = y_ + s.mount_offset_cm * std::sin(th_);
+        float d = s.max_range_cm;
+        for (int r = 0; r < s.beam_rays; ++r) {
+            const float off = s.beam_rays > 1 ? -s.beam_half_deg + 2.0f * s.beam_half_deg * r / (s.beam_rays - 1) : 0.0f;
+            d = std::min(d, map_.cast_ray(ox, oy, ang + float(off * SIM_PI / 180.0), s.max_range_cm));
+        }
+        bool echo = d < s.max_range_cm && std::uniform_real_distribution<float>(0.0f, 1.0f)(rng_) >= s.dropout;
+        unsigned long duration = 0;
+        if (echo) {
+            d += std::normal_distribution<float>(0.0f, s.noise_cm + s.noise_frac * d)(rng_);
+            d = std::max(d, 2.0f); // HC-SR04 blind zone
+            duration = (unsigned long)(d * 2.0f / 0.034f);
+            if (duration >= sp_.fw.pulse_timeout_us) duration = 0;
+        }
+        if (duration == 0) res_.timeouts++;
+        return duration;
+    }
+
+    // readUltrasonicOnce(): trigger, then pulseIn(ECHO, HIGH, 30000UL)
+    unsigned int readUltrasonicOnce() {
+        if (done_) return 999;
+        advance_us(12); // trigger pulse
+        const unsigned long duration = echo_width_us();
+        advance_us(duration ? duration : sp_.fw.pulse_timeout_us);
+        if (duration == 0) return 999;
+        return (unsigned int)((duration * 0.034) / 2.0 + 0.5);
+    }
+    unsigned int readUltrasonicAvg() {
+        long sum = 0; int valid = 0;
+        for (int i = 0; i < sp_.fw.avg_samples; i++) {
+            unsigned int d = readUltrasonicOnce();
+            if (d < 999) { sum += d; valid++; }
+            delay(10);
+        }
+        if (valid == 0) return 999;
+        return sum / valid;
+    }
+
+    const SimParams &sp_;
+    const OccupancyMap &map_;
+    SimRng &rng_;
+    SimPolicy policy_;
+    EpisodeResult &res_;
+
+    float x_ = 0, y_ = 0, th_ = 0, gx_ = 0, gy_ = 0;
+    float vl_ = 0, vr_ = 0;
+    int cmd_l_ = 0, cmd_r_ = 0;
+    int servo_ = 90;
+    SimPhase phase_ = PHASE_DRIVE;
+    uint64_t now_us_ = 0, pending_us_ = 0, clock_us_ = 0;
+    bool done_ = false;
+
+    // CTRL_SWEEP: the firmware's control state and echo capture, plus the ECHO edges still to come
+    AnnControl ctl_;
+    AnnEcho echo_;
+    uint64_t echo_rise_us_ = 0, echo_fall_us_ = 0;
+    int echo_edges_ = 0;
+};
+
+static inline EpisodeResult run_episode(const SimParams &sp, size_t index, const SimPolicy &policy, const OccupancyMap *file_map) {
+    std::seed_seq seq{uint32_t(sp.seed), uint32_t(sp.seed >> 32), uint32_t(index), uint32_t(uint64_t(index) >> 32)};
+    SimRng rng(seq);
+    EpisodeResult res;
+    res.index = index;
+    res.map_kind = sp.map == MAP_MIX ? int(index % 3) : int(sp.map);
+
+    const OccupancyMap map = make_world(sp, rng, index, file_map);
+    const float clearance = sp.drive.radius_cm + 15.0f;
+    float sx = map.start_x, sy = map.start_y, gx = map.goal_x, gy = map.goal_y;
+    if (!map.has_start && !sample_free(map, rng, clearance, sx, sy)) throw std::runtime_error("world_sim: no free start pose");
+    if (!map.has_goal) {
+        // farthest of a few free candidates, so small or cluttered rooms still get a goal
+        float best = -1.0f;
+        for (int tries = 0; tries < 16; ++tries) {
+            float x, y;
+            if (!sample_free(map, rng, clearance, x, y)) continue;
+            const float d = std::hypot(x - sx, y - sy);
+            if (d > best) { best = d; gx = x; gy = y; }
+        }
+        if (best < 0.0f) throw std::runtime_error("world_sim: no free goal position");
+    }
+    const float heading = sim_uniform(rng, float(-SIM_PI), float(SIM_PI));
+
+    SimRobot robot(sp, map, rng, policy, res);
+    robot.place(sx, sy, heading, gx, gy);
+    while (!robot.done()) robot.step();
+    return res;
+}
+
+// Run episodes [0, n) on the pool. make_policy() is called once per episode so each task owns
+// its policy state (e.g. a private MlpEngine copy with its own scratch buffers).
+static inline std::vector<EpisodeResult> run_episodes(const SimParams &sp, const std::function<SimPolicy()> &make_policy,
+                                                      size_t n, size_t threads) {
+    OccupancyMap file_map;
+    if (sp.map == MAP_FILE) file_map = load_ascii_map(sp.map_file, sp.cell_cm);
+
+    std::vector<EpisodeResult> results(n);
+    std::mutex mu;
+    std::string error;
+    ThreadPool pool(threads);
+    for (size_t i = 0; i < n; ++i) {
+        pool.submit([&, i] {
+            try {
+                results[i] = run_episode(sp, i, make_policy(), &file_map);
+            } catch (const std::exception &ex) {
+                std::lock_guard<std::mutex> lk(mu);
+                if (error.empty()) error = "episode " + std::to_string(i) + ": " + ex.what();
+            }
+        });
+    }
+    pool.wait_idle();
+    if (!error.empty()) throw std::runtime_error(error);
+    return results;
+}
+
+// --- reporting ---
+
+struct SimSummary {
+    size_t episodes = 0, collisions = 0, goals = 0, decisions = 0, overrides = 0, critical_stops = 0, timeouts = 0, pings = 0;
+    double sim_time_s = 0.0, goal_time_s = 0.0, distance_cm = 0.0;
+    double phase_s[PHASE_COUNT] = {0, 0, 0, 0};
+    size_t actions[4] = {0, 0, 0, 0};
+
+    double collision_rate() const { return episodes ? double(collisions) / double(episodes) : 0.0; }
+    double goal_rate() const { return episodes ? double(goals) / double(episodes) : 0.0; }
+    double mean_time_to_goal() const { return goals ? goal_time_s / double(goals) : 0.0; }
+    double scan_fraction() const { return sim_time_s > 0 ? phase_s[PHASE_SCAN] / sim_time_s : 0.0; }
+    double decisions_per_sim_s() const { return sim_time_s > 0 ? double(decisions) / sim_time_s : 0.0; }
+};
+
+static inline SimSummary summarize(const std::vector<EpisodeResult> &res) {
+    SimSummary s;
+    for (const auto &r : res) {
+        s.episodes++;
+        s.collisions += r.collided;
+        if (r.reached_goal) { s.goals++; s.goal_time_s += r.time_to_goal_s; }
+        s.decisions += r.decisions;
+        s.overrides += r.overrides;
+        s.critical_stops += r.critical_stops;
+        s.timeouts += r.timeouts;
+        s.pings += r.pings;
+        s.sim_time_s += r.sim_time_s;
+        s.distance_cm += r.distance_cm;
+        for (int p = 0; p < PHASE_COUNT; ++p) s.phase_s[p] += r.phase_s[p];
+        for (int a = 0; a < 4; ++a) s.actions[a] += r.actions[a];
+    }
+    return s;
+}
+
+static inline void print_sim_summary(const SimSummary &s, double wall_s) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "Episodes:              " << s.episodes << " (" << s.sim_time_s << " simulated s in " << wall_s << " s wall, "
+              << std::setprecision(0) << (wall_s > 0 ? s.sim_time_s / wall_s : 0.0) << "x real time)\n" << std::setprecision(3)
+              << "Collisions:            " << s.collisions << " (" << s.collision_rate() * 100.0 << " %)\n"
+              << "Reached goal:          " << s.goals << " (" << s.goal_rate() * 100.0 << " %), mean time to goal "
+              << s.mean_time_to_goal() << " s\n"
+              << "Stop-backup-scan time: " << s.phase_s[PHASE_SCAN] << " s (" << s.scan_fraction() * 100.0 << " % of simulated time)\n"
+              << "Action / drive / crit: " << s.phase_s[PHASE_ACTION] << " / " << s.phase_s[PHASE_DRIVE] << " / "
+              << s.phase_s[PHASE_CRITICAL] << " s\n"
+              << "Decisions:             " << s.decisions << " (" << s.decisions_per_sim_s() << " per simulated s), "
+              << s.overrides << " safety overrides, " << s.critical_stops << " critical stops\n"
+              << "Actions F/L/R/S:       " << s.actions[0] << " / " << s.actions[1] << " / " << s.actions[2] << " / " << s.actions[3] << "\n"
+              << "Sonar timeouts:        " << s.timeouts << " of " << s.pings << " pings\n"
+              << std::defaultfloat << std::setprecision(6);
+}
+
+static inline void write_episodes_csv(const std::string &path, const std::vector<EpisodeResult> &res) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("Cannot write " + path);
+    static const char *kinds[] = {"room", "corridor", "clutter", "mix", "file"};
+    out << "episode,map,collided,reached_goal,time_to_goal_s,sim_time_s,drive_s,critical_s,scan_s,action_s,"
+           "loops,decisions,overrides,critical_stops,forward,left,right,stop,distance_cm\n";
+    for (const auto &r : res) {
+        out << r.index << "," << kinds[r.map_kind] << "," << r.collided << "," << r.reached_goal << "," << r.time_to_goal_s << ","
+            << r.sim_time_s << "," << r.phase_s[PHASE_DRIVE] << "," << r.phase_s[PHASE_CRITICAL] << "," << r.phase_s[PHASE_SCAN] << ","
+            << r.phase_s[PHASE_ACTION] << "," << r.loops << "," << r.decisions << "," << r.overrides << "," << r.critical_stops << ","
+            << r.actions[0] << "," << r.actions[1] << "," << r.actions[2] << "," << r.actions[3] << "," << r.distance_cm << "\n";
+    }
+}